@@ -0,0 +1,170 @@
+#include <elf.h>
+#include <sys/wait.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <doptions/application.hpp>
+#include <doptions/mapped_file.hpp>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Generates programs with N options over M REGISTER_TYPE custom types,
+// compiles and links each of them, and reports compile time, object size and
+// the size of the .text sections in the object and in the linked binary, so
+// the cost of each Option<T> instantiation stays visible.
+//
+//   doptions_bloat_benchmark [--options 10,100,1000] [--types 0,10,100]
+//                            [--compiler c++] [--flags "-O2"]
+//                            [--work-dir dir]
+//
+// Option i uses custom type i when i < M and cycles over built-in types
+// otherwise. Grid points with M > N are skipped.
+
+#ifndef DOPTIONS_BLOAT_CXX
+#define DOPTIONS_BLOAT_CXX "c++"
+#endif
+
+#ifndef DOPTIONS_BLOAT_INCLUDE
+#define DOPTIONS_BLOAT_INCLUDE "include"
+#endif
+
+namespace {
+
+constexpr const char* builtinTypes[] = {"int32_t", "double", "std::string",
+                                        "bool", "uint16_t"};
+
+struct Sizes {
+  size_t file{0};
+  size_t text{0};
+};
+
+auto generate(const std::filesystem::path& path, size_t options, size_t types)
+    -> void {
+  std::ofstream out(path);
+  out << "#include <doptions/application.hpp>\n#include <string>\n\n";
+  for (size_t idx = 0; idx < types; ++idx) {
+    out << "struct Custom" << idx << " {\n  int value;\n};\n\n"
+        << "REGISTER_TYPE(Custom" << idx << ") {\n  return Custom" << idx
+        << "{std::stoi(str) + " << idx << "};\n}\n\n";
+  }
+  out << "int main(int argc, char** argv) {\n"
+      << "  auto app = doptions::Application::createApp();\n";
+  for (size_t idx = 0; idx < options; ++idx) {
+    const std::string type =
+        idx < types ? "Custom" + std::to_string(idx)
+                    : builtinTypes[idx % std::size(builtinTypes)];
+    out << "  static " << type << " value" << idx << "{};\n"
+        << "  app.addOption(\"--option-" << idx << "\", &value" << idx
+        << ");\n";
+  }
+  out << "  app.parse(argc, argv);\n  return 0;\n}\n";
+  if (!out) {
+    throw std::runtime_error("cannot write " + path.string());
+  }
+}
+
+auto run(const std::string& command) -> double {
+  const auto start = std::chrono::steady_clock::now();
+  const int status = std::system(command.c_str());  // NOLINT
+  const auto stop = std::chrono::steady_clock::now();
+  if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    throw std::runtime_error("command failed: " + command);
+  }
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+// Size of the file and of every .text and .text.* section in it.
+auto elfSizes(const std::filesystem::path& path) -> Sizes {
+  auto file = doptions::MappedFile::open(path.string());
+  const auto* data = file.data();
+  Elf64_Ehdr header{};
+  if (file.size() < sizeof(header)) {
+    throw std::runtime_error("not an ELF file: " + path.string());
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0 ||
+      header.e_ident[EI_CLASS] != ELFCLASS64) {
+    throw std::runtime_error("not a 64-bit ELF file: " + path.string());
+  }
+  auto section = [&](size_t idx) {
+    Elf64_Shdr shdr{};
+    std::memcpy(&shdr, data + header.e_shoff + idx * header.e_shentsize,
+                sizeof(shdr));
+    return shdr;
+  };
+  const auto names = section(header.e_shstrndx);
+  Sizes sizes{file.size(), 0};
+  for (size_t idx = 0; idx < header.e_shnum; ++idx) {
+    const auto shdr = section(idx);
+    const std::string_view name(data + names.sh_offset + shdr.sh_name);
+    if (name == ".text" || name.starts_with(".text.")) {
+      sizes.text += shdr.sh_size;
+    }
+  }
+  return sizes;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  std::vector<size_t> optionCounts{10, 100, 1000};
+  std::vector<size_t> typeCounts{0, 10, 100};
+  std::string cxx = DOPTIONS_BLOAT_CXX;
+  std::string includeDir = DOPTIONS_BLOAT_INCLUDE;
+  std::string flags = "-O2";
+  std::string workDir =
+      (std::filesystem::temp_directory_path() / "doptions-bloat").string();
+
+  auto cli = doptions::Application::createApp();
+  cli.addOption("--options", &optionCounts);
+  cli.addOption("--types", &typeCounts);
+  cli.addOption("--compiler", &cxx);
+  cli.addOption("--include", &includeDir);
+  cli.addOption("--flags", &flags);
+  cli.addOption("--work-dir", &workDir);
+
+  try {
+    cli.parse(argc, argv);
+    std::filesystem::create_directories(workDir);
+    std::printf("%8s %6s %10s %12s %12s %12s %11s\n", "options", "types",
+                "compile s", "object B", "obj .text B", "exe .text B",
+                ".text/opt");
+    for (const size_t options : optionCounts) {
+      for (const size_t types : typeCounts) {
+        if (types > options) {
+          continue;
+        }
+        const auto stem = std::filesystem::path(workDir) /
+                          ("bloat_" + std::to_string(options) + "_" +
+                           std::to_string(types));
+        const auto source = stem.string() + ".cpp";
+        const auto object = stem.string() + ".o";
+        const auto binary = stem.string();
+        generate(source, options, types);
+        const double seconds =
+            run(cxx + " -std=c++20 " + flags + " -I" + includeDir + " -c " +
+                source + " -o " + object);
+        run(cxx + " " + object + " -o " + binary);
+        const auto objectSizes = elfSizes(object);
+        const auto binarySizes = elfSizes(binary);
+        std::printf("%8zu %6zu %10.2f %12zu %12zu %12zu %11.1f\n", options,
+                    types, seconds, objectSizes.file, objectSizes.text,
+                    binarySizes.text,
+                    static_cast<double>(binarySizes.text) /
+                        static_cast<double>(options));
+        std::fflush(stdout);
+      }
+    }
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "bloat_benchmark: %s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
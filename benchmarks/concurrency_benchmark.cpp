@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <doptions/application.hpp>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures how aggregate parse throughput scales with the number of threads
+// when every thread owns its applications, so contention and false sharing
+// in state shared between applications show up as lost speedup.
+//
+//   doptions_concurrency_benchmark [--threads 1,2,4,8] [-n 20000]
+//                                  [--options 20] [--tokens 400000]
+//
+// "build+parse" constructs, parses and destroys an application per
+// operation, which exercises name validation and index construction.
+// "reparse" parses again with an application each thread built once.
+// "parallel parse" times one parse of a command line of --tokens tokens
+// with its conversions split over the given numbers of threads.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+auto optionName(size_t idx) -> std::string {
+  return "--benchmark-option-" + std::to_string(idx);
+}
+
+// One application with its bound values and a command line setting every
+// option.
+class Workload {
+ public:
+  explicit Workload(size_t options) : ints_(options) {
+    for (size_t idx = 0; idx < options; ++idx) {
+      app_.addOption(optionName(idx), &ints_[idx]);
+    }
+    args_.emplace_back("benchmark");
+    for (size_t idx = 0; idx < options; ++idx) {
+      args_.push_back(optionName(idx));
+      args_.push_back(std::to_string(idx));
+    }
+    for (auto& arg : args_) {
+      argv_.push_back(arg.data());
+    }
+  }
+
+  auto parse() -> void {
+    app_.parse(static_cast<int32_t>(argv_.size()), argv_.data());
+  }
+
+  auto setParallelParse(const doptions::ParallelParseConfig& config) -> void {
+    app_.setParallelParse(config);
+  }
+
+ private:
+  std::vector<int32_t> ints_;
+  doptions::Application app_ = doptions::Application::createApp();
+  std::vector<std::string> args_;
+  std::vector<char*> argv_;
+};
+
+// Milliseconds per parse of one large command line, sequential and with
+// conversions spread over each thread count.
+auto reportParallelParse(const std::vector<size_t>& threadCounts,
+                         size_t tokens) -> void {
+  Workload workload(tokens / 2);
+  auto timeParse = [&workload] {
+    constexpr size_t rounds = 5;
+    const auto begin = Clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+      workload.parse();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+               .count() /
+           rounds;
+  };
+  std::printf("parallel parse, %zu tokens\n", tokens);
+  std::printf("  %7s %14s %9s\n", "threads", "ms/parse", "speedup");
+  const double sequential = timeParse();
+  std::printf("  %7s %14.2f %8.2fx\n", "off", sequential, 1.0);
+  for (const size_t threads : threadCounts) {
+    doptions::ParallelParseConfig config;
+    config.threshold = 0;
+    config.maxThreads = threads;
+    workload.setParallelParse(config);
+    const double elapsed = timeParse();
+    std::printf("  %7zu %14.2f %8.2fx\n", threads, elapsed,
+                sequential / elapsed);
+  }
+  std::printf("\n");
+}
+
+// Per-thread result on its own cache line so the benchmark does not add
+// false sharing of its own.
+struct alignas(64) ThreadResult {
+  double seconds{0};
+};
+
+// Aggregate operations per second over the given number of threads, each
+// running iterations operations after a common start.
+template <typename Operation>
+auto throughput(size_t threads, size_t iterations, Operation operation)
+    -> double {
+  std::vector<ThreadResult> results(threads);
+  std::barrier start(static_cast<std::ptrdiff_t>(threads));
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (size_t idx = 0; idx < threads; ++idx) {
+    workers.emplace_back([&, idx] {
+      start.arrive_and_wait();
+      const auto begin = Clock::now();
+      operation(iterations);
+      results[idx].seconds =
+          std::chrono::duration<double>(Clock::now() - begin).count();
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double slowest = 0;
+  for (const auto& result : results) {
+    slowest = std::max(slowest, result.seconds);
+  }
+  return static_cast<double>(threads * iterations) / slowest;
+}
+
+template <typename Operation>
+auto report(const char* label, const std::vector<size_t>& threadCounts,
+            size_t iterations, Operation operation) -> void {
+  std::printf("%s\n", label);
+  std::printf("  %7s %14s %9s %11s\n", "threads", "ops/s", "speedup",
+              "efficiency");
+  double single = 0;
+  for (const size_t threads : threadCounts) {
+    const double rate = throughput(threads, iterations, operation);
+    if (single == 0) {
+      single = rate / static_cast<double>(threads);
+    }
+    const double speedup = rate / single;
+    std::printf("  %7zu %14.0f %8.2fx %10.0f%%\n", threads, rate, speedup,
+                100 * speedup / static_cast<double>(threads));
+  }
+  std::printf("\n");
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  const size_t hardware =
+      std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  std::vector<size_t> threadCounts;
+  for (size_t threads = 1; threads < hardware; threads *= 2) {
+    threadCounts.push_back(threads);
+  }
+  threadCounts.push_back(hardware);
+  uint32_t iterations = 20000;
+  uint32_t options = 20;
+  uint32_t tokens = 400000;
+
+  auto cli = doptions::Application::createApp();
+  cli.addOption("--threads", &threadCounts);
+  cli.addOption("-n,--iterations", &iterations);
+  cli.addOption("--options", &options);
+  cli.addOption("--tokens", &tokens);
+  try {
+    cli.parse(argc, argv);
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "concurrency_benchmark: %s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  std::erase(threadCounts, 0);
+  if (threadCounts.empty() || options == 0) {
+    std::fprintf(stderr, "concurrency_benchmark: nothing to measure\n");
+    return EXIT_FAILURE;
+  }
+
+  auto reparse = [options](size_t count) {
+    Workload workload(options);
+    for (size_t round = 0; round < count; ++round) {
+      workload.parse();
+    }
+  };
+  auto buildAndParse = [options](size_t count) {
+    for (size_t round = 0; round < count; ++round) {
+      Workload workload(options);
+      workload.parse();
+    }
+  };
+  std::printf("hardware threads: %zu, %u options\n\n", hardware, options);
+  report("reparse", threadCounts, iterations, reparse);
+  // Building allocates far more per operation, run fewer of them.
+  report("build+parse", threadCounts,
+         std::max<size_t>(iterations / 10, 1), buildAndParse);
+  if (tokens >= 2) {
+    reportParallelParse(threadCounts, tokens);
+  }
+  return EXIT_SUCCESS;
+}
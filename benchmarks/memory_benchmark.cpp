@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <doptions/application.hpp>
+#include <new>
+#include <string>
+#include <vector>
+
+// Reports the heap cost of large schemas per option, comparing the figures
+// of Application::memoryUsage with the bytes seen by the global allocator.
+// Exits with a failure when the two differ.
+
+namespace {
+
+size_t liveBytes = 0;  // NOLINT
+
+constexpr size_t headerSize = alignof(std::max_align_t);
+
+}  // namespace
+
+auto operator new(size_t size) -> void* {
+  auto* block = static_cast<char*>(std::malloc(size + headerSize));  // NOLINT
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>(block) = size;  // NOLINT
+  liveBytes += size;
+  return block + headerSize;  // NOLINT
+}
+
+auto operator new[](size_t size) -> void* { return ::operator new(size); }
+
+auto operator delete(void* ptr) noexcept -> void {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto* block = static_cast<char*>(ptr) - headerSize;  // NOLINT
+  liveBytes -= *reinterpret_cast<size_t*>(block);      // NOLINT
+  std::free(block);                                    // NOLINT
+}
+
+auto operator delete[](void* ptr) noexcept -> void { ::operator delete(ptr); }
+
+auto operator delete(void* ptr, size_t /*size*/) noexcept -> void {
+  ::operator delete(ptr);
+}
+
+auto operator delete[](void* ptr, size_t /*size*/) noexcept -> void {
+  ::operator delete(ptr);
+}
+
+// std::pmr::new_delete_resource, behind the schema arena, allocates through
+// the aligned forms. The block starts alignment bytes before the pointer
+// and the size sits right before it, as for the plain forms.
+auto operator new(size_t size, std::align_val_t align) -> void* {
+  const size_t alignment = std::max(static_cast<size_t>(align), headerSize);
+  const size_t bytes = (size + 2 * alignment - 1) / alignment * alignment;
+  auto* block = static_cast<char*>(std::aligned_alloc(alignment, bytes));
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>(block + alignment - headerSize) = size;  // NOLINT
+  liveBytes += size;
+  return block + alignment;  // NOLINT
+}
+
+auto operator delete(void* ptr, std::align_val_t align) noexcept -> void {
+  if (ptr == nullptr) {
+    return;
+  }
+  const size_t alignment = std::max(static_cast<size_t>(align), headerSize);
+  auto* block = static_cast<char*>(ptr) - alignment;  // NOLINT
+  auto* header = static_cast<char*>(ptr) - headerSize;  // NOLINT
+  liveBytes -= *reinterpret_cast<size_t*>(header);      // NOLINT
+  std::free(block);                                     // NOLINT
+}
+
+auto operator delete(void* ptr, size_t /*size*/,
+                     std::align_val_t align) noexcept -> void {
+  ::operator delete(ptr, align);
+}
+
+namespace {
+
+constexpr size_t optionCount = 2000;
+
+struct Storage {
+  std::vector<int32_t> ints = std::vector<int32_t>(optionCount);
+  std::vector<std::string> strings = std::vector<std::string>(optionCount);
+  std::vector<char> flags = std::vector<char>(optionCount);
+};
+
+auto optionName(size_t idx) -> std::string {
+  return "--benchmark-option-" + std::to_string(idx);
+}
+
+auto report(const char* layout, const doptions::MemoryUsage& usage,
+            size_t measured) -> void {
+  std::printf("%-22s %8zu %10zu %10zu %8zu %8zu %8zu %8zu %8zu %10.1f\n",
+              layout, usage.options, usage.names, usage.lookupTables,
+              usage.commands, usage.scratch, usage.arena, usage.total(),
+              measured, static_cast<double>(measured) / optionCount);
+}
+
+auto measureLayout(const char* layout, Storage& storage,
+                   doptions::StorageConfig config) -> bool {
+  std::string first = optionName(0);
+  std::string value = "1";
+  std::vector<char*> argv = {first.data(), first.data(), value.data()};
+  const size_t before = liveBytes;
+  auto app = doptions::Application::createApp(config);
+  for (size_t idx = 0; idx < optionCount; ++idx) {
+    switch (idx % 3) {
+      case 0:
+        app.addOption(optionName(idx), &storage.ints[idx]);
+        break;
+      case 1:
+        app.addOption(optionName(idx), &storage.strings[idx]);
+        break;
+      default:
+        app.addOption(optionName(idx),
+                      reinterpret_cast<bool*>(&storage.flags[idx]));  // NOLINT
+        break;
+    }
+  }
+  app.parse(static_cast<int32_t>(argv.size()), argv.data());
+  const size_t measured = liveBytes - before;
+  const auto usage = app.memoryUsage();
+  report(layout, usage, measured);
+  return usage.total() == measured;
+}
+
+// Creates the process-wide configuration read while registering options, so
+// its allocation is not measured as part of the first schema.
+auto warmUp() -> void {
+  int32_t value = 0;
+  auto app = doptions::Application::createApp();
+  app.addOption("--warm-up", &value);
+}
+
+}  // namespace
+
+auto main() -> int {
+  Storage storage;
+  std::printf("%zu options, bytes by category\n", optionCount);
+  std::printf("%-22s %8s %10s %10s %8s %8s %8s %8s %8s %10s\n", "layout",
+              "options", "names", "lookup", "commands", "scratch", "arena",
+              "accounted", "measured", "per-option");
+  warmUp();
+  bool exact = measureLayout("unique_ptr<Option>", storage, {});
+  exact = measureLayout("arena", storage, {.arena = true}) && exact;
+  if (!exact) {
+    std::fprintf(stderr, "accounted and measured bytes differ\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
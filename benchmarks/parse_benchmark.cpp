@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <doptions/application.hpp>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "perf_counters.hpp"
+
+// Measures Application::parse over synthetic command lines for several
+// registry sizes and reports wall time and hardware counters per parse and
+// per token. Counters print as n/a where perf_event_open is not permitted.
+//
+// With --json, each scenario is instead measured --repetitions times and the
+// nanoseconds per parse of every repetition are written as samples for
+// perf_gate.
+
+namespace {
+
+struct Scenario {
+  size_t options;
+  size_t flags;
+};
+
+constexpr Scenario scenarios[] = {{10, 5}, {100, 20}, {1000, 20}, {10000, 50}};
+
+auto optionName(size_t idx) -> std::string {
+  return "--benchmark-option-" + std::to_string(idx);
+}
+
+auto scenarioName(const Scenario& scenario) -> std::string {
+  return "parse/" + std::to_string(scenario.options) + "-options/" +
+         std::to_string(scenario.flags * 2) + "-tokens";
+}
+
+class Fixture {
+ public:
+  explicit Fixture(const Scenario& scenario) : ints_(scenario.options) {
+    for (size_t idx = 0; idx < scenario.options; ++idx) {
+      app_.addOption(optionName(idx), &ints_[idx]);
+    }
+    // Spread the given options over the registry so lookups hit different
+    // parts of the index.
+    args_.emplace_back("benchmark");
+    const size_t stride = scenario.options / scenario.flags;
+    for (size_t idx = 0; idx < scenario.flags; ++idx) {
+      args_.push_back(optionName(idx * stride));
+      args_.push_back(std::to_string(idx));
+    }
+    for (auto& arg : args_) {
+      argv_.push_back(arg.data());
+    }
+    parse();
+  }
+
+  auto parse() -> void {
+    app_.parse(static_cast<int32_t>(argv_.size()), argv_.data());
+  }
+
+  [[nodiscard]] auto tokens() const -> size_t { return args_.size() - 1; }
+
+  // Average nanoseconds per parse over the given number of parses.
+  auto measure(size_t iterations) -> double {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < iterations; ++round) {
+      parse();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return static_cast<double>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(stop -
+                                                                    start)
+                   .count()) /
+           static_cast<double>(iterations);
+  }
+
+ private:
+  std::vector<int32_t> ints_;
+  doptions::Application app_ = doptions::Application::createApp();
+  std::vector<std::string> args_;
+  std::vector<char*> argv_;
+};
+
+auto report(const Scenario& scenario, size_t iterations,
+            doptions::bench::PerfCounters& counters) -> void {
+  Fixture fixture(scenario);
+  counters.start();
+  const double nanos = fixture.measure(iterations);
+  const auto reading = counters.stop();
+  const size_t tokens = fixture.tokens();
+  std::printf("%zu options, %zu tokens per parse\n", scenario.options, tokens);
+  std::printf("  %-14s %12s %12s\n", "", "per parse", "per token");
+  std::printf("  %-14s %12.1f %12.2f\n", "wall ns", nanos,
+              nanos / static_cast<double>(tokens));
+  doptions::bench::PerfCounters::print(reading, iterations,
+                                       iterations * tokens);
+  std::printf("\n");
+}
+
+auto writeSamples(const std::string& path, size_t iterations,
+                  size_t repetitions) -> void {
+  std::ofstream out(path);
+  out << "{\n";
+  bool first = true;
+  for (const auto& scenario : scenarios) {
+    Fixture fixture(scenario);
+    fixture.measure(iterations);
+    out << (first ? "" : ",\n") << "  \"" << scenarioName(scenario)
+        << "\": {\"samples\": [";
+    for (size_t rep = 0; rep < repetitions; ++rep) {
+      out << (rep == 0 ? "" : ", ") << fixture.measure(iterations);
+    }
+    out << "]}";
+    first = false;
+  }
+  out << "\n}\n";
+  if (!out) {
+    throw std::runtime_error("cannot write " + path);
+  }
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  std::string jsonPath;
+  uint32_t iterations = 20000;
+  uint32_t repetitions = 15;
+
+  auto cli = doptions::Application::createApp();
+  cli.addOption("--json", &jsonPath);
+  cli.addOption("-n,--iterations", &iterations);
+  cli.addOption("-r,--repetitions", &repetitions);
+  try {
+    cli.parse(argc, argv);
+    if (!jsonPath.empty()) {
+      writeSamples(jsonPath, iterations, repetitions);
+      return EXIT_SUCCESS;
+    }
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "parse_benchmark: %s\n", error.what());
+    return EXIT_FAILURE;
+  }
+
+  doptions::bench::PerfCounters counters;
+  if (!counters.available()) {
+    std::printf("hardware counters unavailable, reporting wall time only\n\n");
+  }
+  for (const auto& scenario : scenarios) {
+    report(scenario, iterations, counters);
+  }
+  return EXIT_SUCCESS;
+}
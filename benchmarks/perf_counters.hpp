@@ -0,0 +1,152 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifndef DOPTIONS_BENCHMARKS_PERF_COUNTERS_HPP
+#define DOPTIONS_BENCHMARKS_PERF_COUNTERS_HPP
+
+namespace doptions::bench {
+
+// Hardware counters of the calling thread, read with perf_event_open. Each
+// counter is opened on its own so that the ones the machine or container
+// does not allow are reported as missing while the others still work.
+// Values are scaled when the kernel multiplexes counters.
+class PerfCounters {
+ public:
+  enum Counter : uint8_t {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1dMisses,
+    LlcMisses,
+    CounterCount,
+  };
+
+  static constexpr std::array<std::string_view, CounterCount> names = {
+      "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses"};
+
+  struct Reading {
+    std::array<double, CounterCount> values{};
+    std::array<bool, CounterCount> valid{};
+  };
+
+  PerfCounters() {
+#if defined(__linux__)
+    constexpr uint64_t cacheReadMiss =
+        (uint64_t{PERF_COUNT_HW_CACHE_OP_READ} << 8U) |
+        (uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16U);
+    fds_[Cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds_[Instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds_[BranchMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fds_[L1dMisses] =
+        open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cacheReadMiss);
+    fds_[LlcMisses] =
+        open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cacheReadMiss);
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  auto operator=(const PerfCounters&) -> PerfCounters& = delete;
+
+  ~PerfCounters() {
+#if defined(__linux__)
+    for (const int fd : fds_) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+#endif
+  }
+
+  // Whether at least one counter could be opened.
+  [[nodiscard]] auto available() const -> bool {
+    for (const int fd : fds_) {
+      if (fd >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  auto start() -> void {
+#if defined(__linux__)
+    for (const int fd : fds_) {
+      if (fd >= 0) {
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);  // NOLINT
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);  // NOLINT
+      }
+    }
+#endif
+  }
+
+  auto stop() -> Reading {
+    Reading reading;
+#if defined(__linux__)
+    for (const int fd : fds_) {
+      if (fd >= 0) {
+        ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);  // NOLINT
+      }
+    }
+    for (size_t idx = 0; idx < CounterCount; ++idx) {
+      // value, time enabled, time running
+      std::array<uint64_t, 3> data{};
+      if (fds_[idx] < 0 ||
+          ::read(fds_[idx], data.data(), sizeof(data)) != sizeof(data) ||
+          data[2] == 0) {
+        continue;
+      }
+      reading.values[idx] = static_cast<double>(data[0]) *
+                            static_cast<double>(data[1]) /
+                            static_cast<double>(data[2]);
+      reading.valid[idx] = true;
+    }
+#endif
+    return reading;
+  }
+
+  // Prints one line per counter, divided by the given operation and token
+  // counts.
+  static auto print(const Reading& reading, size_t operations, size_t tokens)
+      -> void {
+    for (size_t idx = 0; idx < CounterCount; ++idx) {
+      if (!reading.valid[idx]) {
+        std::printf("  %-14s %12s %12s\n", names[idx].data(), "n/a", "n/a");
+        continue;
+      }
+      std::printf("  %-14s %12.1f %12.2f\n", names[idx].data(),
+                  reading.values[idx] / static_cast<double>(operations),
+                  reading.values[idx] / static_cast<double>(tokens));
+    }
+  }
+
+ private:
+#if defined(__linux__)
+  static auto open(uint32_t type, uint64_t config) -> int {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(
+        ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));  // NOLINT
+  }
+#endif
+
+  std::array<int, CounterCount> fds_{-1, -1, -1, -1, -1};
+};
+
+}  // namespace doptions::bench
+
+#endif  // !DOPTIONS_BENCHMARKS_PERF_COUNTERS_HPP
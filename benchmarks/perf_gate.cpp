@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <doptions/application.hpp>
+#include <doptions/json.hpp>
+#include <doptions/list.hpp>
+#include <doptions/mapped_file.hpp>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// Compares benchmark samples against a stored baseline and fails when a
+// benchmark got slower beyond noise.
+//
+//   doptions_perf_gate --baseline baseline.json --results results.json
+//                      [--tolerance 0.10] [--alpha 0.01] [--update]
+//
+// Both files map benchmark names to {"samples": [...]} in nanoseconds; the
+// baseline may add a per-benchmark "tolerance". A benchmark regresses when
+// its median grew by more than the tolerance and a one-sided Mann-Whitney U
+// test says the current samples are larger with p < alpha. Outlier
+// repetitions alone do not fail the gate, and neither do slowdowns within
+// the tolerance, however consistent.
+// --update rewrites the baseline from the results, keeping tolerances.
+
+namespace {
+
+struct Benchmark {
+  std::vector<double> samples;
+  double tolerance{-1.0};
+};
+
+using Benchmarks = std::map<std::string, Benchmark>;
+
+auto readBenchmarks(const std::string& path) -> Benchmarks {
+  auto file = doptions::MappedFile::open(path);
+  Benchmarks benchmarks;
+  auto readBenchmark = [&benchmarks](std::string_view name, bool /*escaped*/,
+                                     const doptions::JsonValue& value) {
+    if (value.kind != doptions::JsonValue::Kind::Object) {
+      throw std::runtime_error("benchmark entry is not an object: " +
+                               std::string(name));
+    }
+    auto& benchmark = benchmarks[std::string(name)];
+    auto readField = [&benchmark](std::string_view field, bool /*escaped*/,
+                                  const doptions::JsonValue& fieldValue) {
+      if (field == "samples") {
+        benchmark.samples =
+            doptions::ListConversions::convert<double>(fieldValue.text);
+      } else if (field == "tolerance") {
+        benchmark.tolerance = doptions::fromChars<double>(fieldValue.text);
+      }
+    };
+    doptions::JsonReader::forEachMember(value.text, readField);
+  };
+  doptions::JsonReader::forEachMember(file.view(), readBenchmark);
+  return benchmarks;
+}
+
+auto writeBenchmarks(const std::string& path, const Benchmarks& benchmarks)
+    -> void {
+  std::ofstream out(path);
+  out << "{\n";
+  bool first = true;
+  for (const auto& [name, benchmark] : benchmarks) {
+    out << (first ? "" : ",\n") << "  \"" << name << "\": {";
+    if (benchmark.tolerance >= 0) {
+      out << "\"tolerance\": " << benchmark.tolerance << ", ";
+    }
+    out << "\"samples\": [";
+    for (size_t idx = 0; idx < benchmark.samples.size(); ++idx) {
+      out << (idx == 0 ? "" : ", ") << benchmark.samples[idx];
+    }
+    out << "]}";
+    first = false;
+  }
+  out << "\n}\n";
+  if (!out) {
+    throw std::runtime_error("cannot write " + path);
+  }
+}
+
+auto median(std::vector<double> values) -> double {
+  std::sort(values.begin(), values.end());
+  const size_t mid = values.size() / 2;
+  return values.size() % 2 == 1 ? values[mid]
+                                : (values[mid - 1] + values[mid]) / 2;
+}
+
+// One-sided p-value that the current samples come from a distribution
+// shifted above the baseline, using the normal approximation with tie and
+// continuity corrections.
+auto mannWhitneyGreater(const std::vector<double>& baseline,
+                        const std::vector<double>& current) -> double {
+  struct Ranked {
+    double value;
+    bool isCurrent;
+  };
+  std::vector<Ranked> all;
+  for (const double value : baseline) {
+    all.push_back({value, false});
+  }
+  for (const double value : current) {
+    all.push_back({value, true});
+  }
+  std::sort(all.begin(), all.end(), [](const Ranked& lhs, const Ranked& rhs) {
+    return lhs.value < rhs.value;
+  });
+
+  const auto total = static_cast<double>(all.size());
+  double currentRanks = 0;
+  double tieTerm = 0;
+  for (size_t begin = 0; begin < all.size();) {
+    size_t end = begin;
+    while (end < all.size() && all[end].value == all[begin].value) {
+      ++end;
+    }
+    const double rank = (static_cast<double>(begin + end) + 1) / 2;
+    const auto ties = static_cast<double>(end - begin);
+    tieTerm += ties * ties * ties - ties;
+    for (size_t idx = begin; idx < end; ++idx) {
+      currentRanks += all[idx].isCurrent ? rank : 0;
+    }
+    begin = end;
+  }
+
+  const auto sizeBase = static_cast<double>(baseline.size());
+  const auto sizeCurrent = static_cast<double>(current.size());
+  const double statistic =
+      currentRanks - sizeCurrent * (sizeCurrent + 1) / 2;
+  const double mean = sizeBase * sizeCurrent / 2;
+  const double variance = sizeBase * sizeCurrent / 12 *
+                          ((total + 1) - tieTerm / (total * (total - 1)));
+  if (variance <= 0) {
+    return 1.0;
+  }
+  const double zScore = (statistic - mean - 0.5) / std::sqrt(variance);
+  return 0.5 * std::erfc(zScore / std::sqrt(2.0));
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  std::string baselinePath;
+  std::string resultsPath;
+  double defaultTolerance = 0.10;
+  double alpha = 0.01;
+  bool update = false;
+
+  auto cli = doptions::Application::createApp();
+  cli.addOption("--baseline", &baselinePath);
+  cli.addOption("--results", &resultsPath);
+  cli.addOption("--tolerance", &defaultTolerance);
+  cli.addOption("--alpha", &alpha);
+  cli.addOption("--update", &update);
+
+  try {
+    cli.parse(argc, argv);
+    if (baselinePath.empty() || resultsPath.empty()) {
+      throw std::runtime_error("--baseline and --results are required");
+    }
+    const auto results = readBenchmarks(resultsPath);
+
+    if (update) {
+      Benchmarks updated = results;
+      try {
+        for (const auto& [name, benchmark] : readBenchmarks(baselinePath)) {
+          if (auto iter = updated.find(name); iter != updated.end()) {
+            iter->second.tolerance = benchmark.tolerance;
+          }
+        }
+      } catch (const std::system_error&) {
+        // No baseline yet.
+      }
+      writeBenchmarks(baselinePath, updated);
+      std::printf("baseline %s updated with %zu benchmarks\n",
+                  baselinePath.c_str(), updated.size());
+      return EXIT_SUCCESS;
+    }
+
+    const auto baseline = readBenchmarks(baselinePath);
+    size_t failures = 0;
+    std::printf("%-36s %11s %11s %8s %6s %9s  %s\n", "benchmark",
+                "base ns", "current ns", "change", "tol", "p-value",
+                "verdict");
+    for (const auto& [name, base] : baseline) {
+      auto iter = results.find(name);
+      if (iter == results.end() || iter->second.samples.empty()) {
+        std::printf("%-36s %11s %11s %8s %6s %9s  %s\n", name.c_str(), "-",
+                    "-", "-", "-", "-", "MISSING");
+        ++failures;
+        continue;
+      }
+      const auto& current = iter->second.samples;
+      const double tolerance =
+          base.tolerance >= 0 ? base.tolerance : defaultTolerance;
+      const double baseMedian = median(base.samples);
+      const double currentMedian = median(current);
+      const double change = currentMedian / baseMedian - 1;
+      const double pValue = mannWhitneyGreater(base.samples, current);
+      const bool regressed = change > tolerance && pValue < alpha;
+      const char* verdict = "ok";
+      if (regressed) {
+        verdict = "REGRESSION";
+        ++failures;
+      } else if (change > tolerance) {
+        verdict = "noisy";
+      } else if (change < -tolerance &&
+                 mannWhitneyGreater(current, base.samples) < alpha) {
+        verdict = "faster";
+      }
+      std::printf("%-36s %11.1f %11.1f %+7.1f%% %5.0f%% %9.2g  %s\n",
+                  name.c_str(), baseMedian, currentMedian, change * 100,
+                  tolerance * 100, pValue, verdict);
+    }
+    for (const auto& [name, benchmark] : results) {
+      if (!baseline.contains(name)) {
+        std::printf("%-36s %11s %11.1f %8s %6s %9s  %s\n", name.c_str(), "-",
+                    median(benchmark.samples), "-", "-", "-", "new");
+      }
+    }
+    if (failures > 0) {
+      std::printf("\n%zu benchmark(s) failed the gate\n", failures);
+      return EXIT_FAILURE;
+    }
+    std::printf("\nall benchmarks within tolerance\n");
+    return EXIT_SUCCESS;
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "perf_gate: %s\n", error.what());
+    return EXIT_FAILURE;
+  }
+}
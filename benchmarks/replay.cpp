@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <doptions/application.hpp>
+#include <doptions/mapped_file.hpp>
+#include <doptions/schema.hpp>
+#include <exception>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "perf_counters.hpp"
+
+// Replays recorded command lines through an application built from a schema
+// and reports throughput, latency percentiles, allocations and the share of
+// command lines that took the error path. Hardware counters over the
+// measured rounds are added where perf_event_open is permitted.
+//
+//   doptions_replay --schema tool.schema --corpus commands.txt [-z]
+//                   [--iterations N] [--warmup N]
+//
+// The corpus holds one shell-quoted command line per line, blank lines and
+// lines starting with # are skipped. With -z it holds NUL-separated
+// arguments instead, each command line ending with an empty argument, as in
+// concatenated /proc/<pid>/cmdline dumps followed by a NUL. The first word
+// of every command line is the program name.
+
+namespace {
+
+size_t allocations = 0;     // NOLINT
+size_t allocatedBytes = 0;  // NOLINT
+
+auto countedAlloc(size_t size) -> void* {
+  ++allocations;
+  allocatedBytes += size;
+  void* ptr = std::malloc(size == 0 ? 1 : size);  // NOLINT
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+// aligned_alloc wants the size rounded up to a multiple of the alignment.
+auto countedAlloc(size_t size, std::align_val_t align) -> void* {
+  const auto alignment = static_cast<size_t>(align);
+  ++allocations;
+  allocatedBytes += size;
+  const size_t rounded =
+      std::max(alignment, (size + alignment - 1) / alignment * alignment);
+  void* ptr = std::aligned_alloc(alignment, rounded);  // NOLINT
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+}  // namespace
+
+auto operator new(size_t size) -> void* { return countedAlloc(size); }
+
+auto operator new[](size_t size) -> void* { return countedAlloc(size); }
+
+auto operator new(size_t size, std::align_val_t align) -> void* {
+  return countedAlloc(size, align);
+}
+
+auto operator new[](size_t size, std::align_val_t align) -> void* {
+  return countedAlloc(size, align);
+}
+
+auto operator delete(void* ptr) noexcept -> void { std::free(ptr); }  // NOLINT
+
+auto operator delete[](void* ptr) noexcept -> void {
+  std::free(ptr);  // NOLINT
+}
+
+auto operator delete(void* ptr, size_t /*size*/) noexcept -> void {
+  std::free(ptr);  // NOLINT
+}
+
+auto operator delete[](void* ptr, size_t /*size*/) noexcept -> void {
+  std::free(ptr);  // NOLINT
+}
+
+auto operator delete(void* ptr, std::align_val_t /*align*/) noexcept -> void {
+  std::free(ptr);  // NOLINT
+}
+
+auto operator delete[](void* ptr, std::align_val_t /*align*/) noexcept
+    -> void {
+  std::free(ptr);  // NOLINT
+}
+
+auto operator delete(void* ptr, size_t /*size*/,
+                     std::align_val_t /*align*/) noexcept -> void {
+  std::free(ptr);  // NOLINT
+}
+
+auto operator delete[](void* ptr, size_t /*size*/,
+                       std::align_val_t /*align*/) noexcept -> void {
+  std::free(ptr);  // NOLINT
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct CommandLine {
+  std::vector<std::string> args;
+  std::vector<char*> argv;
+};
+
+struct Sample {
+  uint64_t nanos;
+  size_t allocations;
+  size_t bytes;
+};
+
+// Splits one line the way a POSIX shell splits words, without expansions.
+auto splitShellWords(std::string_view line) -> std::vector<std::string> {
+  std::vector<std::string> words;
+  std::string word;
+  bool inWord = false;
+  for (size_t idx = 0; idx < line.size(); ++idx) {
+    const char chr = line[idx];
+    if (chr == ' ' || chr == '\t' || chr == '\r') {
+      if (inWord) {
+        words.push_back(std::move(word));
+        word.clear();
+        inWord = false;
+      }
+      continue;
+    }
+    inWord = true;
+    if (chr == '\'') {
+      const size_t close = line.find('\'', idx + 1);
+      if (close == std::string_view::npos) {
+        throw std::runtime_error("unterminated single quote");
+      }
+      word.append(line.substr(idx + 1, close - idx - 1));
+      idx = close;
+    } else if (chr == '"') {
+      for (++idx; idx < line.size() && line[idx] != '"'; ++idx) {
+        if (line[idx] == '\\' && idx + 1 < line.size() &&
+            std::string_view("\"\\$`").find(line[idx + 1]) !=
+                std::string_view::npos) {
+          ++idx;
+        }
+        word.push_back(line[idx]);
+      }
+      if (idx == line.size()) {
+        throw std::runtime_error("unterminated double quote");
+      }
+    } else if (chr == '\\' && idx + 1 < line.size()) {
+      word.push_back(line[++idx]);
+    } else {
+      word.push_back(chr);
+    }
+  }
+  if (inWord) {
+    words.push_back(std::move(word));
+  }
+  return words;
+}
+
+auto readCorpus(std::string_view text, bool nulSeparated)
+    -> std::vector<CommandLine> {
+  std::vector<CommandLine> corpus;
+  if (nulSeparated) {
+    CommandLine current;
+    size_t begin = 0;
+    while (begin < text.size()) {
+      size_t end = text.find('\0', begin);
+      if (end == std::string_view::npos) {
+        end = text.size();
+      }
+      if (end == begin) {
+        if (!current.args.empty()) {
+          corpus.push_back(std::move(current));
+          current = CommandLine{};
+        }
+      } else {
+        current.args.emplace_back(text.substr(begin, end - begin));
+      }
+      begin = end + 1;
+    }
+    if (!current.args.empty()) {
+      corpus.push_back(std::move(current));
+    }
+  } else {
+    size_t begin = 0;
+    while (begin < text.size()) {
+      size_t end = text.find('\n', begin);
+      if (end == std::string_view::npos) {
+        end = text.size();
+      }
+      auto line = doptions::StringUtils::trim(text.substr(begin, end - begin));
+      if (!line.empty() && line.front() != '#') {
+        corpus.push_back(CommandLine{splitShellWords(line), {}});
+      }
+      begin = end + 1;
+    }
+  }
+  for (auto& entry : corpus) {
+    for (auto& arg : entry.args) {
+      entry.argv.push_back(arg.data());
+    }
+    entry.argv.push_back(nullptr);
+  }
+  return corpus;
+}
+
+auto percentile(const std::vector<Sample>& sorted, double fraction)
+    -> uint64_t {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const auto idx =
+      static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+  return sorted[idx].nanos;
+}
+
+auto reportLatency(const char* label, std::vector<Sample> samples) -> void {
+  std::sort(samples.begin(), samples.end(),
+            [](const Sample& lhs, const Sample& rhs) {
+              return lhs.nanos < rhs.nanos;
+            });
+  size_t allocs = 0;
+  size_t bytes = 0;
+  for (const auto& sample : samples) {
+    allocs += sample.allocations;
+    bytes += sample.bytes;
+  }
+  const double count =
+      samples.empty() ? 1.0 : static_cast<double>(samples.size());
+  std::printf(
+      "%-8s %10zu %9llu %9llu %9llu %9llu %9llu %10.1f %10.1f\n", label,
+      samples.size(), static_cast<unsigned long long>(percentile(samples, 0.5)),
+      static_cast<unsigned long long>(percentile(samples, 0.9)),
+      static_cast<unsigned long long>(percentile(samples, 0.99)),
+      static_cast<unsigned long long>(percentile(samples, 0.999)),
+      static_cast<unsigned long long>(samples.empty() ? 0
+                                                      : samples.back().nanos),
+      static_cast<double>(allocs) / count, static_cast<double>(bytes) / count);
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  std::string schemaPath;
+  std::string corpusPath;
+  bool nulSeparated = false;
+  uint32_t iterations = 10;
+  uint32_t warmup = 1;
+
+  auto cli = doptions::Application::createApp();
+  cli.addOption("--schema", &schemaPath);
+  cli.addOption("--corpus", &corpusPath);
+  cli.addOption("-z,--null", &nulSeparated);
+  cli.addOption("-n,--iterations", &iterations);
+  cli.addOption("--warmup", &warmup);
+  try {
+    cli.parse(argc, argv);
+    if (schemaPath.empty() || corpusPath.empty()) {
+      throw std::runtime_error("--schema and --corpus are required");
+    }
+    if (iterations == 0) {
+      throw std::runtime_error("--iterations must be at least 1");
+    }
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "doptions_replay: %s\n", error.what());
+    return EXIT_FAILURE;
+  }
+
+  std::optional<doptions::Schema> schema;
+  std::vector<CommandLine> corpus;
+  try {
+    schema.emplace(doptions::Schema::fromFile(schemaPath));
+    auto file = doptions::MappedFile::open(corpusPath);
+    corpus = readCorpus(file.view(), nulSeparated);
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "doptions_replay: %s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  if (corpus.empty()) {
+    std::fprintf(stderr, "doptions_replay: empty corpus\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Sample> successes;
+  std::vector<Sample> failures;
+  successes.reserve(corpus.size() * iterations);
+  failures.reserve(corpus.size() * iterations);
+  size_t arguments = 0;
+  uint64_t totalNanos = 0;
+  doptions::bench::PerfCounters counters;
+
+  for (uint32_t round = 0; round < warmup + iterations; ++round) {
+    const bool measured = round >= warmup;
+    if (round == warmup) {
+      counters.start();
+    }
+    for (auto& entry : corpus) {
+      const size_t allocsBefore = allocations;
+      const size_t bytesBefore = allocatedBytes;
+      bool failed = false;
+      const auto start = Clock::now();
+      try {
+        schema->app().parse(static_cast<int32_t>(entry.args.size()),
+                            entry.argv.data());
+      } catch (const std::exception&) {
+        failed = true;
+      }
+      const auto stop = Clock::now();
+      if (!measured) {
+        continue;
+      }
+      const Sample sample{
+          static_cast<uint64_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(stop -
+                                                                   start)
+                  .count()),
+          allocations - allocsBefore, allocatedBytes - bytesBefore};
+      totalNanos += sample.nanos;
+      arguments += entry.args.size() - 1;
+      (failed ? failures : successes).push_back(sample);
+    }
+  }
+  const auto reading = counters.stop();
+
+  const size_t parses = successes.size() + failures.size();
+  const double seconds = static_cast<double>(totalNanos) / 1e9;
+  std::printf("corpus: %zu command lines, %u iterations\n", corpus.size(),
+              iterations);
+  std::printf("throughput: %.0f parses/s, %.0f args/s\n",
+              static_cast<double>(parses) / seconds,
+              static_cast<double>(arguments) / seconds);
+  std::printf("error share: %.2f%%\n\n",
+              100.0 * static_cast<double>(failures.size()) /
+                  static_cast<double>(parses));
+  std::printf("%-8s %10s %9s %9s %9s %9s %9s %10s %10s\n", "path", "parses",
+              "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns",
+              "allocs/op", "bytes/op");
+  reportLatency("success", std::move(successes));
+  reportLatency("error", std::move(failures));
+  std::printf("\n  %-14s %12s %12s\n", "counters", "per parse", "per arg");
+  doptions::bench::PerfCounters::print(reading, parses, arguments);
+  return EXIT_SUCCESS;
+}
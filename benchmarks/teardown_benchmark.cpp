@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <doptions/application.hpp>
+#include <exception>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Measures how long building and destroying an application takes for large
+// schemas in each storage mode, which is what a short-lived CLI pays
+// before and at exit.
+//
+//   doptions_teardown_benchmark [--options 1000,10000,100000] [-n 5]
+//
+// Every schema mixes integer, string and list options and is parsed once
+// before it is destroyed. Times are the median over the repetitions.
+// With leakAtExit the destroyed applications stay in memory for the rest of
+// the run.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Mode {
+  const char* name;
+  doptions::StorageConfig storage;
+  bool leakAtExit;
+};
+
+struct Timing {
+  double buildMs{0};
+  double destroyMs{0};
+};
+
+auto optionName(size_t idx) -> std::string {
+  return "--benchmark-option-" + std::to_string(idx);
+}
+
+auto milliseconds(Clock::duration duration) -> double {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Bound variables, kept outside the application so destroying it only
+// measures the schema.
+struct Bindings {
+  explicit Bindings(size_t options)
+      : ints(options), strings(options), lists(options) {}
+
+  std::vector<int32_t> ints;
+  std::vector<std::string> strings;
+  std::vector<std::vector<int32_t>> lists;
+};
+
+auto measure(const Mode& mode, Bindings& bindings,
+             const std::vector<std::string>& names, std::vector<char*>& argv)
+    -> Timing {
+  Timing timing;
+  std::optional<doptions::Application> app;
+  const auto start = Clock::now();
+  app.emplace(doptions::Application::createApp(mode.storage));
+  for (size_t idx = 0; idx < names.size(); ++idx) {
+    switch (idx % 3) {
+      case 0:
+        app->addOption(names[idx], &bindings.ints[idx]);
+        break;
+      case 1:
+        app->addOption(names[idx], &bindings.strings[idx]);
+        break;
+      default:
+        app->addOption(names[idx], &bindings.lists[idx]);
+        break;
+    }
+  }
+  app->parse(static_cast<int32_t>(argv.size()), argv.data());
+  if (mode.leakAtExit) {
+    app->leakAtExit();
+  }
+  const auto built = Clock::now();
+  app.reset();
+  const auto destroyed = Clock::now();
+  timing.buildMs = milliseconds(built - start);
+  timing.destroyMs = milliseconds(destroyed - built);
+  return timing;
+}
+
+auto median(std::vector<double> values) -> double {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  std::vector<uint32_t> optionCounts = {1000, 10000, 100000};
+  uint32_t repetitions = 5;
+
+  auto cli = doptions::Application::createApp();
+  cli.addOption("--options", &optionCounts);
+  cli.addOption("-n,--repetitions", &repetitions);
+  try {
+    cli.parse(argc, argv);
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "teardown_benchmark: %s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  std::erase(optionCounts, 0);
+  if (optionCounts.empty() || repetitions == 0) {
+    std::fprintf(stderr, "teardown_benchmark: nothing to measure\n");
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<Mode> modes = {
+      {"heap", {}, false},
+      {"arena", {.arena = true}, false},
+      {"leak at exit", {}, true},
+      {"arena + leak at exit", {.arena = true}, true},
+  };
+  std::printf("%10s  %-22s %12s %12s\n", "options", "storage", "build ms",
+              "destroy ms");
+  for (const uint32_t options : optionCounts) {
+    Bindings bindings(options);
+    std::vector<std::string> names;
+    names.reserve(options);
+    for (size_t idx = 0; idx < options; ++idx) {
+      names.push_back(optionName(idx));
+    }
+    // Sets every third option, one of each kind.
+    std::vector<std::string> args = {"benchmark"};
+    for (size_t idx = 0; idx < options; idx += 3) {
+      args.push_back(names[idx]);
+      args.push_back(std::to_string(idx));
+    }
+    std::vector<char*> argvs;
+    for (auto& arg : args) {
+      argvs.push_back(arg.data());
+    }
+    for (const auto& mode : modes) {
+      std::vector<double> build;
+      std::vector<double> destroy;
+      for (uint32_t round = 0; round < repetitions; ++round) {
+        const auto timing = measure(mode, bindings, names, argvs);
+        build.push_back(timing.buildMs);
+        destroy.push_back(timing.destroyMs);
+      }
+      std::printf("%10u  %-22s %12.3f %12.3f\n", options, mode.name,
+                  median(build), median(destroy));
+    }
+  }
+  return EXIT_SUCCESS;
+}
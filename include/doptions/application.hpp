@@ -1,61 +1,494 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include "utils.hpp"
 #ifndef DOPTIONS_APPLICATION_HPP
 #define DOPTIONS_APPLICATION_HPP
 
+#include "array_file.hpp"
+#include "async.hpp"
 #include "command.hpp"
+#include "deprecations.hpp"
+#include "index.hpp"
+#include "interpolation.hpp"
+#include "json.hpp"
+#include "list.hpp"
+#include "mapped_file.hpp"
+#include "memory.hpp"
 #include "option.hpp"
+#include "preset.hpp"
+#include "struct_binding.hpp"
 
 namespace doptions {
 
+// Outcome of a previous Application::reparse call. Callers keep it between
+// calls and otherwise treat it as opaque.
+struct ParseState {
+  enum class Kind : uint8_t { Value, Option, Command };
+
+  struct Token {
+    Kind kind{Kind::Value};
+    size_t id{0};
+    // The value follows '=' in the same token.
+    bool attached{false};
+  };
+
+  std::vector<std::string> args;
+  std::vector<Token> tokens;
+  std::map<size_t, std::string> values;
+  std::optional<size_t> command;
+  size_t commandPos{0};
+  // Application::releaseConversionMemory calls seen by the previous parse.
+  uint64_t memoryEpoch{0};
+  // Application::setMatchPolicy calls seen by the previous parse.
+  uint64_t policyEpoch{0};
+  bool valid{false};
+};
+
+// When and how Application::parse converts option values concurrently.
+struct ParallelParseConfig {
+  // Command lines with fewer tokens than this are parsed on the calling
+  // thread.
+  size_t threshold{size_t{1} << 16U};
+  // Smallest number of values worth handing to a thread.
+  size_t minChunkValues{size_t{4} << 10U};
+  // Upper bound on threads, 0 uses std::thread::hardware_concurrency.
+  size_t maxThreads{0};
+};
+
+// How an Application holds its schema, see Application::createApp.
+struct StorageConfig {
+  // Options added by name for a single value are constructed in large
+  // blocks owned by the application and released together, instead of one
+  // heap allocation each. The pointers addOption returns for them do not
+  // own them and must not be reset or released.
+  bool arena{false};
+};
+
 class Application {
  public:
   static auto createApp() -> Application { return {}; }
 
+  static auto createApp(StorageConfig storage) -> Application {
+    Application app;
+    if (storage.arena) {
+      app.schemaMemory_ = std::make_unique<SchemaMemory>(schemaBlockSize);
+    }
+    return app;
+  }
+
+  Application(const Application&) = delete;
+  Application(Application&&) = default;
+  auto operator=(const Application&) -> Application& = delete;
+  auto operator=(Application&& other) noexcept -> Application&;
+  ~Application();
+
+  // Makes the destructor keep the whole application alive instead of
+  // destroying every option, name and table one by one. Only for an
+  // application that lives until the process exits, where that work just
+  // delays the exit: call it once nothing is left to parse, such as right
+  // before returning from main. Every destruction afterwards leaks.
+  auto leakAtExit() -> void { leakAtExit_ = true; }
+
+  // Under StorageConfig::arena the option is constructed in the arena and
+  // the returned pointer does not own it: use it to reach the option, but
+  // never reset() or release() it, since the application destroys the
+  // option with the arena.
   template <typename T>
     requires(concepts::HasFromStr<T>)
   auto addOption(const std::string& name, T* var)
       -> std::unique_ptr<OptionBase>& {
-    auto optPtr = Option<T>::createOption(name, var);
+    if (schemaMemory_ == nullptr) {
+      return addOption(Option<T>::createOption(name, var));
+    }
+    auto [shortName, longName] = OptionBase::makeNames(name);
+    void* storage = schemaMemory_->arena.allocate(sizeof(Option<T>),
+                                                  alignof(Option<T>));
+    auto* opt = Option<T>::constructAt(storage, std::move(shortName),
+                                       std::move(longName), var);
+    try {
+      return addUnowned(opt, true, sizeof(Option<T>));
+    } catch (...) {
+      std::destroy_at(opt);
+      throw;
+    }
+  }
+
+  // Registers a list option; see ListOption for the accepted values. A
+  // std::vector registered with REGISTER_TYPE goes through its own fromStr.
+  template <typename T>
+    requires(concepts::IsListElement<T> &&
+             !concepts::HasFromStr<std::vector<T>>)
+  auto addOption(const std::string& name, std::vector<T>* var)
+      -> std::unique_ptr<OptionBase>& {
+    return addOption(ListOption<T>::createOption(name, var));
+  }
+
+  // Registers an option taking the path of a numeric array file.
+  template <typename T>
+  auto addOption(const std::string& name, ArrayFile<T>* var)
+      -> std::unique_ptr<OptionBase>& {
+    return addOption(ArrayFileOption<T>::createOption(name, var));
+  }
+
+  // Registers a list option whose elements go to callback one at a time.
+  template <typename T>
+  auto addStreamOption(const std::string& name,
+                       typename StreamOption<T>::Callback callback)
+      -> std::unique_ptr<OptionBase>& {
+    return addOption(StreamOption<T>::createOption(name, callback));
+  }
+
+  // Registers an option built elsewhere, such as by a schema loader.
+  auto addOption(std::unique_ptr<OptionBase> optPtr)
+      -> std::unique_ptr<OptionBase>& {
     options_.push_back(std::move(optPtr));
+    indexDirty_ = true;
     return options_.at(options_.size() - 1);
   }
 
+  // Registers an option for every field StructFields<Config> describes and
+  // assigns the fields their defaults. Names were checked against the
+  // default rules when the descriptor compiled and are checked here against
+  // the NameValidationConfig in effect. The options live in one table owned
+  // by the application instead of one allocation each.
+  template <typename Config>
+    requires(HasStructFields<Config>)
+  auto bindStruct(Config& config) -> void {
+    auto binding = std::make_unique<StructBinding<Config>>(config);
+    structs_.reserve(structs_.size() + 1);
+    options_.reserve(options_.size() + binding->size());
+    unownedOptions_.reserve(unownedOptions_.size() + 1);
+    for (size_t idx = 0; idx < binding->size(); ++idx) {
+      addUnowned(&binding->option(idx), false);
+    }
+    structs_.push_back(std::move(binding));
+    indexDirty_ = true;
+  }
+
+  // Registers an option converted by a coroutine. Its conversion only runs
+  // under parseAsync; any other parse giving the option throws.
+  template <typename T>
+  auto addAsyncOption(const std::string& name, T* var,
+                      typename AsyncOption<T>::Converter converter)
+      -> std::unique_ptr<OptionBase>& {
+    auto optPtr = AsyncOption<T>::createOption(name, var, std::move(converter));
+    asyncOptions_.push_back(optPtr.get());
+    return addOption(std::move(optPtr));
+  }
+
+  // The command takes the application's match policy.
   auto addCommand(const std::string& name, bool* var)
       -> std::unique_ptr<Command>& {
     auto cmdPtr = Command::createCommand(name);
+    cmdPtr->setMatchPolicy(matchPolicy_);
+    return addCommand(std::move(cmdPtr), var);
+  }
+
+  auto addCommand(std::unique_ptr<Command> cmdPtr, bool* var)
+      -> std::unique_ptr<Command>& {
     commands_.emplace_back(std::move(cmdPtr), var);
+    indexDirty_ = true;
     return commands_.at(commands_.size() - 1).first;
   }
 
-  auto parse(int32_t argc, char** argv) -> void {
-    auto args = buildArray(argc, argv);
-    auto [optionMap, commandMap] = buildReconMaps();
-    std::map<size_t, bool> parsedOptions;
+  // How tokens are matched against option and command names. Also applies
+  // to the commands registered so far and to those added by name later.
+  // Under IgnoreCase, names that only differ in case make the next parse
+  // throw BuildException.
+  auto setMatchPolicy(MatchPolicy policy) -> void {
+    matchPolicy_ = policy;
+    for (auto& [cmdPtr, executed] : commands_) {
+      cmdPtr->setMatchPolicy(policy);
+    }
+    indexDirty_ = true;
+    ++policyEpoch_;
+  }
 
-    for (size_t idx = 0; idx < args.size(); ++idx) {
-      const auto& arg = args[idx];
+  [[nodiscard]] auto matchPolicy() const -> MatchPolicy {
+    return matchPolicy_;
+  }
 
-      if (commandMap.contains(arg)) {
-        processCommand(commandMap.at(arg), args, idx);
-        break;
+  // Expands ${name} references in the values of string options, from the
+  // command line or JSON. A name resolves to the value given in the same
+  // parse to the option with that name, with or without dashes, and
+  // otherwise to the environment variable. "$$" is a literal '$'. Options
+  // of commands are not interpolated.
+  auto setInterpolation(bool enabled) -> void { interpolation_ = enabled; }
+
+  [[nodiscard]] auto interpolation() const -> bool { return interpolation_; }
+
+  // Lets parse and parseAsync convert the values of large command lines on
+  // several threads; nullopt turns it off again. A sequential scan resolves
+  // every token and finds repeated options, then the conversions are split
+  // into contiguous runs converted concurrently. Errors are the same as in a
+  // sequential parse, the one of the earliest token, but options after it
+  // may have been converted already. Options bound to the same variable and
+  // converters sharing state without synchronization are not supported in
+  // this mode. Commands, interpolated values and converters taking a
+  // context are handled on the calling thread.
+  auto setParallelParse(std::optional<ParallelParseConfig> config) -> void {
+    parallel_ = config;
+  }
+
+  // Frees in one shot the arena handed to converters registered with
+  // REGISTER_CONTEXT_TYPE, along with the arenas of command options. The
+  // options converted with them are reset to their defaults first, so no
+  // bound variable is left referring to them, and the next reparse starts
+  // again from the defaults. parse and parseJson call it before converting,
+  // so the arena holds the values of one parse at most.
+  auto releaseConversionMemory() -> void {
+    for (auto& opt : options_) {
+      if (opt->takesContext()) {
+        opt->reset();
       }
+      opt->releaseMemory();
+    }
+    for (auto& [cmdPtr, executed] : commands_) {
+      cmdPtr->releaseConversionMemory();
+    }
+    conversionMemory_.reset();
+    ++memoryEpoch_;
+  }
 
-      if (optionMap.contains(arg)) {
-        processOption(args, optionMap, optionMap.at(arg), idx, parsedOptions,
-                      arg);
-      } else {
-        throw ParseException::unknownArg(arg);
+  // Memory held by the schema: options, names, lookup tables, commands,
+  // bookkeeping, the heap owned by bound variables and the schema arena
+  // with its blocks. Options placed in the arena count towards arena only.
+  // Process-wide configuration, created on first use, belongs to no
+  // application and is not counted.
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage {
+    MemoryUsage usage;
+    usage.options = MemoryUtils::vectorBytes(options_) +
+                    MemoryUtils::vectorBytes(structs_) +
+                    MemoryUtils::vectorBytes(unownedOptions_);
+    for (const auto& opt : options_) {
+      usage += opt->memoryUsage();
+      usage.names += opt->aliasBytes();
+    }
+    for (const auto& range : unownedOptions_) {
+      usage.options -= range.placedBytes;
+    }
+    if (schemaMemory_ != nullptr) {
+      usage.arena = sizeof(SchemaMemory) + schemaMemory_->blocks.bytes();
+    }
+    usage.commands += MemoryUtils::vectorBytes(commands_);
+    for (const auto& [cmdPtr, executed] : commands_) {
+      usage += cmdPtr->memoryUsage();
+    }
+    usage.lookupTables =
+        optionIndex_.memoryBytes() + commandIndex_.memoryBytes();
+    usage.scratch += MemoryUtils::vectorBytes(asyncOptions_) +
+                     MemoryUtils::vectorBytes(observers_) +
+                     interpolator_.scratchBytes();
+    return usage;
+  }
+
+  // Same as memoryUsage, also counting the buffers kept by a reparse state.
+  [[nodiscard]] auto memoryUsage(const ParseState& state) const
+      -> MemoryUsage {
+    auto usage = memoryUsage();
+    usage.scratch += MemoryUtils::heapBytes(state.args) +
+                     MemoryUtils::vectorBytes(state.tokens) +
+                     MemoryUtils::mapBytes(state.values);
+    return usage;
+  }
+
+  // Registers a callback fired after every successful parse that set the
+  // option. Callbacks run in one batch once parsing is done, higher
+  // priorities first and equal priorities in registration order.
+  auto addObserver(const std::string& name,
+                   FunctionRef<void(const OptionBase&)> callback,
+                   int32_t priority = 0) -> void {
+    buildIndex();
+    auto optIdx = optionIndex_.find(name);
+    if (!optIdx.has_value()) {
+      throw BuildException::unknownName(name);
+    }
+    auto pos = std::upper_bound(
+        observers_.begin(), observers_.end(), priority,
+        [](int32_t prio, const Observer& obs) { return prio > obs.priority; });
+    observers_.insert(pos, Observer{*optIdx, priority, callback});
+  }
+
+  // Makes alias, a name or "-s,--long" pair, resolve to the option
+  // registered as target. An alias is the option itself: giving the option
+  // and one of its aliases is a repeated argument.
+  auto addAlias(const std::string& target, const std::string& alias)
+      -> void {
+    optionNamed(target).addAlias(alias, {}, false);
+    indexDirty_ = true;
+  }
+
+  // Same as addAlias; the first use of the alias in the process is reported
+  // through Deprecations together with notice.
+  auto addDeprecatedAlias(const std::string& target, const std::string& alias,
+                          const std::string& notice = {}) -> void {
+    optionNamed(target).addAlias(alias, notice, true);
+    indexDirty_ = true;
+  }
+
+  // Registers the option selecting a preset, such as "--profile". Presets
+  // are declared with addPreset once the options they set are registered.
+  // An application has at most one preset option.
+  auto addPresetOption(const std::string& name)
+      -> std::unique_ptr<OptionBase>& {
+    if (presetIdx_.has_value()) {
+      throw BuildException::presetOptionTaken(name);
+    }
+    auto& opt = addOption(PresetOption::createOption(name));
+    presetIdx_ = options_.size() - 1;
+    return opt;
+  }
+
+  // Declares a preset as option names with values. Names are resolved and
+  // values converted here, so bad settings throw at registration and
+  // selecting the preset costs one store per setting. Options given
+  // explicitly keep their values, wherever they appear relative to the
+  // preset option.
+  auto addPreset(
+      const std::string& preset,
+      const std::vector<std::pair<std::string, std::string>>& settings)
+      -> void {
+    if (!presetIdx_.has_value()) {
+      throw BuildException::unknownName("preset option");
+    }
+    buildIndex();
+    PresetOption::Preset compiled{preset, {}};
+    compiled.settings.reserve(settings.size());
+    for (const auto& [name, value] : settings) {
+      auto optIdx = optionIndex_.find(name);
+      if (!optIdx.has_value() || *optIdx == *presetIdx_) {
+        throw BuildException::unknownName(name);
+      }
+      compiled.settings.push_back(
+          {*optIdx, value, options_.at(*optIdx)->convertPreset(value)});
+    }
+    presetOption().addPreset(std::move(compiled));
+  }
+
+  auto parse(int32_t argc, char** argv) -> void {
+    notifyObservers(parseArgs(buildArray(argc, argv)));
+  }
+
+  // Tokenizes argv and converts synchronous options right away, throwing on
+  // the first error. The returned task runs the conversions of async options
+  // concurrently on the executor and finishes once all of them did; observers
+  // fire at that point.
+  auto parseAsync(int32_t argc, char** argv, Executor& executor)
+      -> Task<void> {
+    auto accept = [this](bool accepting) {
+      for (auto* opt : asyncOptions_) {
+        opt->acceptValues(accepting);
       }
+    };
+    accept(true);
+    std::map<size_t, bool> parsedOptions;
+    try {
+      parsedOptions = parseArgs(buildArray(argc, argv));
+    } catch (...) {
+      accept(false);
+      throw;
+    }
+    accept(false);
+    std::vector<Task<void>> conversions;
+    for (auto* opt : asyncOptions_) {
+      if (opt->pending()) {
+        conversions.push_back(opt->convert());
+      }
+    }
+    return finishAsync(std::move(parsedOptions), std::move(conversions),
+                       executor);
+  }
+
+  // Binds the members of a top-level JSON object to the registered options.
+  // A key matches the option with that long name, or short name when there
+  // is no such long name; keys may also carry their dashes. Scalars are
+  // converted straight from the buffer, arrays bound to list options are
+  // decoded element by element, other arrays and objects are handed to the
+  // option as their raw JSON text, and null leaves an option as is.
+  auto parseJson(std::string_view json) -> void {
+    buildIndex();
+    beginConversions();
+    std::map<size_t, bool> parsedOptions;
+    std::string keyBuffer;
+    std::string valueBuffer;
+    auto bindMember = [&](std::string_view key, bool keyEscaped,
+                          const JsonValue& value) {
+      if (keyEscaped) {
+        JsonReader::unescape(key, keyBuffer);
+        key = keyBuffer;
+      }
+      const auto* entry = findKey(key);
+      if (entry == nullptr) {
+        throw ParseException::unknownArg(key);
+      }
+      if (value.kind == JsonValue::Kind::Literal && value.text == "null") {
+        return;
+      }
+      const size_t optIdx = resolveOption(*entry);
+      if (parsedOptions.contains(optIdx)) {
+        throw ParseException::multiArg(optionIndex_.namesOf(optIdx));
+      }
+      std::string_view text = value.text;
+      if (value.escaped) {
+        JsonReader::unescape(text, valueBuffer);
+        text = valueBuffer;
+        if (interpolation_) {
+          text = interpolator_.store(text);
+        }
+      }
+      if (!deferValue(optIdx, text)) {
+        if (value.kind == JsonValue::Kind::Array) {
+          convertArray(optIdx, text);
+        } else {
+          convertView(optIdx, text);
+        }
+      }
+      parsedOptions[optIdx] = true;
+    };
+    JsonReader::forEachMember(json, bindMember);
+    expandDeferred();
+    applyPreset(parsedOptions);
+    notifyObservers(parsedOptions);
+  }
+
+  // Same as parseJson for a document on disk, read through a mapping.
+  auto parseJsonFile(const std::string& path) -> void {
+    auto file = MappedFile::open(path);
+    parseJson(file.view());
+  }
+
+  // Parses argv reusing the outcome of the previous call stored in state.
+  // Tokens that did not change keep their resolved ids, options whose value
+  // token is the same are not converted again, and options that no longer
+  // appear are reset to their defaults. A command whose tokens changed is
+  // re-parsed as a whole. Observers fire only for options converted in this
+  // call. If parsing fails the state is invalidated, and the next call starts
+  // again from the defaults.
+  auto reparse(ParseState& state, int32_t argc, char** argv) -> void {
+    try {
+      reparseArgs(state, buildArray(argc, argv));
+    } catch (...) {
+      state = ParseState{};
+      throw;
     }
   }
 
  private:
+  friend class ChildCommand;
+  friend class Schema;
+
   static auto buildArray(int32_t argc, char** argv)
       -> std::vector<std::string> {
     std::vector<std::string> vec;
@@ -66,17 +499,184 @@ class Application {
     return vec;
   }
 
-  static auto buildDuplicateArgNames(
-      const std::map<std::string, size_t>& nameMap, size_t targetIdx)
-      -> std::string {
-    std::string argNames;
-    for (const auto& [name, index] : nameMap) {
-      if (index == targetIdx) {
-        argNames += name;
-        argNames += ", ";
+  auto parseArgs(const std::vector<std::string>& args)
+      -> std::map<size_t, bool> {
+    buildIndex();
+    beginConversions();
+    if (parallel_.has_value() && args.size() >= parallel_->threshold) {
+      return parseParallel(args);
+    }
+    std::map<size_t, bool> parsedOptions;
+
+    for (size_t idx = 0; idx < args.size(); ++idx) {
+      const auto& arg = args[idx];
+
+      if (auto cmdIdx = commandIndex_.find(arg)) {
+        processCommand(*cmdIdx, args, idx);
+        break;
+      }
+
+      if (const auto* entry = optionIndex_.lookup(arg)) {
+        processOption(args, resolveOption(*entry), idx, parsedOptions, arg);
+      } else if (auto attached = lookupAttached(arg)) {
+        processOption(args, attached->id, idx, parsedOptions, arg,
+                      attached->value);
+      } else {
+        throw ParseException::unknownArg(arg);
+      }
+    }
+    expandDeferred();
+    applyPreset(parsedOptions);
+    return parsedOptions;
+  }
+
+  // A value to convert on a worker thread, found at token pos.
+  struct Conversion {
+    size_t optIdx;
+    size_t pos;
+    std::string_view text;
+    // The whole token holding the value, so it needs no copy for parseValue.
+    const std::string* token;
+  };
+
+  struct ConversionError {
+    size_t pos;
+    std::exception_ptr error;
+  };
+
+  auto parseParallel(const std::vector<std::string>& args)
+      -> std::map<size_t, bool> {
+    std::vector<char> seen(options_.size(), 0);
+    std::vector<Conversion> conversions;
+    conversions.reserve(args.size() / 2);
+    std::optional<ConversionError> firstError;
+    std::optional<size_t> command;
+
+    size_t idx = 0;
+    try {
+      for (; idx < args.size(); ++idx) {
+        const auto& arg = args[idx];
+        if (auto cmdIdx = commandIndex_.find(arg)) {
+          command = *cmdIdx;
+          break;
+        }
+        size_t optIdx = 0;
+        std::optional<std::string_view> value;
+        if (const auto* entry = optionIndex_.lookup(arg)) {
+          optIdx = resolveOption(*entry);
+        } else if (auto attached = lookupAttached(arg)) {
+          optIdx = attached->id;
+          value = attached->value;
+        } else {
+          throw ParseException::unknownArg(arg);
+        }
+        if (seen[optIdx] != 0) {
+          throw ParseException::multiArg(optionIndex_.namesOf(optIdx));
+        }
+        seen[optIdx] = 1;
+
+        auto& opt = *options_[optIdx];
+        Conversion conversion{optIdx, idx, value.value_or(""), nullptr};
+        if (!value.has_value()) {
+          if (!opt.needsValue()) {
+            conversion.text = "true";
+          } else if (idx + 1 >= args.size()) {
+            throw ParseException::insufficientValues(arg);
+          } else {
+            conversion.token = &args[++idx];
+            conversion.text = *conversion.token;
+          }
+        }
+        if (deferValue(optIdx, conversion.text)) {
+          continue;
+        }
+        if (opt.takesContext()) {
+          convertView(optIdx, conversion.text);
+        } else {
+          conversions.push_back(conversion);
+        }
+      }
+    } catch (...) {
+      firstError = ConversionError{idx, std::current_exception()};
+    }
+
+    convertParallel(conversions, firstError);
+    if (firstError.has_value()) {
+      std::rethrow_exception(firstError->error);
+    }
+    if (command.has_value()) {
+      processCommand(*command, args, idx);
+    }
+    expandDeferred();
+
+    std::map<size_t, bool> parsedOptions;
+    for (size_t optIdx = 0; optIdx < seen.size(); ++optIdx) {
+      if (seen[optIdx] != 0) {
+        parsedOptions.emplace_hint(parsedOptions.end(), optIdx, true);
+      }
+    }
+    applyPreset(parsedOptions);
+    return parsedOptions;
+  }
+
+  // Converts contiguous runs of the values on separate threads. Keeps in
+  // firstError the error of the earliest token, whether it came from the
+  // scan or from a conversion.
+  auto convertParallel(const std::vector<Conversion>& conversions,
+                       std::optional<ConversionError>& firstError)
+      -> void {
+    const size_t threads = ParallelUtils::threadCount(
+        conversions.size(), parallel_->minChunkValues, parallel_->maxThreads);
+    std::vector<std::optional<ConversionError>> errors(threads);
+    ParallelUtils::run(threads, [&](size_t chunk) {
+      const size_t end = conversions.size() * (chunk + 1) / threads;
+      for (size_t pos = conversions.size() * chunk / threads; pos < end;
+           ++pos) {
+        const auto& conversion = conversions[pos];
+        auto& opt = *options_[conversion.optIdx];
+        try {
+          // Attached values go through parseValue as well, so they convert
+          // the same way as separate ones.
+          if (conversion.token != nullptr) {
+            opt.parseValue(*conversion.token);
+          } else {
+            opt.parseValue(std::string(conversion.text));
+          }
+        } catch (...) {
+          errors[chunk] = ConversionError{conversion.pos,
+                                          std::current_exception()};
+          return;
+        }
+      }
+    });
+    for (auto& error : errors) {
+      if (error.has_value() &&
+          (!firstError.has_value() || error->pos < firstError->pos)) {
+        firstError = std::move(error);
+      }
+    }
+  }
+
+  auto finishAsync(std::map<size_t, bool> parsedOptions,
+                   std::vector<Task<void>> conversions, Executor& executor)
+      -> Task<void> {
+    co_await whenAll(executor, std::move(conversions));
+    notifyObservers(parsedOptions);
+  }
+
+  struct Observer {
+    size_t optIdx;
+    int32_t priority;
+    FunctionRef<void(const OptionBase&)> callback;
+  };
+
+  auto notifyObservers(const std::map<size_t, bool>& setOptions) const
+      -> void {
+    for (const auto& obs : observers_) {
+      if (setOptions.contains(obs.optIdx)) {
+        obs.callback(*options_.at(obs.optIdx));
       }
     }
-    return argNames;
   }
 
   auto processCommand(size_t cmdIdx, const std::vector<std::string>& args,
@@ -88,55 +688,546 @@ class Application {
     *executed = true;
   }
 
-  auto processOption(const std::vector<std::string>& args,
-                     const std::map<std::string, size_t>& optionMap,
-                     size_t optIdx, size_t& idx,
-                     std::map<size_t, bool>& parsedOptions,
-                     const std::string& arg) -> void {
+  auto processOption(const std::vector<std::string>& args, size_t optIdx,
+                     size_t& idx, std::map<size_t, bool>& parsedOptions,
+                     const std::string& arg,
+                     std::optional<std::string_view> attached = {}) -> void {
     if (parsedOptions.contains(optIdx)) {
-      throw ParseException::multiArg(buildDuplicateArgNames(optionMap, optIdx));
+      throw ParseException::multiArg(optionIndex_.namesOf(optIdx));
     }
 
-    auto& opt = options_.at(optIdx);
-    if (opt->needsValue()) {
+    if (attached.has_value()) {
+      // Converted like a separate value, so "--opt=v" and "--opt v" agree.
+      if (!deferValue(optIdx, *attached)) {
+        convertValue(optIdx, std::string(*attached));
+      }
+    } else if (options_.at(optIdx)->needsValue()) {
       if (idx + 1 >= args.size()) {
         throw ParseException::insufficientValues(arg);
       }
-      opt->parseValue(args.at(idx + 1));
-      idx++;
-    } else {
-      opt->parseValue("true");
+      const auto& value = args.at(++idx);
+      if (!deferValue(optIdx, value)) {
+        convertValue(optIdx, value);
+      }
+    } else if (!deferValue(optIdx, "true")) {
+      convertValue(optIdx, "true");
     }
     parsedOptions[optIdx] = true;
   }
 
-  auto buildReconMaps() -> std::pair<std::map<std::string, size_t>,
-                                     std::map<std::string, size_t>> {
-    std::map<std::string, size_t> optionMap;
-    std::map<std::string, size_t> commandMap;
+  auto buildIndex() -> void {
+    if (!indexDirty_) {
+      return;
+    }
+    optionIndex_.clear();
+    commandIndex_.clear();
+    optionIndex_.setPolicy(matchPolicy_);
+    commandIndex_.setPolicy(matchPolicy_);
     for (size_t idx = 0; idx < options_.size(); ++idx) {
       const auto& opt = options_[idx];
-      auto sName = opt->shortName();
-      auto lName = opt->longName();
-      if (!sName.empty()) {
-        optionMap[sName] = idx;
+      if (!opt->shortName().empty()) {
+        optionIndex_.insert(opt->shortName(), idx);
+      }
+      if (!opt->longName().empty()) {
+        optionIndex_.insert(opt->longName(), idx);
       }
-      if (!lName.empty()) {
-        optionMap[lName] = idx;
+      const auto& aliases = opt->aliases();
+      for (size_t alias = 0; alias < aliases.size(); ++alias) {
+        optionIndex_.insert(aliases[alias].name, idx,
+                            static_cast<uint32_t>(alias + 1));
       }
     }
     for (size_t idx = 0; idx < commands_.size(); ++idx) {
-      const auto& cmd = commands_[idx].first;
-      commandMap[cmd->name()] = idx;
+      commandIndex_.insert(commands_[idx].first->name(), idx);
+    }
+    optionIndex_.sort();
+    commandIndex_.sort();
+    indexDirty_ = false;
+  }
+
+  // Option named by a JSON key or an interpolation reference.
+  [[nodiscard]] auto findKey(std::string_view key) const
+      -> const NameIndex::Entry* {
+    if (key.starts_with('-')) {
+      return optionIndex_.lookup(key);
+    }
+    if (const auto* entry = optionIndex_.lookup("--", key)) {
+      return entry;
+    }
+    return optionIndex_.lookup("-", key);
+  }
+
+  auto lookupToken(const std::string& arg) const -> ParseState::Token {
+    if (auto cmdIdx = commandIndex_.find(arg)) {
+      return {ParseState::Kind::Command, *cmdIdx};
+    }
+    if (const auto* entry = optionIndex_.lookup(arg)) {
+      return {ParseState::Kind::Option, resolveOption(*entry)};
+    }
+    if (auto attached = lookupAttached(arg)) {
+      return {ParseState::Kind::Option, attached->id, true};
+    }
+    throw ParseException::unknownArg(arg);
+  }
+
+  struct Attached {
+    size_t id;
+    std::string_view value;
+  };
+
+  // "--name=value" for options that take a value. Only tried once the
+  // whole token missed, so it costs nothing on the common path.
+  [[nodiscard]] auto lookupAttached(std::string_view arg) const
+      -> std::optional<Attached> {
+    auto [entry, value] = optionIndex_.lookupAttached(arg);
+    if (entry == nullptr || !options_.at(entry->id)->needsValue()) {
+      return std::nullopt;
+    }
+    return Attached{resolveOption(*entry), value};
+  }
+
+  auto beginInterpolation() -> void {
+    if (interpolation_) {
+      interpolator_.begin(options_.size());
+    }
+  }
+
+  // Start of a full parse: values of the previous one converted into an
+  // arena are dropped with it.
+  auto beginConversions() -> void {
+    if (conversionMemory_ != nullptr) {
+      releaseConversionMemory();
+    }
+    beginInterpolation();
+  }
+
+  // Records the raw value of an option for references to it. Returns true
+  // when the value holds references, and converting it has to wait for
+  // expandDeferred.
+  auto deferValue(size_t optIdx, std::string_view raw) -> bool {
+    return interpolation_ &&
+           interpolator_.record(optIdx, raw, options_[optIdx]->interpolates());
+  }
+
+  // Expands the deferred values once every value of the parse is known.
+  // Returns the options with their expanded text.
+  auto expandValues() -> std::vector<std::pair<size_t, std::string_view>> {
+    std::vector<std::pair<size_t, std::string_view>> expanded;
+    if (!interpolation_) {
+      return expanded;
+    }
+    auto resolve = [this](std::string_view name) -> std::optional<size_t> {
+      const auto* entry = findKey(name);
+      if (entry == nullptr) {
+        return std::nullopt;
+      }
+      return resolveOption(*entry);
+    };
+    expanded.reserve(interpolator_.pending().size());
+    for (const size_t optIdx : interpolator_.pending()) {
+      expanded.emplace_back(optIdx, interpolator_.expand(optIdx, resolve));
+    }
+    return expanded;
+  }
+
+  auto expandDeferred() -> void {
+    for (const auto& [optIdx, text] : expandValues()) {
+      convertView(optIdx, text);
+    }
+  }
+
+  // Converts the value of an option. Converters taking a context get the
+  // arena of the application.
+  auto convertValue(size_t optIdx, const std::string& text) -> void {
+    auto& opt = *options_.at(optIdx);
+    if (opt.takesContext()) {
+      convertWith(opt, optIdx, text);
+    } else {
+      opt.parseValue(text);
+    }
+  }
+
+  auto convertView(size_t optIdx, std::string_view text) -> void {
+    auto& opt = *options_.at(optIdx);
+    if (opt.takesContext()) {
+      convertWith(opt, optIdx, text);
+    } else {
+      opt.parseView(text);
+    }
+  }
+
+  auto convertArray(size_t optIdx, std::string_view json) -> void {
+    auto& opt = *options_.at(optIdx);
+    if (opt.takesContext()) {
+      convertWith(opt, optIdx, json);
+    } else {
+      opt.parseJsonArray(json);
+    }
+  }
+
+  auto convertWith(OptionBase& opt, size_t optIdx, std::string_view text)
+      -> void {
+    if (conversionMemory_ == nullptr) {
+      conversionMemory_ =
+          std::make_unique<std::pmr::monotonic_buffer_resource>();
+    }
+    ConvertContext context(conversionMemory_.get(), optIdx);
+    opt.parseWith(text, context);
+  }
+
+  auto presetOption() -> PresetOption& {
+    return static_cast<PresetOption&>(*options_.at(*presetIdx_));
+  }
+
+  // Applies the preset selected in this parse to the options it did not
+  // set explicitly, and marks them as set for the observers.
+  auto applyPreset(std::map<size_t, bool>& parsedOptions) -> void {
+    if (!presetIdx_.has_value() || !parsedOptions.contains(*presetIdx_)) {
+      return;
+    }
+    const auto* preset = presetOption().selected();
+    if (preset == nullptr) {
+      return;
+    }
+    for (const auto& setting : preset->settings) {
+      if (!parsedOptions.contains(setting.optIdx)) {
+        setting.value->apply();
+      }
+    }
+    for (const auto& setting : preset->settings) {
+      parsedOptions.emplace(setting.optIdx, true);
+    }
+  }
+
+  auto optionNamed(const std::string& name) -> OptionBase& {
+    buildIndex();
+    auto optIdx = optionIndex_.find(name);
+    if (!optIdx.has_value()) {
+      throw BuildException::unknownName(name);
     }
-    return {optionMap, commandMap};
+    return *options_.at(*optIdx);
   }
 
+  // Option id of a matched entry, reporting deprecated aliases.
+  [[nodiscard]] auto resolveOption(const NameIndex::Entry& entry) const
+      -> size_t {
+    if (entry.alias != 0) {
+      const auto& aliases = options_.at(entry.id)->aliases();
+      if (entry.alias <= aliases.size()) {
+        const auto& alias = aliases[entry.alias - 1];
+        if (alias.deprecated) {
+          Deprecations::report(alias.name, alias.notice);
+        }
+      }
+    }
+    return entry.id;
+  }
+
+  auto resetCommand(size_t cmdIdx) -> void {
+    auto& [cmdPtr, executed] = commands_.at(cmdIdx);
+    cmdPtr->resetOptions();
+    *executed = false;
+  }
+
+  auto resetAll() -> void {
+    for (auto& opt : options_) {
+      opt->reset();
+    }
+    for (size_t idx = 0; idx < commands_.size(); ++idx) {
+      resetCommand(idx);
+    }
+  }
+
+  auto reparseArgs(ParseState& state, std::vector<std::string> args) -> void {
+    if (!state.valid || state.memoryEpoch != memoryEpoch_ ||
+        state.policyEpoch != policyEpoch_) {
+      resetAll();
+      state = ParseState{};
+    }
+    buildIndex();
+    beginInterpolation();
+
+    // Tokens in the common prefix and suffix of both argv keep the lookup
+    // result recorded for them in the previous parse.
+    const auto& oldArgs = state.args;
+    size_t prefix = 0;
+    while (prefix < oldArgs.size() && prefix < args.size() &&
+           oldArgs[prefix] == args[prefix]) {
+      ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < oldArgs.size() - prefix && suffix < args.size() - prefix &&
+           oldArgs[oldArgs.size() - 1 - suffix] ==
+               args[args.size() - 1 - suffix]) {
+      ++suffix;
+    }
+
+    std::vector<ParseState::Token> tokens(args.size());
+    std::map<size_t, std::string> values;
+    std::map<size_t, bool> parsedOptions;
+    std::map<size_t, bool> convertedOptions;
+    std::optional<size_t> command;
+    size_t commandPos = 0;
+
+    for (size_t idx = 0; idx < args.size(); ++idx) {
+      const auto& arg = args[idx];
+      std::optional<size_t> oldIdx;
+      if (idx < prefix) {
+        oldIdx = idx;
+      } else if (args.size() - idx <= suffix) {
+        oldIdx = idx + oldArgs.size() - args.size();
+      }
+      auto token = oldIdx.has_value() &&
+                           state.tokens[*oldIdx].kind != ParseState::Kind::Value
+                       ? state.tokens[*oldIdx]
+                       : lookupToken(arg);
+      tokens[idx] = token;
+
+      if (token.kind == ParseState::Kind::Command) {
+        const bool unchanged =
+            state.command == token.id &&
+            std::equal(oldArgs.begin() +
+                           static_cast<std::ptrdiff_t>(state.commandPos + 1),
+                       oldArgs.end(),
+                       args.begin() + static_cast<std::ptrdiff_t>(idx + 1),
+                       args.end());
+        if (!unchanged) {
+          if (state.command.has_value()) {
+            resetCommand(*state.command);
+          }
+          resetCommand(token.id);
+          processCommand(token.id, args, idx);
+        }
+        command = token.id;
+        commandPos = idx;
+        break;
+      }
+
+      if (parsedOptions.contains(token.id)) {
+        throw ParseException::multiArg(optionIndex_.namesOf(token.id));
+      }
+      auto& opt = options_.at(token.id);
+      std::string value = "true";
+      if (token.attached) {
+        value = arg.substr(arg.find('=') + 1);
+      } else if (opt->needsValue()) {
+        if (idx + 1 >= args.size()) {
+          throw ParseException::insufficientValues(arg);
+        }
+        value = args[++idx];
+      }
+      parsedOptions[token.id] = true;
+      // Nodes of the map do not move, so the stored text can be recorded.
+      const auto& stored = values[token.id] = std::move(value);
+      if (deferValue(token.id, stored)) {
+        continue;
+      }
+      auto previous = state.values.find(token.id);
+      if (previous == state.values.end() || previous->second != stored) {
+        convertValue(token.id, stored);
+        convertedOptions[token.id] = true;
+      }
+    }
+
+    // Interpolated values are expanded again on every call, since the
+    // options or variables they refer to may have changed, and compared by
+    // their expanded text.
+    for (const auto& [optIdx, text] : expandValues()) {
+      auto previous = state.values.find(optIdx);
+      if (previous == state.values.end() || previous->second != text) {
+        convertView(optIdx, text);
+        convertedOptions[optIdx] = true;
+      }
+      // Every reference was expanded already, the raw text is not needed.
+      values[optIdx] = std::string(text);
+    }
+
+    // Preset settings are recorded with their text like explicit values, so
+    // they are only stored again when the text changed and are reset once
+    // no longer selected.
+    if (presetIdx_.has_value() && values.contains(*presetIdx_)) {
+      if (const auto* preset = presetOption().selected()) {
+        for (const auto& setting : preset->settings) {
+          if (parsedOptions.contains(setting.optIdx)) {
+            continue;
+          }
+          auto previous = state.values.find(setting.optIdx);
+          if (previous == state.values.end() ||
+              previous->second != setting.text) {
+            setting.value->apply();
+            convertedOptions[setting.optIdx] = true;
+          }
+          values[setting.optIdx] = setting.text;
+        }
+      }
+    }
+
+    for (const auto& [optIdx, value] : state.values) {
+      if (!values.contains(optIdx)) {
+        options_.at(optIdx)->reset();
+      }
+    }
+    if (state.command.has_value() && state.command != command) {
+      resetCommand(*state.command);
+    }
+
+    state.args = std::move(args);
+    state.tokens = std::move(tokens);
+    state.values = std::move(values);
+    state.command = command;
+    state.commandPos = commandPos;
+    state.memoryEpoch = memoryEpoch_;
+    state.policyEpoch = policyEpoch_;
+    state.valid = true;
+    notifyObservers(convertedOptions);
+  }
+
+  static constexpr size_t schemaBlockSize = size_t{64} << 10U;
+
+  // Registers an option whose storage someone else releases, placedBytes
+  // of it in schemaMemory_. Consecutive ones share a range, so arena
+  // registrations do not grow the ranges.
+  auto addUnowned(OptionBase* opt, bool inPlace, size_t placedBytes = 0)
+      -> std::unique_ptr<OptionBase>& {
+    const size_t idx = options_.size();
+    if (unownedOptions_.empty() || unownedOptions_.back().end != idx ||
+        unownedOptions_.back().inPlace != inPlace) {
+      unownedOptions_.push_back({idx, idx, inPlace, 0});
+    }
+    try {
+      options_.emplace_back(opt);
+    } catch (...) {
+      if (unownedOptions_.back().begin == idx) {
+        unownedOptions_.pop_back();
+      }
+      throw;
+    }
+    ++unownedOptions_.back().end;
+    unownedOptions_.back().placedBytes += placedBytes;
+    indexDirty_ = true;
+    return options_.back();
+  }
+
+  // Last registered first, as their owners would destroy them.
+  auto releaseUnowned() noexcept -> void {
+    for (auto range = unownedOptions_.rbegin();
+         range != unownedOptions_.rend(); ++range) {
+      for (size_t idx = range->end; idx-- > range->begin;) {
+        auto* opt = options_[idx].release();
+        if (range->inPlace) {
+          std::destroy_at(opt);
+        }
+      }
+    }
+    unownedOptions_.clear();
+  }
+
+  // Arena the options are placed in, taking its blocks through a counting
+  // resource so memoryUsage can report them.
+  struct SchemaMemory {
+    explicit SchemaMemory(size_t blockSize) : arena(blockSize, &blocks) {}
+
+    CountingResource blocks;
+    std::pmr::monotonic_buffer_resource arena;
+  };
+
+  // Declared first so it outlives the other members; releaseUnowned
+  // destroys the options constructed in it.
+  std::unique_ptr<SchemaMemory> schemaMemory_;
+  bool leakAtExit_{false};
+  std::vector<std::unique_ptr<BoundStruct>> structs_;
   std::vector<std::unique_ptr<OptionBase>> options_;
+  // Runs of options_ whose entries do not own their option: those
+  // constructed in schemaMemory_ and those in the table of a bound struct.
+  // Released before options_ is destroyed, and the former destroyed then.
+  struct UnownedRange {
+    size_t begin;
+    size_t end;
+    bool inPlace;
+    // Bytes of the range's options in schemaMemory_.
+    size_t placedBytes;
+  };
+  std::vector<UnownedRange> unownedOptions_;
   std::vector<std::pair<std::unique_ptr<Command>, bool*>> commands_;
+  std::vector<AsyncOptionBase*> asyncOptions_;
+  std::vector<Observer> observers_;
+  NameIndex optionIndex_;
+  NameIndex commandIndex_;
+  bool indexDirty_{true};
+  MatchPolicy matchPolicy_{MatchPolicy::Exact};
+  std::optional<size_t> presetIdx_;
+  bool interpolation_{false};
+  Interpolator interpolator_;
+  // Created on the first conversion that needs it.
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> conversionMemory_;
+  uint64_t memoryEpoch_{0};
+  uint64_t policyEpoch_{0};
+  std::optional<ParallelParseConfig> parallel_;
   Application() = default;
 };
 
+// Applications destroyed after Application::leakAtExit, taken over by their
+// destructor and never freed. The list keeps them reachable, so leak
+// checkers do not report them.
+struct LeakedApplication {
+  Application app;
+  LeakedApplication* next{nullptr};
+
+  static inline std::atomic<LeakedApplication*> head{nullptr};
+};
+
+// Moving out takes a handful of pointers whatever the size of the schema,
+// and leaves members whose destruction has nothing left to free. A
+// moved-from application has no options and is destroyed as usual.
+inline Application::~Application() {
+  if (!leakAtExit_ || options_.empty()) {
+    releaseUnowned();
+    return;
+  }
+  try {
+    auto* node = new LeakedApplication{std::move(*this)};
+    node->next = LeakedApplication::head.load(std::memory_order_relaxed);
+    while (!LeakedApplication::head.compare_exchange_weak(
+        node->next, node, std::memory_order_release,
+        std::memory_order_relaxed)) {
+    }
+  } catch (const std::bad_alloc&) {
+    // Destroyed as usual.
+    releaseUnowned();
+  }
+}
+
+// The options are released first, while the arena and the struct tables
+// some of them live in are still there; a defaulted assignment would free
+// the arena before destroying them.
+inline auto Application::operator=(Application&& other) noexcept
+    -> Application& {
+  if (this == &other) {
+    return *this;
+  }
+  releaseUnowned();
+  options_ = std::move(other.options_);
+  unownedOptions_ = std::move(other.unownedOptions_);
+  structs_ = std::move(other.structs_);
+  schemaMemory_ = std::move(other.schemaMemory_);
+  leakAtExit_ = other.leakAtExit_;
+  commands_ = std::move(other.commands_);
+  asyncOptions_ = std::move(other.asyncOptions_);
+  observers_ = std::move(other.observers_);
+  optionIndex_ = std::move(other.optionIndex_);
+  commandIndex_ = std::move(other.commandIndex_);
+  indexDirty_ = other.indexDirty_;
+  matchPolicy_ = other.matchPolicy_;
+  presetIdx_ = other.presetIdx_;
+  interpolation_ = other.interpolation_;
+  interpolator_ = std::move(other.interpolator_);
+  conversionMemory_ = std::move(other.conversionMemory_);
+  memoryEpoch_ = other.memoryEpoch_;
+  policyEpoch_ = other.policyEpoch_;
+  parallel_ = other.parallel_;
+  return *this;
+}
+
 }  // namespace doptions
 
 #endif  // !DOPTIONS_APPLICATION_HPP
@@ -0,0 +1,81 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+#ifndef DOPTIONS_ARENA_HPP
+#define DOPTIONS_ARENA_HPP
+
+namespace doptions {
+
+// Bump allocator for text that lives until the next reset. Memory comes in
+// chunks that are never moved, so views handed out stay valid until then.
+// reset() merges the chunks into one as large as all of them, so an arena
+// reused across parses stops allocating once it grew to what one parse
+// needs.
+class Arena {
+ public:
+  static constexpr size_t defaultChunkSize = 4096;
+
+  explicit Arena(size_t chunkSize = defaultChunkSize)
+      : chunkSize_(std::max<size_t>(chunkSize, 1)) {}
+
+  [[nodiscard]] auto allocate(size_t size) -> char* {
+    if (chunks_.empty() || chunks_.back().size - used_ < size) {
+      addChunk(size);
+    }
+    char* data = chunks_.back().data.get() + used_;
+    used_ += size;
+    return data;
+  }
+
+  // Copies text into the arena.
+  [[nodiscard]] auto store(std::string_view text) -> std::string_view {
+    if (text.empty()) {
+      return {};
+    }
+    char* data = allocate(text.size());
+    std::memcpy(data, text.data(), text.size());
+    return {data, text.size()};
+  }
+
+  auto reset() -> void {
+    if (chunks_.size() > 1) {
+      const size_t size = capacity();
+      chunks_.clear();
+      addChunk(size);
+    }
+    used_ = 0;
+  }
+
+  // Bytes held in chunks, used or not.
+  [[nodiscard]] auto capacity() const -> size_t {
+    size_t bytes = 0;
+    for (const auto& chunk : chunks_) {
+      bytes += chunk.size;
+    }
+    return bytes;
+  }
+
+ private:
+  struct Chunk {
+    std::unique_ptr<char[]> data;  // NOLINT
+    size_t size;
+  };
+
+  auto addChunk(size_t minimum) -> void {
+    const size_t size = std::max(chunkSize_, minimum);
+    chunks_.push_back({std::make_unique<char[]>(size), size});  // NOLINT
+    used_ = 0;
+  }
+
+  size_t chunkSize_;
+  size_t used_{0};
+  std::vector<Chunk> chunks_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_ARENA_HPP
@@ -0,0 +1,257 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "doptions/exceptions.hpp"
+#include "doptions/mapped_file.hpp"
+#include "doptions/memory.hpp"
+#include "doptions/option.hpp"
+#include "doptions/utils.hpp"
+#ifndef DOPTIONS_ARRAY_FILE_HPP
+#define DOPTIONS_ARRAY_FILE_HPP
+
+namespace doptions {
+
+enum class ArrayFormat : uint8_t {
+  // Text for .csv, .tsv and .txt files, binary otherwise.
+  Auto,
+  // Raw little-endian elements.
+  Binary,
+  // Numbers separated by commas or whitespace.
+  Text,
+};
+
+// Numeric array read from a file the first time it is accessed. Binary
+// files are mapped and viewed in place; text files are parsed into a
+// cache-line aligned buffer. Loading is not synchronized, so the first
+// access must not race with another.
+template <typename T>
+  requires(concepts::IsArithmetic<T> && !std::is_same_v<T, bool>)
+class ArrayFile {
+ public:
+  static constexpr size_t bufferAlignment = 64;
+
+  ArrayFile() = default;
+
+  explicit ArrayFile(std::string path, ArrayFormat format = ArrayFormat::Auto)
+      : path_(std::move(path)), format_(format) {}
+
+  // Points the array at another file, dropping what was loaded.
+  auto assign(std::string path, ArrayFormat format = ArrayFormat::Auto)
+      -> void {
+    path_ = std::move(path);
+    format_ = format;
+    file_ = MappedFile();
+    buffer_.reset();
+    elements_ = {};
+    loaded_ = false;
+  }
+
+  [[nodiscard]] auto path() const -> const std::string& { return path_; }
+
+  [[nodiscard]] auto format() const -> ArrayFormat { return format_; }
+
+  [[nodiscard]] auto loaded() const -> bool { return loaded_; }
+
+  // Reads the file if that did not happen yet. An array without a path is
+  // empty.
+  auto load() const -> void {
+    if (loaded_) {
+      return;
+    }
+    if (!path_.empty()) {
+      if (isText()) {
+        loadText();
+      } else {
+        loadBinary();
+      }
+    }
+    loaded_ = true;
+  }
+
+  [[nodiscard]] auto span() const -> std::span<const T> {
+    load();
+    return elements_;
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return span().size(); }
+
+  [[nodiscard]] auto begin() const { return span().begin(); }
+
+  [[nodiscard]] auto end() const { return span().end(); }
+
+  auto operator[](size_t idx) const -> const T& { return span()[idx]; }
+
+  // Heap bytes held by a parsed text file; mapped files are not counted.
+  [[nodiscard]] auto heapBytes() const -> size_t {
+    return buffer_ ? bufferBytes(elements_.size()) : 0;
+  }
+
+ private:
+  struct AlignedDelete {
+    auto operator()(T* ptr) const -> void {
+      ::operator delete(ptr, std::align_val_t{bufferAlignment});
+    }
+  };
+
+  static auto bufferBytes(size_t count) -> size_t {
+    const size_t bytes = std::max<size_t>(count * sizeof(T), 1);
+    return (bytes + bufferAlignment - 1) / bufferAlignment * bufferAlignment;
+  }
+
+  static auto allocate(size_t count) -> std::unique_ptr<T[], AlignedDelete> {
+    return std::unique_ptr<T[], AlignedDelete>(static_cast<T*>(
+        ::operator new(bufferBytes(count), std::align_val_t{bufferAlignment})));
+  }
+
+  static auto isSeparator(char chr) -> bool {
+    return chr == ',' || chr == ' ' || chr == '\t' || chr == '\n' ||
+           chr == '\r';
+  }
+
+  [[nodiscard]] auto isText() const -> bool {
+    if (format_ != ArrayFormat::Auto) {
+      return format_ == ArrayFormat::Text;
+    }
+    return path_.ends_with(".csv") || path_.ends_with(".tsv") ||
+           path_.ends_with(".txt");
+  }
+
+  auto loadBinary() const -> void {
+    auto file = MappedFile::open(path_);
+    if (file.size() % sizeof(T) != 0) {
+      throw ParseException::invalidValue(path_);
+    }
+    const size_t count = file.size() / sizeof(T);
+    if constexpr (std::endian::native == std::endian::little) {
+      // Mappings are page aligned, so the elements can be used in place.
+      elements_ = {reinterpret_cast<const T*>(file.data()), count};  // NOLINT
+      file_ = std::move(file);
+    } else {
+      buffer_ = allocate(count);
+      for (size_t idx = 0; idx < count; ++idx) {
+        std::array<char, sizeof(T)> bytes{};
+        std::memcpy(bytes.data(), file.data() + idx * sizeof(T), sizeof(T));
+        std::reverse(bytes.begin(), bytes.end());
+        std::memcpy(buffer_.get() + idx, bytes.data(), sizeof(T));
+      }
+      elements_ = {buffer_.get(), count};
+    }
+  }
+
+  auto loadText() const -> void {
+    auto file = MappedFile::open(path_);
+    const std::string_view text = file.view();
+    size_t count = 0;
+    bool inNumber = false;
+    for (const char chr : text) {
+      const bool separator = isSeparator(chr);
+      count += !separator && !inNumber ? 1 : 0;
+      inNumber = !separator;
+    }
+    buffer_ = allocate(count);
+    size_t idx = 0;
+    size_t pos = 0;
+    while (idx < count) {
+      while (isSeparator(text[pos])) {
+        ++pos;
+      }
+      size_t end = pos;
+      while (end < text.size() && !isSeparator(text[end])) {
+        ++end;
+      }
+      auto element = text.substr(pos, end - pos);
+      try {
+        buffer_[idx] = fromChars<T>(element);
+      } catch (const std::exception&) {
+        buffer_.reset();
+        throw ParseException::invalidElement(element, idx);
+      }
+      ++idx;
+      pos = end;
+    }
+    elements_ = {buffer_.get(), count};
+  }
+
+  std::string path_;
+  ArrayFormat format_{ArrayFormat::Auto};
+  mutable MappedFile file_;
+  mutable std::unique_ptr<T[], AlignedDelete> buffer_;
+  mutable std::span<const T> elements_;
+  mutable bool loaded_{false};
+};
+
+// Option whose value is the path of an ArrayFile. Parsing only records the
+// path, keeping the format set on the array; the file is read on first
+// access to the array.
+template <typename T>
+class ArrayFileOption : public OptionBase {
+ public:
+  static auto createOption(const std::string& name, ArrayFile<T>* var)
+      -> std::unique_ptr<ArrayFileOption> {
+    auto [shortName, longName] = makeNames(name);
+    std::unique_ptr<ArrayFileOption> opt(new ArrayFileOption());
+    opt->shortName_ = std::move(shortName);
+    opt->longName_ = std::move(longName);
+    opt->value_ = var;
+    if (var != nullptr) {
+      opt->default_ = var->path();
+    }
+    return opt;
+  }
+
+  [[nodiscard]] auto needsValue() const -> bool override { return true; }
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return shortName_;
+  }
+
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return longName_;
+  }
+
+  auto parseValue(const std::string& str) -> void override {
+    value_->assign(str, value_->format());
+  }
+
+  auto reset() -> void override {
+    if (value_ != nullptr && value_->path() != default_) {
+      value_->assign(default_, value_->format());
+    }
+  }
+
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage override {
+    MemoryUsage usage;
+    usage.options =
+        sizeof(ArrayFileOption) + MemoryUtils::stringBytes(default_);
+    usage.names = MemoryUtils::stringBytes(shortName_) +
+                  MemoryUtils::stringBytes(longName_);
+    if (value_ != nullptr) {
+      usage.boundValues =
+          MemoryUtils::stringBytes(value_->path()) + value_->heapBytes();
+    }
+    return usage;
+  }
+
+ private:
+  ArrayFileOption() = default;
+
+  std::string shortName_;
+  std::string longName_;
+  ArrayFile<T>* value_{nullptr};
+  std::string default_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_ARRAY_FILE_HPP
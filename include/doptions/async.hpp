@@ -0,0 +1,377 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "doptions/option.hpp"
+#ifndef DOPTIONS_ASYNC_HPP
+#define DOPTIONS_ASYNC_HPP
+
+namespace doptions {
+
+// Schedules coroutines. Implementations decide on which thread a posted
+// handle is resumed.
+class Executor {
+ public:
+  Executor(const Executor&) = delete;
+  Executor(Executor&&) = delete;
+  auto operator=(const Executor&) -> Executor& = delete;
+  auto operator=(Executor&&) -> Executor& = delete;
+  virtual ~Executor() = default;
+  virtual auto post(std::coroutine_handle<> handle) -> void = 0;
+
+ protected:
+  Executor() = default;
+};
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+template <typename T>
+class TaskPromiseBase {
+ public:
+  struct FinalAwaiter {
+    [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+    template <typename Promise>
+    auto await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        -> std::coroutine_handle<> {
+      auto continuation = handle.promise().continuation_;
+      if (continuation) {
+        return continuation;
+      }
+      return std::noop_coroutine();
+    }
+
+    auto await_resume() noexcept -> void {}
+  };
+
+  auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+
+  auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+
+  auto unhandled_exception() -> void { error_ = std::current_exception(); }
+
+  auto setContinuation(std::coroutine_handle<> continuation) -> void {
+    continuation_ = continuation;
+  }
+
+ protected:
+  std::coroutine_handle<> continuation_;
+  std::exception_ptr error_;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase<T> {
+ public:
+  auto get_return_object() -> Task<T>;
+
+  template <typename U>
+    requires(std::is_convertible_v<U &&, T>)
+  auto return_value(U&& value) -> void {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  auto result() -> T {
+    if (this->error_) {
+      std::rethrow_exception(this->error_);
+    }
+    return std::move(*value_);
+  }
+
+ private:
+  std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase<void> {
+ public:
+  auto get_return_object() -> Task<void>;
+
+  auto return_void() -> void {}
+
+  auto result() -> void {
+    if (this->error_) {
+      std::rethrow_exception(this->error_);
+    }
+  }
+};
+
+}  // namespace detail
+
+// Lazily started coroutine producing a T. Awaiting a task starts it and
+// resumes the awaiter once it finishes; exceptions propagate to the awaiter.
+template <typename T>
+class Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+
+  Task(const Task&) = delete;
+  auto operator=(const Task&) -> Task& = delete;
+
+  Task(Task&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  auto operator=(Task&& other) noexcept -> Task& {
+    if (this != &other) {
+      destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  ~Task() { destroy(); }
+
+  // Schedules the task on the executor without awaiting it.
+  auto start(Executor& executor) -> void { executor.post(handle_); }
+
+  [[nodiscard]] auto done() const -> bool { return handle_ && handle_.done(); }
+
+  // Returns the value of a finished task or rethrows its exception.
+  auto result() -> T { return handle_.promise().result(); }
+
+  [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+  auto await_suspend(std::coroutine_handle<> awaiter) noexcept
+      -> std::coroutine_handle<> {
+    handle_.promise().setContinuation(awaiter);
+    return handle_;
+  }
+
+  auto await_resume() -> T { return handle_.promise().result(); }
+
+ private:
+  friend promise_type;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  auto destroy() -> void {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = nullptr;
+    }
+  }
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+inline auto TaskPromise<T>::get_return_object() -> Task<T> {
+  return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline auto TaskPromise<void>::get_return_object() -> Task<void> {
+  return Task<void>(
+      std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Fire-and-forget coroutine that frees itself when it finishes.
+struct Detached {
+  struct promise_type {
+    auto get_return_object() -> Detached {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+
+    auto final_suspend() noexcept -> std::suspend_never { return {}; }
+
+    auto return_void() -> void {}
+
+    auto unhandled_exception() -> void { std::terminate(); }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+struct WhenAllState {
+  explicit WhenAllState(Executor& exec, size_t count)
+      : executor(exec), remaining(count + 1) {}
+
+  Executor& executor;
+  std::atomic<size_t> remaining;
+  std::coroutine_handle<> parent;
+  std::mutex errorMutex;
+  std::exception_ptr error;
+};
+
+inline auto runChild(Task<void> task, WhenAllState& state) -> Detached {
+  try {
+    co_await task;
+  } catch (...) {
+    const std::lock_guard lock(state.errorMutex);
+    if (!state.error) {
+      state.error = std::current_exception();
+    }
+  }
+  if (state.remaining.fetch_sub(1) == 1) {
+    state.executor.post(state.parent);
+  }
+}
+
+}  // namespace detail
+
+// Runs every task concurrently on the executor and finishes when all of them
+// did. The first exception raised by a task is rethrown afterwards.
+inline auto whenAll(Executor& executor, std::vector<Task<void>> tasks)
+    -> Task<void> {
+  detail::WhenAllState state(executor, tasks.size());
+  struct Awaiter {
+    detail::WhenAllState& state;
+    std::vector<Task<void>>& tasks;
+
+    [[nodiscard]] auto await_ready() const noexcept -> bool {
+      return tasks.empty();
+    }
+
+    auto await_suspend(std::coroutine_handle<> parent) -> bool {
+      state.parent = parent;
+      for (auto& task : tasks) {
+        state.executor.post(detail::runChild(std::move(task), state).handle);
+      }
+      // The extra count keeps the parent suspended until every child has
+      // been posted.
+      return state.remaining.fetch_sub(1) != 1;
+    }
+
+    auto await_resume() const noexcept -> void {}
+  };
+  co_await Awaiter{state, tasks};
+  if (state.error) {
+    std::rethrow_exception(state.error);
+  }
+}
+
+class AsyncOptionBase : public OptionBase {
+ public:
+  [[nodiscard]] virtual auto pending() const -> bool = 0;
+  // Runs the conversion of the value stored by parseValue.
+  virtual auto convert() -> Task<void> = 0;
+
+  // Values are only recorded while Application::parseAsync parses; any
+  // other parse giving the option throws. Starting to accept drops a value
+  // left over by a parse that failed before converting it.
+  auto acceptValues(bool accept) -> void {
+    if (accept) {
+      discard();
+    }
+    accepting_ = accept;
+  }
+
+ protected:
+  [[nodiscard]] auto accepting() const -> bool { return accepting_; }
+
+  virtual auto discard() -> void = 0;
+
+ private:
+  bool accepting_{false};
+};
+
+// Option whose converter is a coroutine. parseValue only records the token;
+// the conversion runs when Application::parseAsync awaits it.
+template <typename V>
+class AsyncOption : public AsyncOptionBase {
+ public:
+  using Converter = std::function<Task<V>(std::string)>;
+
+  static auto createOption(const std::string& name, V* var,
+                           Converter converter)
+      -> std::unique_ptr<AsyncOption> {
+    auto [shortName, longName] = makeNames(name);
+    std::unique_ptr<AsyncOption> opt;
+    opt.reset(new AsyncOption());
+    opt->shortName_ = std::move(shortName);
+    opt->longName_ = std::move(longName);
+    opt->value_ = var;
+    if (var != nullptr) {
+      opt->default_ = *var;
+    }
+    opt->converter_ = std::move(converter);
+    return opt;
+  }
+
+  [[nodiscard]] auto needsValue() const -> bool override { return true; }
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return shortName_;
+  }
+
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return longName_;
+  }
+
+  auto parseValue(const std::string& str) -> void override {
+    if (!accepting()) {
+      throw ParseException::asyncOnly(longName_.empty() ? shortName_
+                                                        : longName_);
+    }
+    pending_ = str;
+  }
+
+  auto reset() -> void override {
+    pending_.reset();
+    if (default_.has_value()) {
+      *value_ = *default_;
+    }
+  }
+
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage override {
+    MemoryUsage usage;
+    usage.options = sizeof(AsyncOption);
+    if (default_.has_value()) {
+      usage.options += MemoryUtils::heapBytes(*default_);
+    }
+    usage.names = MemoryUtils::stringBytes(shortName_) +
+                  MemoryUtils::stringBytes(longName_);
+    if (value_ != nullptr) {
+      usage.boundValues = MemoryUtils::heapBytes(*value_);
+    }
+    if (pending_.has_value()) {
+      usage.scratch = MemoryUtils::stringBytes(*pending_);
+    }
+    return usage;
+  }
+
+  [[nodiscard]] auto pending() const -> bool override {
+    return pending_.has_value();
+  }
+
+  auto convert() -> Task<void> override {
+    auto str = std::move(*pending_);
+    pending_.reset();
+    return assign(converter_(std::move(str)), value_);
+  }
+
+ protected:
+  auto discard() -> void override { pending_.reset(); }
+
+ private:
+  AsyncOption() = default;
+
+  static auto assign(Task<V> conversion, V* var) -> Task<void> {
+    *var = co_await conversion;
+  }
+
+  std::string shortName_;
+  std::string longName_;
+  V* value_{nullptr};
+  std::optional<V> default_;
+  Converter converter_;
+  std::optional<std::string> pending_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_ASYNC_HPP
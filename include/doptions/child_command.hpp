@@ -0,0 +1,284 @@
+#pragma once
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "doptions/application.hpp"
+#ifndef DOPTIONS_CHILD_COMMAND_HPP
+#define DOPTIONS_CHILD_COMMAND_HPP
+
+namespace doptions {
+
+struct SpillConfig {
+  // Bytes execve accepts for argv and the environment together, 0 reads
+  // sysconf(_SC_ARG_MAX).
+  size_t argMax{0};
+  // Kept free below argMax, as POSIX recommends for xargs.
+  size_t headroom{2048};
+  // Values shorter than this stay on the command line.
+  size_t minSpillBytes{size_t{4} << 10U};
+  // Environment the child gets, nullptr for the one of this process.
+  char* const* environment{nullptr};
+};
+
+// Command line for a child process repeating what an Application parsed.
+// When argv and the environment would not fit in what execve accepts, the
+// largest values of options that read @path files are written to memfd
+// files and passed as @/proc/self/fd/N instead, which the same options in
+// the child read back as if given inline. So are values longer than Linux
+// accepts for a single argument, whatever the total. Values the file would
+// not reproduce, such as ones holding newlines, stay inline.
+//
+// The files are open without close-on-exec so the child inherits them, and
+// closed when the ChildCommand is destroyed: keep it alive until the child
+// has been started. Children started meanwhile from other threads inherit
+// them too.
+class ChildCommand {
+ public:
+  static constexpr std::string_view fdPrefix = "/proc/self/fd/";
+
+  // Program followed by the arguments the last successful reparse with
+  // state went through, as they were given. Arguments from a command on
+  // belong to the command and are never spilled.
+  static auto fromState(const Application& app, const ParseState& state,
+                        std::string program, const SpillConfig& config = {})
+      -> ChildCommand {
+    if (!state.valid) {
+      throw std::logic_error("ParseState holds no successful parse");
+    }
+    const size_t end = state.command.has_value() ? state.commandPos
+                                                 : state.args.size();
+    return fromTokens(app, state.args, state.tokens, end, std::move(program),
+                      config);
+  }
+
+  // Same as fromState for the argv a successful parse of app went through.
+  // Names are resolved again through the index of app.
+  static auto fromArgs(Application& app, int32_t argc, char** argv,
+                       std::string program, const SpillConfig& config = {})
+      -> ChildCommand {
+    app.buildIndex();
+    const auto args = Application::buildArray(argc, argv);
+    std::vector<ParseState::Token> tokens(args.size());
+    size_t end = 0;
+    for (; end < args.size(); ++end) {
+      const auto& arg = args[end];
+      const auto& token = tokens[end] = app.lookupToken(arg);
+      if (token.kind == ParseState::Kind::Command) {
+        break;
+      }
+      if (!token.attached && app.options_.at(token.id)->needsValue()) {
+        if (end + 1 >= args.size()) {
+          throw ParseException::insufficientValues(arg);
+        }
+        ++end;
+      }
+    }
+    return fromTokens(app, args, tokens, end, std::move(program), config);
+  }
+
+  ChildCommand(const ChildCommand&) = delete;
+  auto operator=(const ChildCommand&) -> ChildCommand& = delete;
+
+  ChildCommand(ChildCommand&& other) noexcept
+      : args_(std::move(other.args_)), files_(std::move(other.files_)) {
+    other.files_.clear();
+  }
+
+  auto operator=(ChildCommand&& other) noexcept -> ChildCommand& {
+    if (this != &other) {
+      closeFiles();
+      args_ = std::move(other.args_);
+      files_ = std::move(other.files_);
+      other.files_.clear();
+    }
+    return *this;
+  }
+
+  ~ChildCommand() { closeFiles(); }
+
+  [[nodiscard]] auto args() const -> const std::vector<std::string>& {
+    return args_;
+  }
+
+  // Null terminated argv for execve, valid while this object lives.
+  [[nodiscard]] auto argv() -> std::vector<char*> {
+    std::vector<char*> argv;
+    argv.reserve(args_.size() + 1);
+    for (auto& arg : args_) {
+      argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+    return argv;
+  }
+
+  // Bytes argv takes in the new process image: the strings with their
+  // terminators and a pointer to each, plus the closing null pointer.
+  [[nodiscard]] auto encodedSize() const -> size_t {
+    size_t size = sizeof(char*);
+    for (const auto& arg : args_) {
+      size += encodedSize(arg.size());
+    }
+    return size;
+  }
+
+  // Descriptors of the files holding spilled values.
+  [[nodiscard]] auto files() const -> const std::vector<int>& {
+    return files_;
+  }
+
+  // Longest single argument Linux accepts.
+  [[nodiscard]] static auto maxArgLength() -> size_t {
+    return 32 * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  }
+
+ private:
+  ChildCommand() = default;
+
+  // Option value at args_[arg], after prefix bytes of "--name=".
+  struct Candidate {
+    size_t arg;
+    size_t prefix;
+  };
+
+  // Copies args and spills the values of the options among the first end
+  // of them, whose kinds are in tokens.
+  static auto fromTokens(const Application& app,
+                         const std::vector<std::string>& args,
+                         const std::vector<ParseState::Token>& tokens,
+                         size_t end, std::string program,
+                         const SpillConfig& config) -> ChildCommand {
+    ChildCommand cmd;
+    cmd.args_.reserve(args.size() + 1);
+    cmd.args_.push_back(std::move(program));
+    std::vector<Candidate> candidates;
+    for (size_t idx = 0; idx < end; ++idx) {
+      const auto& token = tokens.at(idx);
+      cmd.args_.push_back(args[idx]);
+      if (token.kind != ParseState::Kind::Option) {
+        continue;
+      }
+      const auto& opt = app.options_.at(token.id);
+      const bool separate = !token.attached && opt->needsValue();
+      if (separate) {
+        cmd.args_.push_back(args.at(++idx));
+      }
+      if (opt->readsAtFiles() && (token.attached || separate)) {
+        const auto& arg = cmd.args_.back();
+        const size_t prefix = token.attached ? arg.find('=') + 1 : 0;
+        if (readsBackAs(std::string_view(arg).substr(prefix))) {
+          candidates.push_back({cmd.args_.size() - 1, prefix});
+        }
+      }
+    }
+    cmd.args_.insert(cmd.args_.end(),
+                     args.begin() + static_cast<std::ptrdiff_t>(end),
+                     args.end());
+    cmd.spill(candidates, config);
+    return cmd;
+  }
+
+  // Whether value, written to a file passed as @path, is read back as the
+  // same value. Newlines in the file also separate elements, and a value
+  // that already is an @path would be wrapped once more.
+  static auto readsBackAs(std::string_view value) -> bool {
+    return !value.starts_with('@') &&
+           value.find('\n') == std::string_view::npos;
+  }
+
+  static constexpr auto encodedSize(size_t length) -> size_t {
+    return length + 1 + sizeof(char*);
+  }
+
+  static auto environmentSize(char* const* environment) -> size_t {
+    if (environment == nullptr) {
+      environment = environ;
+    }
+    size_t size = sizeof(char*);
+    for (; environment != nullptr && *environment != nullptr; ++environment) {
+      size += encodedSize(std::strlen(*environment));
+    }
+    return size;
+  }
+
+  auto spill(std::vector<Candidate>& candidates, const SpillConfig& config)
+      -> void {
+    size_t argMax = config.argMax;
+    if (argMax == 0) {
+      argMax = static_cast<size_t>(::sysconf(_SC_ARG_MAX));
+    }
+    const size_t used =
+        encodedSize() + environmentSize(config.environment) + config.headroom;
+    size_t excess = used > argMax ? used - argMax : 0;
+    const size_t maxLength = maxArgLength();
+    std::sort(candidates.begin(), candidates.end(),
+              [this](const Candidate& lhs, const Candidate& rhs) {
+                return args_[lhs.arg].size() > args_[rhs.arg].size();
+              });
+    for (const auto& candidate : candidates) {
+      auto& arg = args_[candidate.arg];
+      if (excess == 0 && arg.size() < maxLength) {
+        break;
+      }
+      if (arg.size() < config.minSpillBytes && arg.size() < maxLength) {
+        break;
+      }
+      const size_t before = arg.size();
+      const int fd =
+          writeFile(std::string_view(arg).substr(candidate.prefix));
+      arg.replace(candidate.prefix, arg.npos,
+                  "@" + std::string(fdPrefix) + std::to_string(fd));
+      excess -= std::min(excess, before - std::min(before, arg.size()));
+    }
+    const bool tooLong =
+        std::any_of(args_.begin(), args_.end(), [maxLength](const auto& arg) {
+          return arg.size() >= maxLength;
+        });
+    if (excess > 0 || tooLong) {
+      throw std::system_error(E2BIG, std::generic_category(),
+                              "child command line");
+    }
+  }
+
+  auto writeFile(std::string_view text) -> int {
+    const int fd = ::memfd_create("doptions-response", 0);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "memfd_create");
+    }
+    files_.push_back(fd);
+    while (!text.empty()) {
+      const ssize_t written = ::write(fd, text.data(), text.size());
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written < 0) {
+        throw std::system_error(errno, std::generic_category(), "write");
+      }
+      text.remove_prefix(static_cast<size_t>(written));
+    }
+    return fd;
+  }
+
+  auto closeFiles() -> void {
+    for (const int fd : files_) {
+      ::close(fd);
+    }
+    files_.clear();
+  }
+
+  std::vector<std::string> args_;
+  std::vector<int> files_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_CHILD_COMMAND_HPP
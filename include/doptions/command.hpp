@@ -2,13 +2,20 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <vector>
+#include "doptions/deprecations.hpp"
 #include "doptions/exceptions.hpp"
+#include "doptions/index.hpp"
+#include "doptions/memory.hpp"
 #include "doptions/validations.hpp"
 #ifndef DOPTIONS_COMMAND_HPP
 #define DOPTIONS_COMMAND_HPP
 
 #include <string>
+#include "array_file.hpp"
+#include "list.hpp"
 #include "option.hpp"
 
 namespace doptions {
@@ -19,6 +26,12 @@ class Command {
       -> std::unique_ptr<Command> {
     NameValidations::validateName(name);
     NameValidations::validateSize(name, false);
+    return createPrevalidated(name);
+  }
+
+  // Builds a command from a name that already passed validation.
+  static auto createPrevalidated(const std::string& name)
+      -> std::unique_ptr<Command> {
     std::unique_ptr<Command> cmdPtr(new Command());
     cmdPtr->name_ = name;
     return cmdPtr;
@@ -28,47 +41,120 @@ class Command {
     requires(concepts::HasFromStr<T>)
   auto addOption(const std::string& name, T* var)
       -> std::unique_ptr<OptionBase>& {
-    auto optPtr = Option<T>::createOption(name, var);
+    return addOption(Option<T>::createOption(name, var));
+  }
+
+  // Registers a list option; see ListOption for the accepted values. A
+  // std::vector registered with REGISTER_TYPE goes through its own fromStr.
+  template <typename T>
+    requires(concepts::IsListElement<T> &&
+             !concepts::HasFromStr<std::vector<T>>)
+  auto addOption(const std::string& name, std::vector<T>* var)
+      -> std::unique_ptr<OptionBase>& {
+    return addOption(ListOption<T>::createOption(name, var));
+  }
+
+  // Registers an option taking the path of a numeric array file.
+  template <typename T>
+  auto addOption(const std::string& name, ArrayFile<T>* var)
+      -> std::unique_ptr<OptionBase>& {
+    return addOption(ArrayFileOption<T>::createOption(name, var));
+  }
+
+  // Registers a list option whose elements go to callback one at a time.
+  template <typename T>
+  auto addStreamOption(const std::string& name,
+                       typename StreamOption<T>::Callback callback)
+      -> std::unique_ptr<OptionBase>& {
+    return addOption(StreamOption<T>::createOption(name, callback));
+  }
+
+  auto addOption(std::unique_ptr<OptionBase> optPtr)
+      -> std::unique_ptr<OptionBase>& {
     options_.push_back(std::move(optPtr));
+    indexDirty_ = true;
     return options_.at(options_.size() - 1);
   }
 
   [[nodiscard]] auto name() const -> const std::string& { return name_; }
 
-  auto parseCommand(const std::vector<std::string>& args) -> void {
-    std::map<std::string, size_t> nameMap;
-    size_t idx = 0;
+  // Same as Application::addAlias for the options of this command.
+  auto addAlias(const std::string& target, const std::string& alias)
+      -> void {
+    optionNamed(target).addAlias(alias, {}, false);
+    indexDirty_ = true;
+  }
+
+  // Same as Application::addDeprecatedAlias for the options of this command.
+  auto addDeprecatedAlias(const std::string& target, const std::string& alias,
+                          const std::string& notice = {}) -> void {
+    optionNamed(target).addAlias(alias, notice, true);
+    indexDirty_ = true;
+  }
+
+  // How tokens are matched against option names, see MatchPolicy.
+  auto setMatchPolicy(MatchPolicy policy) -> void {
+    optionIndex_.setPolicy(policy);
+    indexDirty_ = true;
+  }
+
+  [[nodiscard]] auto matchPolicy() const -> MatchPolicy {
+    return optionIndex_.policy();
+  }
+
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage {
+    MemoryUsage usage;
+    usage.commands = sizeof(Command) + MemoryUtils::vectorBytes(options_);
+    usage.names = MemoryUtils::stringBytes(name_);
     for (const auto& opt : options_) {
-      auto sName = opt->shortName();
-      auto lName = opt->longName();
-      if (!sName.empty()) {
-        nameMap[sName] = idx;
-      }
-      if (!lName.empty()) {
-        nameMap[lName] = idx;
-      }
-      idx++;
+      usage += opt->memoryUsage();
+      usage.names += opt->aliasBytes();
+    }
+    usage.lookupTables = optionIndex_.memoryBytes();
+    return usage;
+  }
+
+  auto resetOptions() -> void {
+    for (auto& opt : options_) {
+      opt->reset();
+    }
+  }
+
+  // Frees the arenas the options of this command converted values into,
+  // see OptionBase::releaseMemory. parseCommand calls it before converting.
+  auto releaseConversionMemory() -> void {
+    for (auto& opt : options_) {
+      opt->releaseMemory();
     }
+  }
+
+  auto parseCommand(const std::vector<std::string>& args) -> void {
+    buildIndex();
+    releaseConversionMemory();
     std::map<size_t, bool> parsed;
     size_t argsIndex = 0;
     for (; argsIndex < args.size(); ++argsIndex) {
       const auto& arg = args[argsIndex];
-      if (!nameMap.contains(arg)) {
-        throw ParseException::unknownArg(arg);
+      const auto* entry = optionIndex_.lookup(arg);
+      std::optional<std::string_view> attached;
+      if (entry == nullptr) {
+        // "--name=value" for options that take a value.
+        auto [named, value] = optionIndex_.lookupAttached(arg);
+        if (named == nullptr || !options_.at(named->id)->needsValue()) {
+          throw ParseException::unknownArg(arg);
+        }
+        entry = named;
+        attached = value;
       }
-      const auto argIdx = nameMap.at(arg);
+      const size_t argIdx = resolveOption(*entry);
       if (parsed.contains(argIdx)) {
-        std::string argNames;
-        for (const auto& [name, idx] : nameMap) {
-          if (idx == argIdx) {
-            argNames += name;
-            argNames += ", ";
-          }
-        }
-        throw ParseException::multiArg(argNames);
+        throw ParseException::multiArg(optionIndex_.namesOf(argIdx));
       }
       auto& opt = options_.at(argIdx);
-      if (opt->needsValue()) {
+      if (attached.has_value()) {
+        // Converted like a separate value, so both forms agree.
+        opt->parseValue(std::string(*attached));
+      } else if (opt->needsValue()) {
         if (argsIndex + 1 >= args.size()) {
           throw ParseException::insufficientValues(arg);
         }
@@ -83,8 +169,55 @@ class Command {
 
  private:
   Command() = default;
+
+  auto optionNamed(const std::string& name) -> OptionBase& {
+    buildIndex();
+    auto optIdx = optionIndex_.find(name);
+    if (!optIdx.has_value()) {
+      throw BuildException::unknownName(name);
+    }
+    return *options_.at(*optIdx);
+  }
+
+  // Option id of a matched entry, reporting deprecated aliases.
+  [[nodiscard]] auto resolveOption(const NameIndex::Entry& entry) const
+      -> size_t {
+    if (entry.alias != 0) {
+      const auto& alias = options_.at(entry.id)->aliases().at(entry.alias - 1);
+      if (alias.deprecated) {
+        Deprecations::report(alias.name, alias.notice);
+      }
+    }
+    return entry.id;
+  }
+
+  auto buildIndex() -> void {
+    if (!indexDirty_) {
+      return;
+    }
+    optionIndex_.clear();
+    for (size_t idx = 0; idx < options_.size(); ++idx) {
+      const auto& opt = options_[idx];
+      if (!opt->shortName().empty()) {
+        optionIndex_.insert(opt->shortName(), idx);
+      }
+      if (!opt->longName().empty()) {
+        optionIndex_.insert(opt->longName(), idx);
+      }
+      const auto& aliases = opt->aliases();
+      for (size_t alias = 0; alias < aliases.size(); ++alias) {
+        optionIndex_.insert(aliases[alias].name, idx,
+                            static_cast<uint32_t>(alias + 1));
+      }
+    }
+    optionIndex_.sort();
+    indexDirty_ = false;
+  }
+
   std::vector<std::unique_ptr<OptionBase>> options_;
   std::string name_;
+  NameIndex optionIndex_;
+  bool indexDirty_{true};
 };
 
 }  // namespace doptions
@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include "doptions/exceptions.hpp"
+#ifndef DOPTIONS_CONVERT_CONTEXT_HPP
+#define DOPTIONS_CONVERT_CONTEXT_HPP
+
+namespace doptions {
+
+// Keeps the first error a converter reported instead of throwing it.
+class ErrorSink {
+ public:
+  auto report(const ParseException& error) -> void {
+    if (!error_.has_value()) {
+      error_ = error;
+    }
+  }
+
+  [[nodiscard]] auto failed() const -> bool { return error_.has_value(); }
+
+  [[nodiscard]] auto error() const -> const std::optional<ParseException>& {
+    return error_;
+  }
+
+  // Throws the reported error, if any.
+  auto check() const -> void {
+    if (error_.has_value()) {
+      throw *error_;
+    }
+  }
+
+ private:
+  std::optional<ParseException> error_;
+};
+
+// What a converter registered with REGISTER_CONTEXT_TYPE receives next to
+// the text: the memory to place the contents of the value in, the id of the
+// option being converted and a sink for errors.
+//
+// Within Application the memory is an arena shared by every option of the
+// application and released in one shot at the start of the next parse, see
+// Application::releaseConversionMemory. Options converting on their own,
+// command options among them, use an arena of the option, freed by
+// OptionBase::releaseMemory. Either way the memory is never freed piece by
+// piece, and destructors of what is placed in it do not run: values should
+// refer to it through views and spans of trivially destructible types.
+// Allocator-aware containers copy out of the arena when the value is
+// assigned to the bound variable.
+class ConvertContext {
+ public:
+  static constexpr size_t noOption = std::numeric_limits<size_t>::max();
+
+  explicit ConvertContext(std::pmr::memory_resource* memory,
+                          size_t optionId = noOption)
+      : memory_(memory), optionId_(optionId) {}
+
+  [[nodiscard]] auto memory() const -> std::pmr::memory_resource* {
+    return memory_;
+  }
+
+  // Index of the option in its application, noOption outside of one.
+  [[nodiscard]] auto optionId() const -> size_t { return optionId_; }
+
+  [[nodiscard]] auto errors() -> ErrorSink& { return errors_; }
+
+  // Copies text into the memory of the context.
+  [[nodiscard]] auto store(std::string_view text) -> std::string_view {
+    if (text.empty()) {
+      return {};
+    }
+    auto* data = static_cast<char*>(memory_->allocate(text.size(), 1));
+    std::copy(text.begin(), text.end(), data);
+    return {data, text.size()};
+  }
+
+  // Uninitialized room for count objects of type T.
+  template <typename T>
+    requires(std::is_trivially_destructible_v<T>)
+  [[nodiscard]] auto allocate(size_t count) -> std::span<T> {
+    if (count == 0) {
+      return {};
+    }
+    auto* data =
+        static_cast<T*>(memory_->allocate(count * sizeof(T), alignof(T)));
+    return {data, count};
+  }
+
+ private:
+  std::pmr::memory_resource* memory_;
+  size_t optionId_;
+  ErrorSink errors_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_CONVERT_CONTEXT_HPP
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#ifndef DOPTIONS_DEPRECATIONS_HPP
+#define DOPTIONS_DEPRECATIONS_HPP
+
+namespace doptions {
+
+// Reports deprecated names the first time one of them is used in the
+// process, from any application. The default handler prints a warning to
+// stderr.
+class Deprecations {
+ public:
+  using Handler = void (*)(std::string_view name, std::string_view notice);
+
+  // nullptr restores the default handler.
+  static auto setHandler(Handler handler) -> void {
+    state().handler.store(handler == nullptr ? printNotice : handler);
+  }
+
+  static auto report(std::string_view name, std::string_view notice) -> void {
+    auto& shared = state();
+    {
+      const std::lock_guard lock(shared.mutex);
+      if (!shared.reported.emplace(name).second) {
+        return;
+      }
+    }
+    shared.handler.load()(name, notice);
+  }
+
+  [[nodiscard]] static auto reported(std::string_view name) -> bool {
+    auto& shared = state();
+    const std::lock_guard lock(shared.mutex);
+    return shared.reported.contains(name);
+  }
+
+  // Forgets which names were reported, so they are reported again.
+  static auto clear() -> void {
+    auto& shared = state();
+    const std::lock_guard lock(shared.mutex);
+    shared.reported.clear();
+  }
+
+ private:
+  static auto printNotice(std::string_view name, std::string_view notice)
+      -> void {
+    std::fprintf(stderr, "warning: %.*s is deprecated",
+                 static_cast<int>(name.size()), name.data());
+    if (!notice.empty()) {
+      std::fprintf(stderr, ", %.*s", static_cast<int>(notice.size()),
+                   notice.data());
+    }
+    std::fputc('\n', stderr);
+  }
+
+  struct State {
+    std::mutex mutex;
+    std::set<std::string, std::less<>> reported;
+    std::atomic<Handler> handler{printNotice};
+  };
+
+  static auto state() -> State& {
+    static State shared;
+    return shared;
+  }
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_DEPRECATIONS_HPP
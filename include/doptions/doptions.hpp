@@ -3,8 +3,22 @@
 
 // Main doptions library header - includes all core components
 #include "application.hpp"
+#include "arena.hpp"
+#include "array_file.hpp"
+// Child command lines spill to memfd response files, which are Linux only.
+#if defined(__linux__)
+#include "child_command.hpp"
+#endif
 #include "command.hpp"
+#include "convert_context.hpp"
+#include "deprecations.hpp"
 #include "exceptions.hpp"
+#include "interpolation.hpp"
+#include "json.hpp"
+#include "list.hpp"
 #include "option.hpp"
+#include "preset.hpp"
+#include "static_application.hpp"
+#include "struct_binding.hpp"
 
 #endif  // DOPTIONS_HEADER
@@ -0,0 +1,154 @@
+#pragma once
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include "doptions/async.hpp"
+#ifndef DOPTIONS_EPOLL_EXECUTOR_HPP
+#define DOPTIONS_EPOLL_EXECUTOR_HPP
+
+namespace doptions {
+
+// Single-threaded executor driven by epoll. Coroutines are resumed on the
+// thread calling run(); post() may be called from any thread.
+class EpollExecutor : public Executor {
+ public:
+  // Resumes the awaiting coroutine once fd reports the events. Files that
+  // epoll cannot watch, such as regular files, are always ready.
+  struct FdAwaiter {
+    EpollExecutor& executor;
+    int fd;
+    uint32_t events;
+
+    [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+    auto await_suspend(std::coroutine_handle<> handle) -> bool {
+      epoll_event event{};
+      event.events = events | EPOLLONESHOT;
+      event.data.ptr = handle.address();
+      if (::epoll_ctl(executor.epollFd_, EPOLL_CTL_ADD, fd, &event) == 0) {
+        return true;
+      }
+      if (errno == EEXIST &&
+          ::epoll_ctl(executor.epollFd_, EPOLL_CTL_MOD, fd, &event) == 0) {
+        return true;
+      }
+      if (errno == EPERM) {
+        return false;
+      }
+      throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+    }
+
+    auto await_resume() const noexcept -> void {}
+  };
+
+  EpollExecutor()
+      : epollFd_(::epoll_create1(EPOLL_CLOEXEC)),
+        wakeFd_(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+      closeFds();
+      throw std::system_error(errno, std::generic_category(), "epoll setup");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event) != 0) {
+      closeFds();
+      throw std::system_error(errno, std::generic_category(), "epoll setup");
+    }
+  }
+
+  EpollExecutor(const EpollExecutor&) = delete;
+  EpollExecutor(EpollExecutor&&) = delete;
+  auto operator=(const EpollExecutor&) -> EpollExecutor& = delete;
+  auto operator=(EpollExecutor&&) -> EpollExecutor& = delete;
+
+  ~EpollExecutor() override { closeFds(); }
+
+  auto post(std::coroutine_handle<> handle) -> void override {
+    {
+      const std::lock_guard lock(mutex_);
+      ready_.push_back(handle);
+    }
+    const uint64_t one = 1;
+    [[maybe_unused]] auto written = ::write(wakeFd_, &one, sizeof(one));
+  }
+
+  [[nodiscard]] auto readable(int fd) -> FdAwaiter {
+    return FdAwaiter{*this, fd, EPOLLIN};
+  }
+
+  [[nodiscard]] auto writable(int fd) -> FdAwaiter {
+    return FdAwaiter{*this, fd, EPOLLOUT};
+  }
+
+  // Starts the task and runs the event loop until it has finished.
+  template <typename T>
+  auto run(Task<T>& task) -> T {
+    task.start(*this);
+    while (!task.done()) {
+      runOnce();
+    }
+    return task.result();
+  }
+
+ private:
+  static constexpr int maxEvents = 64;
+
+  auto runOnce() -> void {
+    std::deque<std::coroutine_handle<>> ready;
+    {
+      const std::lock_guard lock(mutex_);
+      ready.swap(ready_);
+    }
+    if (!ready.empty()) {
+      for (auto handle : ready) {
+        handle.resume();
+      }
+      return;
+    }
+    std::array<epoll_event, maxEvents> events{};
+    const int count = ::epoll_wait(epollFd_, events.data(), maxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        return;
+      }
+      throw std::system_error(errno, std::generic_category(), "epoll_wait");
+    }
+    for (int idx = 0; idx < count; ++idx) {
+      void* address = events.at(idx).data.ptr;
+      if (address == nullptr) {
+        uint64_t value = 0;
+        [[maybe_unused]] auto bytes = ::read(wakeFd_, &value, sizeof(value));
+        continue;
+      }
+      std::coroutine_handle<>::from_address(address).resume();
+    }
+  }
+
+  auto closeFds() -> void {
+    if (epollFd_ >= 0) {
+      ::close(epollFd_);
+      epollFd_ = -1;
+    }
+    if (wakeFd_ >= 0) {
+      ::close(wakeFd_);
+      wakeFd_ = -1;
+    }
+  }
+
+  int epollFd_;
+  int wakeFd_;
+  std::mutex mutex_;
+  std::deque<std::coroutine_handle<>> ready_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_EPOLL_EXECUTOR_HPP
@@ -1,8 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
 #include "doptions/utils.hpp"
 #ifndef DOPTIONS_EXCEPTIONS_HPP
 #define DOPTIONS_EXCEPTIONS_HPP
@@ -13,73 +18,234 @@ class DOptionsException : public std::invalid_argument {
  public:
   explicit DOptionsException(std::string_view msg)
       : std::invalid_argument(std::string(msg)) {}
+
+ protected:
+  // For subclasses that provide their own what(). With libstdc++ the empty
+  // message is a shared representation and does not allocate.
+  DOptionsException() : std::invalid_argument("") {}
+};
+
+// Exception whose fields live in fixed inline storage. The message is
+// formatted into an inline buffer as the exception is built, so creating,
+// copying and throwing it never allocates, and what() only reads, so any
+// number of threads may call it on the same exception. Text longer than the
+// inline storage is truncated.
+class InlineException : public DOptionsException {
+ public:
+  static constexpr size_t textCapacity = 128;
+  static constexpr size_t messageCapacity = 256;
+  static constexpr size_t maxNumbers = 3;
+
+  [[nodiscard]] auto what() const noexcept -> const char* override {
+    return message_.data();
+  }
+
+  // Argument or name the error refers to.
+  [[nodiscard]] auto text() const noexcept -> std::string_view {
+    return {text_.data(), textSize_};
+  }
+
+ protected:
+  // The pattern is a string literal in which %s stands for the text and %d
+  // for the next number.
+  InlineException(const char* category, const char* pattern,
+                  std::string_view text)
+      : category_(category), pattern_(pattern) {
+    textSize_ = std::min(text.size(), textCapacity - 1);
+    std::copy_n(text.data(), textSize_, text_.data());
+    if (textSize_ < text.size()) {
+      std::fill_n(text_.data() + textSize_ - 3, 3, '.');  // NOLINT
+    }
+    format();
+  }
+
+  template <typename T>
+    requires(concepts::IsInteger<T>)
+  auto addNumber(T value) noexcept -> void {
+    if (numberCount_ == maxNumbers) {
+      return;
+    }
+    auto& number = numbers_.at(numberCount_++);
+    number.isSigned = concepts::IsSignedInteger<T>;
+    if constexpr (concepts::IsSignedInteger<T>) {
+      number.signedValue = value;
+    } else {
+      number.unsignedValue = value;
+    }
+    format();
+  }
+
+ private:
+  struct Number {
+    bool isSigned{false};
+    int64_t signedValue{0};
+    uint64_t unsignedValue{0};
+  };
+
+  class Writer {
+   public:
+    explicit Writer(std::array<char, messageCapacity>& buffer)
+        : buffer_(buffer) {}
+
+    auto write(std::string_view str) noexcept -> void {
+      const size_t count = std::min(str.size(), messageCapacity - 1 - size_);
+      std::copy_n(str.data(), count, buffer_.data() + size_);  // NOLINT
+      size_ += count;
+    }
+
+    template <typename T>
+    auto writeNumber(T value) noexcept -> void {
+      std::array<char, 24> digits{};
+      auto [end, error] =
+          std::to_chars(digits.data(), digits.data() + digits.size(), value);
+      write(std::string_view(digits.data(), end));
+    }
+
+    auto finish() noexcept -> void { buffer_.at(size_) = '\0'; }
+
+   private:
+    std::array<char, messageCapacity>& buffer_;
+    size_t size_{0};
+  };
+
+  auto format() noexcept -> void {
+    Writer writer(message_);
+    writer.write(category_);
+    size_t number = 0;
+    std::string_view pattern = pattern_;
+    for (size_t idx = 0; idx < pattern.size(); ++idx) {
+      if (pattern[idx] != '%' || idx + 1 == pattern.size()) {
+        writer.write(pattern.substr(idx, 1));
+        continue;
+      }
+      const char spec = pattern[++idx];
+      if (spec == 's') {
+        writer.write(text());
+      } else if (spec == 'd' && number < numberCount_) {
+        const auto& value = numbers_.at(number++);
+        if (value.isSigned) {
+          writer.writeNumber(value.signedValue);
+        } else {
+          writer.writeNumber(value.unsignedValue);
+        }
+      }
+    }
+    writer.finish();
+  }
+
+  const char* category_;
+  const char* pattern_;
+  std::array<char, textCapacity> text_{};
+  size_t textSize_{0};
+  std::array<Number, maxNumbers> numbers_{};
+  size_t numberCount_{0};
+  std::array<char, messageCapacity> message_{};
 };
 
-class ParseException : public DOptionsException {
+class ParseException : public InlineException {
  public:
   static auto unknownArg(std::string_view arg) -> ParseException {
-    return ParseException("Unknown argument: " + std::string(arg));
+    return {"Unknown argument: %s", arg};
   }
 
   static auto insufficientValues(std::string_view arg) -> ParseException {
-    return ParseException("Insufficient values for arg: " + std::string(arg));
+    return {"Insufficient values for arg: %s", arg};
   }
 
   static auto multiArg(std::string_view arg) -> ParseException {
-    return ParseException("Same argument appears multiple times: " +
-                          std::string(arg));
+    return {"Same argument appears multiple times: %s", arg};
+  }
+
+  static auto invalidValue(std::string_view value) -> ParseException {
+    return {"Invalid value: %s", value};
+  }
+
+  static auto invalidElement(std::string_view element, size_t position)
+      -> ParseException {
+    ParseException error("Invalid list element at position %d: %s", element);
+    error.addNumber(static_cast<uint64_t>(position));
+    return error;
+  }
+
+  static auto unresolvedReference(std::string_view name) -> ParseException {
+    return {"Unresolved reference: ${%s}", name};
+  }
+
+  static auto referenceCycle(std::string_view name) -> ParseException {
+    return {"Reference cycle through: %s", name};
+  }
+
+  static auto asyncOnly(std::string_view name) -> ParseException {
+    return {"Option is only converted by parseAsync: %s", name};
   }
 
   template <typename T>
     requires(concepts::IsUnsignedInteger<T>)
-  static auto outOfRange(size_t val) -> ParseException {
-    auto [min, max] = NumberUtils::getLimits<T>();
-    auto minStr = NumberUtils::toString(min);
-    auto maxStr = NumberUtils::toString(max);
-    auto valStr = NumberUtils::toString(val);
-    return ParseException("Value out of range: " + valStr + " (" + minStr +
-                          " - " + maxStr + ")");
+  static auto outOfRange(uint64_t val) -> ParseException {
+    return rangeError(val, NumberUtils::getLimits<T>());
   }
 
   template <typename T>
     requires(concepts::IsSignedInteger<T>)
-  static auto outOfRange(uint64_t val) -> ParseException {
-    auto [min, max] = NumberUtils::getLimits<T>();
-    auto minStr = NumberUtils::toString(min);
-    auto maxStr = NumberUtils::toString(max);
-    auto valStr = NumberUtils::toString(val);
-    return ParseException("Value out of range: " + valStr + " (" + minStr +
-                          " - " + maxStr + ")");
+  static auto outOfRange(int64_t val) -> ParseException {
+    return rangeError(val, NumberUtils::getLimits<T>());
   }
 
  private:
-  explicit ParseException(std::string_view str)
-      : DOptionsException("Parse Exception: " + std::string(str)) {};
+  ParseException(const char* pattern, std::string_view text)
+      : InlineException("Parse Exception: ", pattern, text) {}
+
+  template <typename V, typename T>
+  static auto rangeError(V val, std::pair<T, T> limits) -> ParseException {
+    ParseException error("Value out of range: %d (%d - %d)", {});
+    error.addNumber(val);
+    error.addNumber(limits.first);
+    error.addNumber(limits.second);
+    return error;
+  }
 };
 
-class BuildException : public DOptionsException {
+class BuildException : public InlineException {
  public:
   static auto invalidName(std::string_view name) -> BuildException {
-    return BuildException("Invalid name for argument: " + std::string(name));
+    return {"Invalid name for argument: %s", name};
+  }
+
+  static auto unknownName(std::string_view name) -> BuildException {
+    return {"No argument registered with name: %s", name};
+  }
+
+  static auto ambiguousName(std::string_view name) -> BuildException {
+    return {"Names differ only in case: %s", name};
+  }
+
+  static auto presetOptionTaken(std::string_view name) -> BuildException {
+    return {"Preset option already registered: %s", name};
+  }
+
+  static auto invalidSchema(std::string_view line) -> BuildException {
+    return {"Invalid schema line: %s", line};
   }
 
   static auto emptyName(std::string_view name) -> BuildException {
-    return BuildException("Name cannot be empty: " + std::string(name));
+    return {"Name cannot be empty: %s", name};
   }
 
   static auto invalidSize(std::string_view name, uint8_t min, uint8_t max,
                           bool isShort) -> BuildException {
-    auto size = std::to_string(name.size());
-    std::string msg = isShort ? " [short: " : " [long: ";
-    msg += NumberUtils::toString(min) + "-" + NumberUtils::toString(max);
-    msg += "]";
-    return BuildException("Name has invalid size: " + std::string(name) + " (" +
-                          size + ")" + msg);
+    BuildException error(isShort
+                             ? "Name has invalid size: %s (%d) [short: %d-%d]"
+                             : "Name has invalid size: %s (%d) [long: %d-%d]",
+                         name);
+    error.addNumber(static_cast<uint64_t>(name.size()));
+    error.addNumber(min);
+    error.addNumber(max);
+    return error;
   }
 
  private:
-  explicit BuildException(std::string_view str)
-      : DOptionsException("Build Exception: " + std::string(str)) {};
+  BuildException(const char* pattern, std::string_view text)
+      : InlineException("Build Exception: ", pattern, text) {}
 };
 
 }  // namespace doptions
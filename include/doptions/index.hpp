@@ -0,0 +1,228 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "doptions/exceptions.hpp"
+#include "doptions/memory.hpp"
+#include "doptions/utils.hpp"
+#ifndef DOPTIONS_INDEX_HPP
+#define DOPTIONS_INDEX_HPP
+
+namespace doptions {
+
+// How tokens are compared with registered names. IgnoreCase folds ASCII
+// letters only.
+enum class MatchPolicy : uint8_t { Exact, IgnoreCase };
+
+// Name -> id lookup table built once from the registered names and reused
+// across parses. Names are kept in one pool and the entries, sorted by name,
+// refer to it by offset, so the table has no pointers and can be stored as
+// is. Lookups take a string_view so tokens are never copied. Under
+// IgnoreCase names are folded once on insert and tokens are folded while
+// they are compared.
+class NameIndex {
+ public:
+  struct Entry {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t id;
+    // 0 for the names of the id itself, alias + 1 for its aliases.
+    uint32_t alias;
+  };
+
+  // Index over a pool and sorted entries owned by someone else, for example
+  // a mapped cache file that outlives the index.
+  static auto fromView(std::string_view pool, std::span<const Entry> entries)
+      -> NameIndex {
+    NameIndex index;
+    index.externalPool_ = pool;
+    index.externalEntries_ = entries;
+    index.external_ = true;
+    return index;
+  }
+
+  // Keeps the policy, which applies to the names inserted next.
+  auto clear() -> void {
+    pool_.clear();
+    entries_.clear();
+    external_ = false;
+  }
+
+  auto setPolicy(MatchPolicy policy) -> void { policy_ = policy; }
+
+  [[nodiscard]] auto policy() const -> MatchPolicy { return policy_; }
+
+  // Adds a name; sort() must run before the next lookup. When a name is
+  // inserted twice the last id wins.
+  auto insert(std::string_view name, size_t id, uint32_t alias = 0) -> void {
+    entries_.push_back({static_cast<uint32_t>(pool_.size()),
+                        static_cast<uint32_t>(name.size()),
+                        static_cast<uint32_t>(id), alias});
+    const size_t begin = pool_.size();
+    pool_.append(name);
+    if (policy_ == MatchPolicy::IgnoreCase) {
+      for (size_t idx = begin; idx < pool_.size(); ++idx) {
+        pool_[idx] = StringUtils::foldCase(pool_[idx]);
+      }
+    }
+  }
+
+  // Under IgnoreCase, throws when two ids share a name once folded.
+  auto sort() -> void {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [this](const Entry& lhs, const Entry& rhs) {
+                       return nameOf(lhs) < nameOf(rhs);
+                     });
+    if (policy_ == MatchPolicy::IgnoreCase) {
+      auto clash = std::adjacent_find(
+          entries_.begin(), entries_.end(),
+          [this](const Entry& lhs, const Entry& rhs) {
+            return lhs.id != rhs.id && nameOf(lhs) == nameOf(rhs);
+          });
+      if (clash != entries_.end()) {
+        throw BuildException::ambiguousName(nameOf(*clash));
+      }
+    }
+    auto last = std::unique(entries_.rbegin(), entries_.rend(),
+                            [this](const Entry& lhs, const Entry& rhs) {
+                              return nameOf(lhs) == nameOf(rhs);
+                            });
+    entries_.erase(entries_.begin(), last.base());
+  }
+
+  [[nodiscard]] auto find(std::string_view name) const
+      -> std::optional<size_t> {
+    return idOf(lookup(name));
+  }
+
+  // Looks up prefix + name without building the joined string.
+  [[nodiscard]] auto find(std::string_view prefix, std::string_view name) const
+      -> std::optional<size_t> {
+    return idOf(lookup(prefix, name));
+  }
+
+  // Same as find, returning the whole entry or nullptr.
+  [[nodiscard]] auto lookup(std::string_view name) const -> const Entry* {
+    if (policy_ == MatchPolicy::IgnoreCase) {
+      return search([name](std::string_view entry) {
+        return StringUtils::compareFolded(entry, name);
+      });
+    }
+    return search(
+        [name](std::string_view entry) { return entry.compare(name); });
+  }
+
+  [[nodiscard]] auto lookup(std::string_view prefix,
+                            std::string_view name) const -> const Entry* {
+    if (policy_ == MatchPolicy::IgnoreCase) {
+      return search([prefix, name](std::string_view entry) {
+        return compareJoined(entry, prefix, name, StringUtils::compareFolded);
+      });
+    }
+    return search([prefix, name](std::string_view entry) {
+      return compareJoined(entry, prefix, name,
+                           [](std::string_view lhs, std::string_view rhs) {
+                             return lhs.compare(rhs);
+                           });
+    });
+  }
+
+  // Looks up the name of a "name=value" token and returns it with the
+  // value, or nullptr when there is no '=' or no such name.
+  [[nodiscard]] auto lookupAttached(std::string_view arg) const
+      -> std::pair<const Entry*, std::string_view> {
+    const size_t equals = arg.find('=');
+    if (equals == std::string_view::npos) {
+      return {nullptr, {}};
+    }
+    return {lookup(arg.substr(0, equals)), arg.substr(equals + 1)};
+  }
+
+  [[nodiscard]] auto contains(std::string_view name) const -> bool {
+    return find(name).has_value();
+  }
+
+  [[nodiscard]] auto namesOf(size_t id) const -> std::string {
+    std::string names;
+    for (const auto& entry : entries()) {
+      if (entry.id == id) {
+        names += nameOf(entry);
+        names += ", ";
+      }
+    }
+    return names;
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return entries().size(); }
+
+  [[nodiscard]] auto pool() const -> std::string_view {
+    return external_ ? externalPool_ : std::string_view(pool_);
+  }
+
+  [[nodiscard]] auto entries() const -> std::span<const Entry> {
+    return external_ ? externalEntries_ : std::span<const Entry>(entries_);
+  }
+
+  [[nodiscard]] auto nameOf(const Entry& entry) const -> std::string_view {
+    return pool().substr(entry.offset, entry.length);
+  }
+
+  [[nodiscard]] auto memoryBytes() const -> size_t {
+    return MemoryUtils::stringBytes(pool_) + MemoryUtils::vectorBytes(entries_);
+  }
+
+ private:
+  // Binary search with compare(entry name) returning <0, 0 or >0 like
+  // std::string_view::compare against the key.
+  template <typename Compare>
+  [[nodiscard]] auto search(Compare compare) const -> const Entry* {
+    auto list = entries();
+    auto iter = std::partition_point(
+        list.begin(), list.end(),
+        [this, &compare](const Entry& entry) {
+          return compare(nameOf(entry)) < 0;
+        });
+    if (iter == list.end() || compare(nameOf(*iter)) != 0) {
+      return nullptr;
+    }
+    return &*iter;
+  }
+
+  static auto idOf(const Entry* entry) -> std::optional<size_t> {
+    if (entry == nullptr) {
+      return std::nullopt;
+    }
+    return entry->id;
+  }
+
+  template <typename Compare>
+  static auto compareJoined(std::string_view entry, std::string_view prefix,
+                            std::string_view name, Compare compare) -> int {
+    const auto head = entry.substr(0, prefix.size());
+    if (const int cmp = compare(head, prefix.substr(0, head.size()));
+        cmp != 0) {
+      return cmp;
+    }
+    if (head.size() < prefix.size()) {
+      return -1;
+    }
+    return compare(entry.substr(prefix.size()), name);
+  }
+
+  std::string pool_;
+  std::vector<Entry> entries_;
+  std::string_view externalPool_;
+  std::span<const Entry> externalEntries_;
+  bool external_{false};
+  MatchPolicy policy_{MatchPolicy::Exact};
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_INDEX_HPP
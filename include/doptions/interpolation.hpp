@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "doptions/arena.hpp"
+#include "doptions/exceptions.hpp"
+#include "doptions/memory.hpp"
+#include "doptions/utils.hpp"
+#ifndef DOPTIONS_INTERPOLATION_HPP
+#define DOPTIONS_INTERPOLATION_HPP
+
+namespace doptions {
+
+// Expands ${name} references in the values given to options in one parse.
+// A name resolves to the value another option got in the same parse, or
+// else to the environment variable of that name. "$$" stands for a single
+// '$' and a '$' not followed by '{' or '$' is kept as is.
+//
+// Values are recorded as views while tokenizing and expanded lazily, once
+// all of them are known, so a reference may name an option given later on
+// the command line. Each value is expanded once in a single scan, following
+// references depth first; finding a value that is still being expanded
+// means a cycle. Expanded text is written into an arena that lives until the
+// next parse. Values without references are handed back unchanged.
+class Interpolator {
+ public:
+  // Option id a reference name stands for, if any.
+  using Resolver = FunctionRef<std::optional<size_t>(std::string_view)>;
+
+  // Forgets the previous parse of an application with count options.
+  auto begin(size_t count) -> void {
+    slots_.assign(count, Slot{});
+    pending_.clear();
+    pieces_.clear();
+    arena_.reset();
+  }
+
+  // Records the raw value option id got. Returns whether it has to be
+  // expanded before converting it.
+  auto record(size_t id, std::string_view raw, bool interpolates) -> bool {
+    const bool pending = interpolates && raw.find('$') != raw.npos;
+    slots_.at(id) = {raw, pending ? State::Pending : State::Done};
+    if (pending) {
+      pending_.push_back(id);
+    }
+    return pending;
+  }
+
+  // Copies text that would not outlive the parse otherwise.
+  [[nodiscard]] auto store(std::string_view text) -> std::string_view {
+    return arena_.store(text);
+  }
+
+  // Options recorded as needing expansion, in the order they were given.
+  [[nodiscard]] auto pending() const -> const std::vector<size_t>& {
+    return pending_;
+  }
+
+  // Expanded value of a recorded option.
+  auto expand(size_t id, Resolver resolve) -> std::string_view {
+    auto& slot = slots_.at(id);
+    if (slot.state == State::Done) {
+      return slot.value;
+    }
+    slot.state = State::Expanding;
+    slot.value = substitute(slot.value, resolve);
+    slot.state = State::Done;
+    return slot.value;
+  }
+
+  [[nodiscard]] auto scratchBytes() const -> size_t {
+    return arena_.capacity() + MemoryUtils::vectorBytes(slots_) +
+           MemoryUtils::vectorBytes(pending_) +
+           MemoryUtils::vectorBytes(pieces_);
+  }
+
+ private:
+  enum class State : uint8_t { Unset, Pending, Expanding, Done };
+
+  struct Slot {
+    std::string_view value;
+    State state{State::Unset};
+  };
+
+  auto substitute(std::string_view raw, Resolver resolve) -> std::string_view {
+    // Pieces of nested expansions are pushed above ours and gone again by
+    // the time their reference returns.
+    const size_t base = pieces_.size();
+    size_t literal = 0;
+    bool changed = false;
+    size_t pos = raw.find('$');
+    while (pos != raw.npos && pos + 1 < raw.size()) {
+      const char next = raw[pos + 1];
+      if (next == '$') {
+        pieces_.push_back(raw.substr(literal, pos + 1 - literal));
+        literal = pos + 2;
+        changed = true;
+      } else if (next == '{') {
+        const size_t close = raw.find('}', pos + 2);
+        if (close == raw.npos || close == pos + 2) {
+          throw ParseException::invalidValue(raw);
+        }
+        pieces_.push_back(raw.substr(literal, pos - literal));
+        const auto value = reference(raw.substr(pos + 2, close - pos - 2),
+                                     resolve);
+        pieces_.push_back(value);
+        literal = close + 1;
+        changed = true;
+      } else {
+        pos = raw.find('$', pos + 1);
+        continue;
+      }
+      pos = raw.find('$', literal);
+    }
+    if (!changed) {
+      return raw;
+    }
+    pieces_.push_back(raw.substr(literal));
+    size_t size = 0;
+    for (size_t idx = base; idx < pieces_.size(); ++idx) {
+      size += pieces_[idx].size();
+    }
+    char* out = arena_.allocate(size);
+    std::string_view result(out, size);
+    for (size_t idx = base; idx < pieces_.size(); ++idx) {
+      out = std::copy(pieces_[idx].begin(), pieces_[idx].end(), out);
+    }
+    pieces_.resize(base);
+    return result;
+  }
+
+  auto reference(std::string_view name, Resolver resolve) -> std::string_view {
+    auto id = resolve(name);
+    if (id.has_value() && slots_.at(*id).state != State::Unset) {
+      if (slots_[*id].state == State::Expanding) {
+        throw ParseException::referenceCycle(name);
+      }
+      return expand(*id, resolve);
+    }
+    nameBuffer_.assign(name);
+    if (const char* env = std::getenv(nameBuffer_.c_str())) {
+      return env;
+    }
+    throw ParseException::unresolvedReference(name);
+  }
+
+  Arena arena_;
+  std::vector<Slot> slots_;
+  std::vector<size_t> pending_;
+  std::vector<std::string_view> pieces_;
+  std::string nameBuffer_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_INTERPOLATION_HPP
@@ -0,0 +1,407 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "doptions/exceptions.hpp"
+#include "doptions/utils.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifndef DOPTIONS_JSON_HPP
+#define DOPTIONS_JSON_HPP
+
+namespace doptions {
+
+// Positions of the structural characters of a JSON document: braces,
+// brackets, colons and commas outside strings, plus every unescaped quote.
+// The document is classified 64 bytes at a time into bit masks, using SSE2
+// when available, and strings are tracked with a prefix XOR over the quote
+// mask, so bytes are never inspected one by one.
+class StructuralIndex {
+ public:
+  static auto build(std::string_view json) -> StructuralIndex {
+    StructuralIndex index;
+    index.positions_.reserve(json.size() / 4);
+    bool escapeCarry = false;
+    uint64_t inString = 0;
+    for (size_t offset = 0; offset < json.size(); offset += blockSize) {
+      auto masks = classify(json, offset);
+      const uint64_t escaped = escapedMask(masks.backslash, escapeCarry);
+      const uint64_t quotes = masks.quote & ~escaped;
+      const uint64_t strings = prefixXor(quotes) ^ inString;
+      inString = static_cast<uint64_t>(
+          -static_cast<int64_t>(strings >> (blockSize - 1)));
+      index.append(offset, (masks.structural & ~strings) | quotes);
+    }
+    if (inString != 0) {
+      throw ParseException::invalidValue("unterminated JSON string");
+    }
+    return index;
+  }
+
+  [[nodiscard]] auto positions() const -> const std::vector<uint32_t>& {
+    return positions_;
+  }
+
+ private:
+  static constexpr size_t blockSize = 64;
+
+  struct Masks {
+    uint64_t quote{0};
+    uint64_t backslash{0};
+    uint64_t structural{0};
+  };
+
+  static auto isStructural(char chr) -> bool {
+    return chr == '{' || chr == '}' || chr == '[' || chr == ']' ||
+           chr == ':' || chr == ',';
+  }
+
+  static auto classify(std::string_view json, size_t offset) -> Masks {
+    Masks masks;
+    const size_t count = std::min(blockSize, json.size() - offset);
+#if defined(__SSE2__)
+    if (count == blockSize) {
+      for (size_t lane = 0; lane < blockSize; lane += 16) {
+        const auto* lanePtr = json.data() + offset + lane;
+        const auto chunk = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(lanePtr));  // NOLINT
+        auto matches = [&chunk](char chr) -> uint64_t {
+          return static_cast<uint32_t>(
+              _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(chr))));
+        };
+        masks.quote |= matches('"') << lane;
+        masks.backslash |= matches('\\') << lane;
+        masks.structural |= (matches('{') | matches('}') | matches('[') |
+                             matches(']') | matches(':') | matches(','))
+                            << lane;
+      }
+      return masks;
+    }
+#endif
+    for (size_t idx = 0; idx < count; ++idx) {
+      const char chr = json[offset + idx];
+      const uint64_t bit = uint64_t{1} << idx;
+      masks.quote |= chr == '"' ? bit : 0;
+      masks.backslash |= chr == '\\' ? bit : 0;
+      masks.structural |= isStructural(chr) ? bit : 0;
+    }
+    return masks;
+  }
+
+  // Characters preceded by an odd run of backslashes.
+  static auto escapedMask(uint64_t backslash, bool& carry) -> uint64_t {
+    uint64_t escaped = carry ? 1 : 0;
+    carry = false;
+    while (backslash != 0) {
+      const int bit = std::countr_zero(backslash);
+      backslash &= backslash - 1;
+      if (((escaped >> bit) & 1U) != 0) {
+        continue;
+      }
+      if (bit == static_cast<int>(blockSize) - 1) {
+        carry = true;
+      } else {
+        escaped |= uint64_t{1} << (bit + 1);
+      }
+    }
+    return escaped;
+  }
+
+  static auto prefixXor(uint64_t mask) -> uint64_t {
+    mask ^= mask << 1U;
+    mask ^= mask << 2U;
+    mask ^= mask << 4U;
+    mask ^= mask << 8U;
+    mask ^= mask << 16U;
+    mask ^= mask << 32U;
+    return mask;
+  }
+
+  auto append(size_t offset, uint64_t bits) -> void {
+    while (bits != 0) {
+      positions_.push_back(
+          static_cast<uint32_t>(offset + std::countr_zero(bits)));
+      bits &= bits - 1;
+    }
+  }
+
+  std::vector<uint32_t> positions_;
+};
+
+struct JsonValue {
+  enum class Kind : uint8_t { String, Literal, Object, Array };
+
+  Kind kind{Kind::Literal};
+  // Strings exclude their quotes and may still contain escapes; objects and
+  // arrays are the raw text including their delimiters.
+  std::string_view text;
+  bool escaped{false};
+};
+
+// Streams the members of the top-level object of a JSON document, using the
+// structural index to jump between tokens.
+class JsonReader {
+ public:
+  using Callback = FunctionRef<void(std::string_view, bool, const JsonValue&)>;
+
+  // Calls back with each key, whether the key has escapes, and its value.
+  static auto forEachMember(std::string_view json, Callback callback)
+      -> void {
+    const auto index = StructuralIndex::build(json);
+    JsonReader reader(json, index.positions());
+    reader.readObject(callback);
+  }
+
+  // Decodes the escapes of a JSON string into out.
+  static auto unescape(std::string_view str, std::string& out) -> void {
+    out.clear();
+    for (size_t idx = 0; idx < str.size(); ++idx) {
+      if (str[idx] != '\\') {
+        out.push_back(str[idx]);
+        continue;
+      }
+      if (++idx == str.size()) {
+        throw ParseException::invalidValue(str);
+      }
+      switch (str[idx]) {
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u':
+          appendCodePoint(str, idx, out);
+          break;
+        case '"':
+        case '\\':
+        case '/':
+          out.push_back(str[idx]);
+          break;
+        default:
+          throw ParseException::invalidValue(str);
+      }
+    }
+  }
+
+ private:
+  JsonReader(std::string_view json, const std::vector<uint32_t>& positions)
+      : json_(json), positions_(positions) {}
+
+  [[nodiscard]] auto peek() const -> char {
+    if (next_ >= positions_.size()) {
+      throw ParseException::invalidValue("unexpected end of JSON");
+    }
+    return json_[positions_[next_]];
+  }
+
+  auto expect(char chr) -> size_t {
+    if (peek() != chr) {
+      throw ParseException::invalidValue(json_.substr(positions_[next_], 1));
+    }
+    return positions_[next_++];
+  }
+
+  auto readString() -> std::pair<std::string_view, bool> {
+    const size_t open = expect('"');
+    const size_t close = expect('"');
+    auto str = json_.substr(open + 1, close - open - 1);
+    return {str, str.find('\\') != std::string_view::npos};
+  }
+
+  auto readObject(Callback callback) -> void {
+    const size_t open = expect('{');
+    if (!StringUtils::trim(json_.substr(0, open)).empty()) {
+      throw ParseException::invalidValue("JSON document must be an object");
+    }
+    if (peek() == '}') {
+      expectBlank(open + 1);
+      ++next_;
+    } else {
+      while (true) {
+        expectBlank(positions_[next_ - 1] + 1);
+        auto [key, keyEscaped] = readString();
+        expectBlank(positions_[next_ - 1] + 1);
+        const size_t colon = expect(':');
+        auto value = readValue(colon);
+        callback(key, keyEscaped, value);
+        if (peek() == ',') {
+          ++next_;
+          continue;
+        }
+        expect('}');
+        break;
+      }
+    }
+    const size_t close = positions_[next_ - 1];
+    if (next_ != positions_.size() ||
+        !StringUtils::trim(json_.substr(close + 1)).empty()) {
+      throw ParseException::invalidValue("trailing data after JSON object");
+    }
+  }
+
+  // Only whitespace may separate a string, object or array value from the
+  // tokens around it, up to the next structural character.
+  auto expectBlank(size_t from) const -> void {
+    const size_t to =
+        next_ < positions_.size() ? positions_[next_] : json_.size();
+    auto gap = StringUtils::trim(json_.substr(from, to - from));
+    if (!gap.empty()) {
+      throw ParseException::invalidValue(gap);
+    }
+  }
+
+  auto readValue(size_t colon) -> JsonValue {
+    const char chr = peek();
+    if (chr == '"') {
+      expectBlank(colon + 1);
+      auto [str, escaped] = readString();
+      expectBlank(positions_[next_ - 1] + 1);
+      return {JsonValue::Kind::String, str, escaped};
+    }
+    if (chr == '{' || chr == '[') {
+      const size_t open = positions_[next_];
+      expectBlank(colon + 1);
+      // Closing brackets expected, innermost last.
+      std::string closers;
+      do {
+        const char token = peek();
+        if (token == '{' || token == '[') {
+          closers.push_back(token == '{' ? '}' : ']');
+        } else if (token == '}' || token == ']') {
+          if (closers.back() != token) {
+            throw ParseException::invalidValue(
+                json_.substr(positions_[next_], 1));
+          }
+          closers.pop_back();
+        }
+        ++next_;
+      } while (!closers.empty());
+      const size_t close = positions_[next_ - 1];
+      expectBlank(close + 1);
+      return {chr == '{' ? JsonValue::Kind::Object : JsonValue::Kind::Array,
+              json_.substr(open, close - open + 1), false};
+    }
+    const size_t end = positions_[next_];
+    auto literal = StringUtils::trim(json_.substr(colon + 1, end - colon - 1));
+    if (literal.empty()) {
+      throw ParseException::invalidValue(json_.substr(colon, 1));
+    }
+    if (!isLiteral(literal)) {
+      throw ParseException::invalidValue(literal);
+    }
+    return {JsonValue::Kind::Literal, literal, false};
+  }
+
+  // true, false, null or a number as the JSON grammar spells it.
+  static auto isLiteral(std::string_view text) -> bool {
+    if (text == "true" || text == "false" || text == "null") {
+      return true;
+    }
+    size_t idx = 0;
+    auto digits = [&text, &idx]() {
+      const size_t start = idx;
+      while (idx < text.size() && text[idx] >= '0' && text[idx] <= '9') {
+        ++idx;
+      }
+      return idx - start;
+    };
+    if (idx < text.size() && text[idx] == '-') {
+      ++idx;
+    }
+    const size_t intStart = idx;
+    const size_t intDigits = digits();
+    if (intDigits == 0 || (intDigits > 1 && text[intStart] == '0')) {
+      return false;
+    }
+    if (idx < text.size() && text[idx] == '.') {
+      ++idx;
+      if (digits() == 0) {
+        return false;
+      }
+    }
+    if (idx < text.size() && (text[idx] == 'e' || text[idx] == 'E')) {
+      ++idx;
+      if (idx < text.size() && (text[idx] == '+' || text[idx] == '-')) {
+        ++idx;
+      }
+      if (digits() == 0) {
+        return false;
+      }
+    }
+    return idx == text.size();
+  }
+
+  static auto hexValue(std::string_view str, size_t pos) -> uint32_t {
+    if (pos + 4 > str.size()) {
+      throw ParseException::invalidValue(str);
+    }
+    uint32_t value = 0;
+    for (size_t idx = pos; idx < pos + 4; ++idx) {
+      const char chr = str[idx];
+      value <<= 4U;
+      if (chr >= '0' && chr <= '9') {
+        value |= static_cast<uint32_t>(chr - '0');
+      } else if (chr >= 'a' && chr <= 'f') {
+        value |= static_cast<uint32_t>(chr - 'a' + 10);
+      } else if (chr >= 'A' && chr <= 'F') {
+        value |= static_cast<uint32_t>(chr - 'A' + 10);
+      } else {
+        throw ParseException::invalidValue(str);
+      }
+    }
+    return value;
+  }
+
+  static auto appendCodePoint(std::string_view str, size_t& idx,
+                              std::string& out) -> void {
+    uint32_t code = hexValue(str, idx + 1);
+    idx += 4;
+    if (code >= 0xD800 && code <= 0xDBFF && idx + 6 < str.size() &&
+        str[idx + 1] == '\\' && str[idx + 2] == 'u') {
+      const uint32_t low = hexValue(str, idx + 3);
+      if (low >= 0xDC00 && low <= 0xDFFF) {
+        code = 0x10000 + ((code - 0xD800) << 10U) + (low - 0xDC00);
+        idx += 6;
+      }
+    }
+    if (code < 0x80) {
+      out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (code >> 6U)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3FU)));
+    } else if (code < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (code >> 12U)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6U) & 0x3FU)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3FU)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (code >> 18U)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 12U) & 0x3FU)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6U) & 0x3FU)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3FU)));
+    }
+  }
+
+  std::string_view json_;
+  const std::vector<uint32_t>& positions_;
+  size_t next_{0};
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_JSON_HPP
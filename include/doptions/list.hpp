@@ -0,0 +1,534 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "doptions/exceptions.hpp"
+#include "doptions/json.hpp"
+#include "doptions/mapped_file.hpp"
+#include "doptions/memory.hpp"
+#include "doptions/option.hpp"
+#include "doptions/shared_config.hpp"
+#include "doptions/utils.hpp"
+#ifndef DOPTIONS_LIST_HPP
+#define DOPTIONS_LIST_HPP
+
+namespace doptions {
+
+struct ListConversionConfig {
+  char delimiter{','};
+  // Values shorter than this, in bytes, are converted on the calling thread.
+  size_t parallelThreshold{size_t{1} << 20U};
+  // Smallest chunk worth handing to a thread.
+  size_t minChunkBytes{size_t{64} << 10U};
+  // Upper bound on threads, 0 uses std::thread::hardware_concurrency.
+  size_t maxThreads{0};
+};
+
+// Converts delimiter separated values into vectors. Large values are split
+// at delimiter boundaries into chunks that are converted concurrently, each
+// into its own preallocated slice of the output.
+class ListConversions {
+ public:
+  static auto setConfig(const ListConversionConfig& config) -> void {
+    SharedConfig<ListConversionConfig>::set(config);
+  }
+
+  [[nodiscard]] static auto config() -> const ListConversionConfig& {
+    return SharedConfig<ListConversionConfig>::get();
+  }
+
+  // Elements are separated by the configured delimiter and, when lines is
+  // set, also by newlines. The value may be wrapped in brackets, and an empty
+  // value is an empty list. Errors report the position of the element in the
+  // whole list.
+  template <typename T>
+  static auto convert(std::string_view value, bool lines = false)
+      -> std::vector<T> {
+    value = body(value);
+    std::vector<T> out;
+    if (value.empty()) {
+      return out;
+    }
+    const Splitter splitter{config().delimiter, lines};
+    auto chunks = splitChunks(value, splitter);
+
+    ParallelUtils::run(chunks.size(), [&](size_t idx) {
+      auto& chunk = chunks[idx];
+      chunk.count = splitter.count(chunk.text) + (chunk.last ? 1 : 0);
+    });
+    size_t total = 0;
+    for (auto& chunk : chunks) {
+      chunk.first = total;
+      total += chunk.count;
+    }
+    out.resize(total);
+    ParallelUtils::run(chunks.size(), [&](size_t idx) {
+      convertChunk(chunks[idx], splitter, out.data() + chunks[idx].first);
+    });
+
+    for (const auto& chunk : chunks) {
+      if (chunk.error) {
+        throw ParseException::invalidElement(chunk.error->text,
+                                             chunk.first + chunk.error->index);
+      }
+    }
+    return out;
+  }
+
+  // Converts the raw text of a JSON array, as JsonReader hands it over.
+  template <typename T>
+  static auto convertJson(std::string_view array) -> std::vector<T> {
+    std::vector<T> out;
+    forEachJsonElement(array, [&out](std::string_view element,
+                                     size_t position) {
+      try {
+        out.push_back(convertElement<T>(element));
+      } catch (const std::exception&) {
+        throw ParseException::invalidElement(element, position);
+      }
+    });
+    return out;
+  }
+
+  // Calls fn with each element of a JSON array and its position. Strings
+  // are passed without their quotes and with their escapes decoded, in a
+  // buffer that is reused for the next element. Nested arrays and objects
+  // are not list elements.
+  template <typename Fn>
+  static auto forEachJsonElement(std::string_view array, Fn&& fn) -> void {
+    auto rest = body(array);
+    if (rest.empty()) {
+      return;
+    }
+    std::string buffer;
+    for (size_t position = 0;; ++position) {
+      rest = StringUtils::trim(rest);
+      std::string_view element;
+      size_t after = 0;
+      if (!rest.empty() && rest.front() == '"') {
+        bool escaped = false;
+        size_t close = 1;
+        while (close < rest.size() && rest[close] != '"') {
+          if (rest[close] == '\\') {
+            escaped = true;
+            ++close;
+          }
+          ++close;
+        }
+        if (close >= rest.size()) {
+          throw ParseException::invalidElement(rest, position);
+        }
+        element = rest.substr(1, close - 1);
+        if (escaped) {
+          JsonReader::unescape(element, buffer);
+          element = buffer;
+        }
+        after = close + 1;
+      } else {
+        after = std::min(rest.find(','), rest.size());
+        element = StringUtils::trim(rest.substr(0, after));
+        if (element.empty() || element.front() == '[' ||
+            element.front() == '{') {
+          throw ParseException::invalidElement(element, position);
+        }
+      }
+      auto tail = StringUtils::trim(rest.substr(after));
+      if (!tail.empty() && tail.front() != ',') {
+        throw ParseException::invalidElement(rest.substr(0, after), position);
+      }
+      fn(element, position);
+      if (tail.empty()) {
+        return;
+      }
+      rest = tail.substr(1);
+    }
+  }
+
+  // The elements of a value without surrounding whitespace and brackets.
+  static auto body(std::string_view value) -> std::string_view {
+    value = StringUtils::trim(value);
+    if (value.size() >= 2 && value.front() == '[' && value.back() == ']') {
+      value = StringUtils::trim(value.substr(1, value.size() - 2));
+    }
+    return value;
+  }
+
+  // Converts one element, straight from the view where the type allows it.
+  // std::string_view elements refer to the input.
+  template <typename T>
+  static auto convertElement(std::string_view element) -> T {
+    if constexpr (concepts::IsArithmetic<T>) {
+      return fromChars<T>(element);
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+      return element;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      return std::string(element);
+    } else {
+      return fromStr<T>(std::string(element));
+    }
+  }
+
+ private:
+  struct Splitter {
+    char delimiter;
+    bool lines;
+
+    [[nodiscard]] auto next(std::string_view text, size_t from) const
+        -> size_t {
+      if (!lines) {
+        return text.find(delimiter, from);
+      }
+      const char set[] = {delimiter, '\n'};  // NOLINT
+      return text.find_first_of(std::string_view(set, 2), from);
+    }
+
+    [[nodiscard]] auto count(std::string_view text) const -> size_t {
+      size_t count = static_cast<size_t>(
+          std::count(text.begin(), text.end(), delimiter));
+      if (lines && delimiter != '\n') {
+        count +=
+            static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+      }
+      return count;
+    }
+  };
+
+  struct ChunkError {
+    size_t index;
+    std::string text;
+  };
+
+  struct Chunk {
+    explicit Chunk(std::string_view chunkText) : text(chunkText) {}
+
+    // Every chunk but the last ends right after a delimiter.
+    std::string_view text;
+    bool last{false};
+    size_t count{0};
+    size_t first{0};
+    std::optional<ChunkError> error;
+  };
+
+  static auto threadCount(size_t bytes) -> size_t {
+    const auto& options = config();
+    if (bytes < options.parallelThreshold) {
+      return 1;
+    }
+    return ParallelUtils::threadCount(bytes, options.minChunkBytes,
+                                      options.maxThreads);
+  }
+
+  static auto splitChunks(std::string_view value, const Splitter& splitter)
+      -> std::vector<Chunk> {
+    const size_t count = threadCount(value.size());
+    std::vector<Chunk> chunks;
+    chunks.reserve(count);
+    size_t begin = 0;
+    for (size_t idx = 1; idx < count && begin < value.size(); ++idx) {
+      const size_t target = std::max(begin, value.size() * idx / count);
+      const size_t split = splitter.next(value, target);
+      if (split == std::string_view::npos) {
+        break;
+      }
+      chunks.push_back(Chunk{value.substr(begin, split + 1 - begin)});
+      begin = split + 1;
+    }
+    Chunk last{value.substr(begin)};
+    last.last = true;
+    chunks.push_back(std::move(last));
+    return chunks;
+  }
+
+  template <typename T>
+  static auto convertChunk(Chunk& chunk, const Splitter& splitter, T* out)
+      -> void {
+    size_t begin = 0;
+    for (size_t idx = 0; idx < chunk.count; ++idx) {
+      size_t end = splitter.next(chunk.text, begin);
+      if (end == std::string_view::npos) {
+        end = chunk.text.size();
+      }
+      auto element = StringUtils::trim(chunk.text.substr(begin, end - begin));
+      try {
+        if (element.empty()) {
+          throw ParseException::invalidValue(element);
+        }
+        out[idx] = convertElement<T>(element);  // NOLINT
+      } catch (...) {
+        chunk.error = ChunkError{idx, std::string(element)};
+        return;
+      }
+      begin = end + 1;
+    }
+  }
+};
+
+// Lazy range over the elements of a list value. Each element is decoded
+// when the iterator reaches it, so iterating allocates nothing for
+// arithmetic and std::string_view elements. Accepts the same values as
+// ListConversions::convert; errors carry the element position.
+template <typename T>
+class ListView {
+ public:
+  class Iterator {
+   public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+
+    auto operator*() const -> const T& { return current_; }
+
+    auto operator++() -> Iterator& {
+      advance();
+      return *this;
+    }
+
+    auto operator++(int) -> void { advance(); }
+
+    friend auto operator==(const Iterator& iter, std::default_sentinel_t)
+        -> bool {
+      return iter.done_;
+    }
+
+    // Position of the current element in the list.
+    [[nodiscard]] auto position() const -> size_t { return position_ - 1; }
+
+   private:
+    friend class ListView;
+
+    Iterator(std::string_view rest, char delimiter, bool lines)
+        : rest_(rest), delimiter_(delimiter), lines_(lines) {
+      done_ = rest_.data() == nullptr;
+      advance();
+    }
+
+    auto advance() -> void {
+      if (rest_.data() == nullptr) {
+        done_ = true;
+        return;
+      }
+      const char set[] = {delimiter_, '\n'};  // NOLINT
+      size_t end = rest_.find_first_of(std::string_view(set, lines_ ? 2 : 1));
+      if (end == std::string_view::npos) {
+        end = rest_.size();
+      }
+      auto element = StringUtils::trim(rest_.substr(0, end));
+      rest_ = end < rest_.size() ? rest_.substr(end + 1) : std::string_view();
+      try {
+        if (element.empty()) {
+          throw ParseException::invalidValue(element);
+        }
+        current_ = ListConversions::convertElement<T>(element);
+      } catch (const std::exception&) {
+        throw ParseException::invalidElement(element, position_);
+      }
+      ++position_;
+    }
+
+    std::string_view rest_;
+    char delimiter_{','};
+    bool lines_{false};
+    bool done_{true};
+    size_t position_{0};
+    T current_{};
+  };
+
+  explicit ListView(std::string_view value, bool lines = false)
+      : body_(ListConversions::body(value)), lines_(lines) {}
+
+  // Decodes the first element, which may throw.
+  [[nodiscard]] auto begin() const -> Iterator {
+    if (body_.empty()) {
+      return {};
+    }
+    return {body_, ListConversions::config().delimiter, lines_};
+  }
+
+  [[nodiscard]] auto end() const -> std::default_sentinel_t { return {}; }
+
+ private:
+  std::string_view body_;
+  bool lines_;
+};
+
+namespace concepts {
+// Element types ListOption converts.
+template <typename T>
+concept IsListElement = HasFromStr<T> && !std::is_same_v<T, bool>;
+}  // namespace concepts
+
+// Option bound to a std::vector<T>. The value is a delimiter separated list,
+// optionally in brackets, or @path to read the elements from a file, where
+// newlines also separate elements.
+template <typename T>
+  requires(concepts::IsListElement<T>)
+class ListOption : public OptionBase {
+ public:
+  static auto createOption(const std::string& name, std::vector<T>* var)
+      -> std::unique_ptr<ListOption> {
+    auto [shortName, longName] = makeNames(name);
+    std::unique_ptr<ListOption> opt(new ListOption());
+    opt->shortName_ = std::move(shortName);
+    opt->longName_ = std::move(longName);
+    opt->value_ = var;
+    if (var != nullptr) {
+      opt->default_ = *var;
+    }
+    return opt;
+  }
+
+  [[nodiscard]] auto needsValue() const -> bool override { return true; }
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return shortName_;
+  }
+
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return longName_;
+  }
+
+  auto parseValue(const std::string& str) -> void override { parseView(str); }
+
+  [[nodiscard]] auto readsAtFiles() const -> bool override { return true; }
+
+  auto parseView(std::string_view str) -> void override {
+    if (str.starts_with('@')) {
+      auto file = MappedFile::open(std::string(str.substr(1)));
+      *value_ = ListConversions::convert<T>(file.view(), true);
+      return;
+    }
+    *value_ = ListConversions::convert<T>(str);
+  }
+
+  auto parseJsonArray(std::string_view json) -> void override {
+    *value_ = ListConversions::convertJson<T>(json);
+  }
+
+  auto reset() -> void override {
+    if (default_.has_value()) {
+      *value_ = *default_;
+    }
+  }
+
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage override {
+    MemoryUsage usage;
+    usage.options = sizeof(ListOption);
+    if (default_.has_value()) {
+      usage.options += elementBytes(*default_);
+    }
+    usage.names = MemoryUtils::stringBytes(shortName_) +
+                  MemoryUtils::stringBytes(longName_);
+    if (value_ != nullptr) {
+      usage.boundValues = elementBytes(*value_);
+    }
+    return usage;
+  }
+
+ private:
+  ListOption() = default;
+
+  static auto elementBytes(const std::vector<T>& values) -> size_t {
+    size_t bytes = MemoryUtils::vectorBytes(values);
+    for (const auto& value : values) {
+      bytes += MemoryUtils::heapBytes(value);
+    }
+    return bytes;
+  }
+
+  std::string shortName_;
+  std::string longName_;
+  std::vector<T>* value_{nullptr};
+  std::optional<std::vector<T>> default_;
+};
+
+// List option that hands every element to a callback as it is decoded,
+// without building a container. Values are read as by ListOption, including
+// @path, whose file is mapped only while the elements are delivered. The
+// callback must outlive the option.
+template <typename T>
+class StreamOption : public OptionBase {
+ public:
+  using Callback = FunctionRef<void(const T&)>;
+
+  static auto createOption(const std::string& name, Callback callback)
+      -> std::unique_ptr<StreamOption> {
+    auto [shortName, longName] = makeNames(name);
+    std::unique_ptr<StreamOption> opt(new StreamOption(callback));
+    opt->shortName_ = std::move(shortName);
+    opt->longName_ = std::move(longName);
+    return opt;
+  }
+
+  [[nodiscard]] auto needsValue() const -> bool override { return true; }
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return shortName_;
+  }
+
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return longName_;
+  }
+
+  auto parseValue(const std::string& str) -> void override { parseView(str); }
+
+  [[nodiscard]] auto readsAtFiles() const -> bool override { return true; }
+
+  auto parseView(std::string_view str) -> void override {
+    if (str.starts_with('@')) {
+      auto file = MappedFile::open(std::string(str.substr(1)));
+      deliver(ListView<T>(file.view(), true));
+      return;
+    }
+    deliver(ListView<T>(str));
+  }
+
+  auto parseJsonArray(std::string_view json) -> void override {
+    ListConversions::forEachJsonElement(
+        json, [this](std::string_view element, size_t position) {
+          T value{};
+          try {
+            value = ListConversions::convertElement<T>(element);
+          } catch (const std::exception&) {
+            throw ParseException::invalidElement(element, position);
+          }
+          callback_(value);
+        });
+  }
+
+  // Elements already delivered cannot be taken back.
+  auto reset() -> void override {}
+
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage override {
+    MemoryUsage usage;
+    usage.options = sizeof(StreamOption);
+    usage.names = MemoryUtils::stringBytes(shortName_) +
+                  MemoryUtils::stringBytes(longName_);
+    return usage;
+  }
+
+ private:
+  explicit StreamOption(Callback callback) : callback_(callback) {}
+
+  auto deliver(const ListView<T>& view) -> void {
+    for (const auto& element : view) {
+      callback_(element);
+    }
+  }
+
+  std::string shortName_;
+  std::string longName_;
+  Callback callback_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_LIST_HPP
@@ -0,0 +1,138 @@
+#pragma once
+#ifndef DOPTIONS_HAS_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define DOPTIONS_HAS_MMAP 1
+#else
+#define DOPTIONS_HAS_MMAP 0
+#endif
+#endif
+#if DOPTIONS_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <ios>
+#include <memory>
+#endif
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#ifndef DOPTIONS_MAPPED_FILE_HPP
+#define DOPTIONS_MAPPED_FILE_HPP
+
+namespace doptions {
+
+// Read-only memory mapping of a whole file. Where mmap is not available
+// the file is read into memory owned by the object instead.
+class MappedFile {
+ public:
+#if DOPTIONS_HAS_MMAP
+  static auto open(const std::string& path) -> MappedFile {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), path);
+    }
+    MappedFile file;
+    file.size_ = static_cast<size_t>(info.st_size);
+    if (file.size_ > 0) {
+      void* data =
+          ::mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {  // NOLINT
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+      }
+      file.data_ = static_cast<const char*>(data);
+    }
+    ::close(fd);
+    return file;
+  }
+#else
+  static auto open(const std::string& path) -> MappedFile {
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    if (!input) {
+      throw std::system_error(
+          std::make_error_code(std::errc::no_such_file_or_directory), path);
+    }
+    MappedFile file;
+    file.size_ = static_cast<size_t>(input.tellg());
+    if (file.size_ > 0) {
+      file.owned_ = std::make_unique<char[]>(file.size_);
+      input.seekg(0);
+      if (!input.read(file.owned_.get(),
+                      static_cast<std::streamsize>(file.size_))) {
+        throw std::system_error(std::make_error_code(std::errc::io_error),
+                                path);
+      }
+      file.data_ = file.owned_.get();
+    }
+    return file;
+  }
+#endif
+
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+  MappedFile(MappedFile&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {
+#if !DOPTIONS_HAS_MMAP
+    owned_ = std::move(other.owned_);
+#endif
+  }
+
+  auto operator=(MappedFile&& other) noexcept -> MappedFile& {
+    if (this != &other) {
+      unmap();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+#if !DOPTIONS_HAS_MMAP
+      owned_ = std::move(other.owned_);
+#endif
+    }
+    return *this;
+  }
+
+  ~MappedFile() { unmap(); }
+
+  [[nodiscard]] auto data() const -> const char* { return data_; }
+
+  [[nodiscard]] auto size() const -> size_t { return size_; }
+
+  [[nodiscard]] auto view() const -> std::string_view { return {data_, size_}; }
+
+ private:
+  auto unmap() -> void {
+#if DOPTIONS_HAS_MMAP
+    if (data_ != nullptr) {
+      ::munmap(const_cast<char*>(data_), size_);  // NOLINT
+    }
+#else
+    owned_.reset();
+#endif
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  const char* data_{nullptr};
+  size_t size_{0};
+#if !DOPTIONS_HAS_MMAP
+  std::unique_ptr<char[]> owned_;  // NOLINT
+#endif
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_MAPPED_FILE_HPP
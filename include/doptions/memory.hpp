@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <vector>
+#ifndef DOPTIONS_MEMORY_HPP
+#define DOPTIONS_MEMORY_HPP
+
+namespace doptions {
+
+// Bytes requested from the allocator, split by what owns them. Allocator
+// bookkeeping and alignment padding are not included. Contiguous storage is
+// counted exactly; the nodes of std::map are estimated with
+// MemoryUtils::treeNodeOverhead.
+struct MemoryUsage {
+  size_t options{0};
+  size_t names{0};
+  size_t lookupTables{0};
+  size_t commands{0};
+  size_t scratch{0};
+  size_t boundValues{0};
+  // The schema arena of Application::createApp with StorageConfig::arena
+  // and its blocks, which hold the options placed in it.
+  size_t arena{0};
+
+  [[nodiscard]] auto total() const -> size_t {
+    return options + names + lookupTables + commands + scratch + boundValues +
+           arena;
+  }
+
+  auto operator+=(const MemoryUsage& other) -> MemoryUsage& {
+    options += other.options;
+    names += other.names;
+    lookupTables += other.lookupTables;
+    commands += other.commands;
+    scratch += other.scratch;
+    boundValues += other.boundValues;
+    arena += other.arena;
+    return *this;
+  }
+};
+
+// Memory resource forwarding to upstream and keeping count of the bytes it
+// currently holds from it, such as the blocks of a pool resource.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  explicit CountingResource(
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream) {}
+
+  [[nodiscard]] auto bytes() const -> size_t { return bytes_; }
+
+ private:
+  auto do_allocate(size_t bytes, size_t alignment) -> void* override {
+    void* ptr = upstream_->allocate(bytes, alignment);
+    bytes_ += bytes;
+    return ptr;
+  }
+
+  auto do_deallocate(void* ptr, size_t bytes, size_t alignment)
+      -> void override {
+    upstream_->deallocate(ptr, bytes, alignment);
+    bytes_ -= bytes;
+  }
+
+  [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other)
+      const noexcept -> bool override {
+    return this == &other;
+  }
+
+  std::pmr::memory_resource* upstream_;
+  size_t bytes_{0};
+};
+
+class MemoryUtils {
+ public:
+  // Node-based containers of libstdc++ and libc++ store a color word and
+  // three pointers next to each value.
+  static constexpr size_t treeNodeOverhead = 4 * sizeof(void*);
+
+  static auto stringBytes(const std::string& str) -> size_t {
+    const auto* begin = reinterpret_cast<const char*>(&str);  // NOLINT
+    const char* data = str.data();
+    if (data >= begin && data < begin + sizeof(std::string)) {  // NOLINT
+      return 0;
+    }
+    return str.capacity() + 1;
+  }
+
+  template <typename T>
+  static auto vectorBytes(const std::vector<T>& vec) -> size_t {
+    return vec.capacity() * sizeof(T);
+  }
+
+  template <typename K, typename V, typename C>
+  static auto mapBytes(const std::map<K, V, C>& map) -> size_t {
+    size_t bytes = map.size() * (sizeof(std::pair<const K, V>) +
+                                 treeNodeOverhead);
+    for (const auto& [key, value] : map) {
+      bytes += heapBytes(key) + heapBytes(value);
+    }
+    return bytes;
+  }
+
+  // Heap storage owned by a value. Strings and contiguous containers are
+  // measured by capacity; other types are assumed to own no heap memory.
+  template <typename T>
+  static auto heapBytes(const T& value) -> size_t {
+    if constexpr (std::is_same_v<T, std::string>) {
+      return stringBytes(value);
+    } else if constexpr (requires {
+                           value.capacity();
+                           value.data();
+                           typename T::value_type;
+                         }) {
+      size_t bytes = value.capacity() * sizeof(typename T::value_type);
+      for (const auto& item : value) {
+        bytes += heapBytes(item);
+      }
+      return bytes;
+    } else {
+      return 0;
+    }
+  }
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_MEMORY_HPP
@@ -1,10 +1,20 @@
 #pragma once
+#include <charconv>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+#include <vector>
+#include "doptions/convert_context.hpp"
 #include "doptions/exceptions.hpp"
+#include "doptions/memory.hpp"
 #include "doptions/utils.hpp"
 #include "doptions/validations.hpp"
 #ifndef DOPTIONS_OPTION_HPiP
@@ -55,6 +65,36 @@ inline auto fromStr<std::string>(const std::string& str) -> std::string {
   return str;
 }
 
+// Converts a value straight from a view of the input, without a temporary
+// string. The whole view must be consumed.
+template <concepts::IsArithmetic T>
+inline auto fromChars(std::string_view str) -> T {
+  if constexpr (std::is_same_v<T, bool>) {
+    if (str != "true" && str != "false") {
+      throw ParseException::invalidValue(str);
+    }
+    return str == "true";
+  } else {
+    using Wide = std::conditional_t<
+        std::is_floating_point_v<T>, T,
+        std::conditional_t<concepts::IsSignedInteger<T>, int64_t, uint64_t>>;
+    Wide value{};
+    auto [end, error] =
+        std::from_chars(str.data(), str.data() + str.size(), value);
+    // Includes values too large for the 64-bit intermediate.
+    if (error != std::errc() || end != str.data() + str.size()) {
+      throw ParseException::invalidValue(str);
+    }
+    if constexpr (!std::is_floating_point_v<T>) {
+      auto [min, max] = NumberUtils::getLimits<T>();
+      if (value < min || value > max) {
+        throw ParseException::outOfRange<T>(value);
+      }
+    }
+    return static_cast<T>(value);
+  }
+}
+
 //NOLINTNEXTLINE
 #define REGISTER_TYPE(Type)                                         \
   template <>                                                       \
@@ -62,6 +102,36 @@ inline auto fromStr<std::string>(const std::string& str) -> std::string {
   template <>                                                       \
   auto doptions::fromStr<Type>(const std::string& str) -> Type
 
+template <typename V>
+inline auto fromStr(std::string_view, ConvertContext&) -> V;
+
+// Same as REGISTER_TYPE for a converter that also receives a
+// ConvertContext, to place the contents of the value in an arena and report
+// errors without throwing.
+//NOLINTNEXTLINE
+#define REGISTER_CONTEXT_TYPE(Type)                                        \
+  template <>                                                              \
+  struct doptions::concepts::HasFromStrT<Type> : std::true_type {};        \
+  template <>                                                              \
+  struct doptions::concepts::HasContextFromStrT<Type> : std::true_type {}; \
+  template <>                                                              \
+  auto doptions::fromStr<Type>(std::string_view str,                       \
+                               doptions::ConvertContext & context) -> Type
+
+// A value converted once ahead of time for one option, see
+// OptionBase::convertPreset.
+class PresetValue {
+ public:
+  PresetValue() = default;
+  PresetValue(const PresetValue&) = delete;
+  PresetValue(PresetValue&&) = delete;
+  auto operator=(const PresetValue&) -> PresetValue& = delete;
+  auto operator=(PresetValue&&) -> PresetValue& = delete;
+  virtual ~PresetValue() = default;
+  // Stores the value into the bound variable.
+  virtual auto apply() -> void = 0;
+};
+
 class OptionBase {
  public:
   OptionBase(const OptionBase&) = default;
@@ -73,51 +143,132 @@ class OptionBase {
   [[nodiscard]] virtual auto longName() const -> const std::string& = 0;
   [[nodiscard]] virtual auto needsValue() const -> bool = 0;
   virtual auto parseValue(const std::string& str) -> void = 0;
+  // Same as parseValue for input that is not held in a string. Options
+  // whose type can convert from a view override it to skip the copy.
+  virtual auto parseView(std::string_view str) -> void {
+    parseValue(std::string(str));
+  }
+  // Converts a JSON array given as its raw text, brackets included. List
+  // options decode the elements; others take the text as parseView does.
+  virtual auto parseJsonArray(std::string_view json) -> void {
+    parseView(json);
+  }
+  // Restores the bound variable to the value it held at registration.
+  // Options that cannot restore it keep whatever the last parse stored.
+  virtual auto reset() -> void {}
+  // Options that know their full size and the heap they own override it;
+  // by default only the base object and the names are counted.
+  [[nodiscard]] virtual auto memoryUsage() const -> MemoryUsage {
+    MemoryUsage usage;
+    usage.options = sizeof(OptionBase);
+    usage.names = MemoryUtils::stringBytes(shortName()) +
+                  MemoryUtils::stringBytes(longName());
+    return usage;
+  }
+  // Converts str for storing it later, possibly many times, without
+  // converting again. Options that cannot hold a converted value keep the
+  // text and go through parseValue on every apply.
+  [[nodiscard]] virtual auto convertPreset(const std::string& str)
+      -> std::unique_ptr<PresetValue> {
+    return std::make_unique<TextPreset>(*this, str);
+  }
+  // Whether ${name} references in values of this option are expanded when
+  // the application enables interpolation.
+  [[nodiscard]] virtual auto interpolates() const -> bool { return false; }
+  // Options whose converter takes a ConvertContext. Application converts
+  // them through parseWith, with its own arena.
+  [[nodiscard]] virtual auto takesContext() const -> bool { return false; }
+  virtual auto parseWith(std::string_view str, ConvertContext& /*context*/)
+      -> void {
+    parseView(str);
+  }
+  // Frees the arena that parseValue and parseView convert into outside an
+  // application, resetting the bound variable first so it does not refer to
+  // it. Only options whose converter takes a context hold one.
+  virtual auto releaseMemory() -> void {}
+  // Whether a value written as @path is read from the file at path, so a
+  // long value can be handed over as a file instead of an argument.
+  [[nodiscard]] virtual auto readsAtFiles() const -> bool { return false; }
 
- protected:
-  OptionBase() = default;
-};
+  // Another name resolving to this option. A deprecated alias carries the
+  // notice reported the first time it is used.
+  struct Alias {
+    std::string name;
+    std::string notice;
+    bool deprecated{false};
+  };
 
-template <typename V>
-  requires(concepts::HasFromStr<V>)
-class Option : public OptionBase {
- public:
-  static auto createOption(const std::string& name, V* var)
-      -> std::unique_ptr<Option> {
-    auto [shortName, longName] = validateName(name);
-    std::unique_ptr<Option> opt;
-    opt.reset(new Option());
-    opt->shortName_ = std::string(shortName);
-    opt->longName_ = std::string(longName);
-    if (!opt->shortName_.empty()) {
-      opt->shortName_.insert(0, 1, '-');
-    }
-    if (!opt->longName_.empty()) {
-      opt->longName_.insert(0, "--");
-    }
-    opt->value_ = var;
-    if constexpr (std::is_same_v<V, bool>) {
-      opt->needsValue_ = false;
+  [[nodiscard]] auto aliases() const -> const std::vector<Alias>& {
+    return aliases_;
+  }
+
+  [[nodiscard]] auto aliasBytes() const -> size_t {
+    size_t bytes = MemoryUtils::vectorBytes(aliases_);
+    for (const auto& alias : aliases_) {
+      bytes += MemoryUtils::stringBytes(alias.name) +
+               MemoryUtils::stringBytes(alias.notice);
     }
-    return opt;
+    return bytes;
   }
 
-  [[nodiscard]] auto needsValue() const -> bool override { return needsValue_; }
+  // Help text of the option, empty unless set. The text is not copied and
+  // must outlive the option; bindStruct sets it from the field descriptor.
+  [[nodiscard]] auto help() const -> std::string_view { return help_; }
 
-  [[nodiscard]] auto shortName() const -> const std::string& override {
-    return this->shortName_;
-  }
+  auto setHelp(std::string_view help) -> void { help_ = help; }
 
-  [[nodiscard]] auto longName() const -> const std::string& override {
-    return this->longName_;
+  // Validates a "-s,--long" style name and returns both names with their
+  // dash prefixes. A name that was not given is returned empty.
+  static auto makeNames(const std::string& name)
+      -> std::pair<std::string, std::string> {
+    auto [shortView, longView] = validateName(name);
+    std::string shortName(shortView);
+    std::string longName(longView);
+    if (!shortName.empty()) {
+      shortName.insert(0, 1, '-');
+    }
+    if (!longName.empty()) {
+      longName.insert(0, "--");
+    }
+    return {shortName, longName};
   }
 
-  void parseValue(const std::string& str) override {
-    V valV = fromStr<V>(str);
-    *value_ = valV;
-  }
+ protected:
+  OptionBase() = default;
 
  private:
+  friend class Application;
+  friend class Command;
+
+  class TextPreset : public PresetValue {
+   public:
+    TextPreset(OptionBase& option, std::string text)
+        : option_(option), text_(std::move(text)) {}
+
+    auto apply() -> void override { option_.parseValue(text_); }
+
+   private:
+    OptionBase& option_;
+    std::string text_;
+  };
+
+  // Reached through Application::addAlias and Command::addAlias, which also
+  // refresh their lookup index. Takes the same "-s,--long" style names as
+  // registration.
+  auto addAlias(const std::string& name, const std::string& notice,
+                bool deprecated) -> void {
+    auto [shortName, longName] = makeNames(name);
+    for (auto* aliasName : {&shortName, &longName}) {
+      if (!aliasName->empty()) {
+        aliases_.push_back(Alias{std::move(*aliasName), notice, deprecated});
+      }
+    }
+  }
+
+  std::vector<Alias> aliases_;
+  std::string_view help_;
+
+ protected:
   static auto validateName(const std::string& name)
       -> std::pair<std::string_view, std::string_view> {
     if (name.empty()) {
@@ -170,15 +321,187 @@ class Option : public OptionBase {
     }
     return {{}, data};
   };
+};
+
+template <typename V>
+  requires(concepts::HasFromStr<V>)
+class Option : public OptionBase {
+ public:
+  static auto createOption(const std::string& name, V* var)
+      -> std::unique_ptr<Option> {
+    auto [shortName, longName] = makeNames(name);
+    return createPrevalidated(std::move(shortName), std::move(longName), var);
+  }
+
+  // Builds an option from names that already passed validation and carry
+  // their dash prefixes, such as names restored from a compiled schema.
+  static auto createPrevalidated(std::string shortName, std::string longName,
+                                 V* var) -> std::unique_ptr<Option> {
+    std::unique_ptr<Option> opt(new Option());
+    opt->init(std::move(shortName), std::move(longName), var);
+    return opt;
+  }
+
+  // Same as createPrevalidated, constructing the option in storage owned by
+  // the caller, who also destroys it.
+  static auto constructAt(void* storage, std::string shortName,
+                          std::string longName, V* var) -> Option* {
+    auto* opt = new (storage) Option();
+    opt->init(std::move(shortName), std::move(longName), var);
+    return opt;
+  }
+
+  [[nodiscard]] auto needsValue() const -> bool override { return needsValue_; }
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return this->shortName_;
+  }
+
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return this->longName_;
+  }
+
+  void parseValue(const std::string& str) override {
+    if constexpr (concepts::HasContextFromStr<V>) {
+      parseView(str);
+    } else {
+      V valV = fromStr<V>(str);
+      *value_ = valV;
+    }
+  }
+
+  auto parseView(std::string_view str) -> void override {
+    if constexpr (concepts::HasContextFromStr<V>) {
+      ConvertContext context(ownMemory());
+      parseWith(str, context);
+    } else if constexpr (concepts::IsArithmetic<V>) {
+      *value_ = fromChars<V>(str);
+    } else if constexpr (std::is_same_v<V, std::string>) {
+      value_->assign(str);
+    } else {
+      parseValue(std::string(str));
+    }
+  }
+
+  auto reset() -> void override {
+    if (default_.has_value()) {
+      *value_ = *default_;
+    }
+  }
+
+  [[nodiscard]] auto takesContext() const -> bool override {
+    return concepts::HasContextFromStr<V>;
+  }
+
+  // A value with a reported error is not stored.
+  auto parseWith(std::string_view str, ConvertContext& context)
+      -> void override {
+    if constexpr (concepts::HasContextFromStr<V>) {
+      V value = fromStr<V>(str, context);
+      context.errors().check();
+      *value_ = std::move(value);
+    } else {
+      parseView(str);
+    }
+  }
+
+  [[nodiscard]] auto convertPreset(const std::string& str)
+      -> std::unique_ptr<PresetValue> override {
+    if constexpr (concepts::HasContextFromStr<V>) {
+      // Each preset value keeps its own arena, so releaseMemory leaves
+      // presets intact.
+      auto memory = std::make_shared<std::pmr::monotonic_buffer_resource>();
+      ConvertContext context(memory.get());
+      V value = fromStr<V>(str, context);
+      context.errors().check();
+      return std::make_unique<StoredPreset>(value_, std::move(value),
+                                            std::move(memory));
+    } else {
+      return std::make_unique<StoredPreset>(value_, fromStr<V>(str));
+    }
+  }
+
+  [[nodiscard]] auto interpolates() const -> bool override {
+    return std::is_same_v<V, std::string>;
+  }
+
+  auto releaseMemory() -> void override {
+    if constexpr (concepts::HasContextFromStr<V>) {
+      if (memory_ != nullptr) {
+        reset();
+        memory_.reset();
+      }
+    }
+  }
+
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage override {
+    MemoryUsage usage;
+    usage.options = sizeof(Option);
+    if (default_.has_value()) {
+      usage.options += MemoryUtils::heapBytes(*default_);
+    }
+    usage.names = MemoryUtils::stringBytes(shortName_) +
+                  MemoryUtils::stringBytes(longName_);
+    if (value_ != nullptr) {
+      usage.boundValues = MemoryUtils::heapBytes(*value_);
+    }
+    return usage;
+  }
+
+ private:
+  // Arena for values converted outside an application, only held by
+  // options whose converter takes a context.
+  struct NoMemory {};
+  using OwnMemory =
+      std::conditional_t<concepts::HasContextFromStr<V>,
+                         std::shared_ptr<std::pmr::monotonic_buffer_resource>,
+                         NoMemory>;
+
+  class StoredPreset : public PresetValue {
+   public:
+    StoredPreset(V* target, V value, OwnMemory memory = {})
+        : target_(target),
+          memory_(std::move(memory)),
+          value_(std::move(value)) {}
+
+    auto apply() -> void override { *target_ = value_; }
+
+   private:
+    V* target_;
+    // Declared before the value, which may refer to it.
+    [[no_unique_address]] OwnMemory memory_;
+    V value_;
+  };
+
+  auto ownMemory() -> std::pmr::memory_resource* {
+    if (memory_ == nullptr) {
+      memory_ = std::make_shared<std::pmr::monotonic_buffer_resource>();
+    }
+    return memory_.get();
+  }
 
   static const size_t shortNameLimit;
   static const size_t longNameLimit;
 
   Option() = default;
+
+  auto init(std::string shortName, std::string longName, V* var) -> void {
+    shortName_ = std::move(shortName);
+    longName_ = std::move(longName);
+    value_ = var;
+    if (var != nullptr) {
+      default_ = *var;
+    }
+    if constexpr (std::is_same_v<V, bool>) {
+      needsValue_ = false;
+    }
+  }
   bool needsValue_{true};
   std::string shortName_;
   std::string longName_;
   V* value_;
+  std::optional<V> default_;
+  [[no_unique_address]] OwnMemory memory_;
 };
 
 template <typename T>
@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "doptions/exceptions.hpp"
+#include "doptions/memory.hpp"
+#include "doptions/option.hpp"
+#ifndef DOPTIONS_PRESET_HPP
+#define DOPTIONS_PRESET_HPP
+
+namespace doptions {
+
+// Option whose value names one of a set of presets, as in --profile
+// low-latency. Presets are compiled when declared: every setting holds the
+// id of its option and a value converted once, so applying a preset is one
+// store per setting. The option only records the selection;
+// Application applies it once parsing is done.
+class PresetOption : public OptionBase {
+ public:
+  struct Setting {
+    size_t optIdx;
+    std::string text;
+    std::unique_ptr<PresetValue> value;
+  };
+
+  struct Preset {
+    std::string name;
+    std::vector<Setting> settings;
+  };
+
+  static auto createOption(const std::string& name)
+      -> std::unique_ptr<PresetOption> {
+    auto [shortName, longName] = makeNames(name);
+    std::unique_ptr<PresetOption> opt(new PresetOption());
+    opt->shortName_ = std::move(shortName);
+    opt->longName_ = std::move(longName);
+    return opt;
+  }
+
+  [[nodiscard]] auto needsValue() const -> bool override { return true; }
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return shortName_;
+  }
+
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return longName_;
+  }
+
+  auto parseValue(const std::string& str) -> void override { parseView(str); }
+
+  auto parseView(std::string_view str) -> void override {
+    auto iter = std::find_if(
+        presets_.begin(), presets_.end(),
+        [str](const Preset& preset) { return preset.name == str; });
+    if (iter == presets_.end()) {
+      throw ParseException::invalidValue(str);
+    }
+    selected_ = static_cast<size_t>(iter - presets_.begin());
+  }
+
+  auto reset() -> void override { selected_.reset(); }
+
+  // A preset declared again under the same name replaces the first one.
+  auto addPreset(Preset preset) -> void {
+    auto iter = std::find_if(
+        presets_.begin(), presets_.end(),
+        [&preset](const Preset& known) { return known.name == preset.name; });
+    if (iter != presets_.end()) {
+      *iter = std::move(preset);
+      return;
+    }
+    presets_.push_back(std::move(preset));
+  }
+
+  [[nodiscard]] auto presets() const -> const std::vector<Preset>& {
+    return presets_;
+  }
+
+  // The preset chosen by the last parsed value, or nullptr.
+  [[nodiscard]] auto selected() const -> const Preset* {
+    return selected_.has_value() ? &presets_[*selected_] : nullptr;
+  }
+
+  [[nodiscard]] auto memoryUsage() const -> MemoryUsage override {
+    MemoryUsage usage;
+    usage.options = sizeof(PresetOption) + MemoryUtils::vectorBytes(presets_);
+    for (const auto& preset : presets_) {
+      usage.options += MemoryUtils::stringBytes(preset.name) +
+                       MemoryUtils::vectorBytes(preset.settings);
+      for (const auto& setting : preset.settings) {
+        usage.options += MemoryUtils::stringBytes(setting.text);
+      }
+    }
+    usage.names = MemoryUtils::stringBytes(shortName_) +
+                  MemoryUtils::stringBytes(longName_);
+    return usage;
+  }
+
+ private:
+  PresetOption() = default;
+
+  std::string shortName_;
+  std::string longName_;
+  std::vector<Preset> presets_;
+  std::optional<size_t> selected_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_PRESET_HPP
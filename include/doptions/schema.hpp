@@ -0,0 +1,509 @@
+#pragma once
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "doptions/application.hpp"
+#include "doptions/mapped_file.hpp"
+#ifndef DOPTIONS_SCHEMA_HPP
+#define DOPTIONS_SCHEMA_HPP
+
+namespace doptions {
+
+// Application defined at runtime by a schema text. Each line declares one
+// option as "<type> <names> [default]" and a "[name]" line starts a command
+// whose options follow it. Blank lines and lines starting with '#' are
+// ignored. The schema owns the storage of every value.
+//
+//   int32  -p,--port  8080
+//   string --host     localhost
+//   [deploy]
+//   bool   -f,--force
+class Schema {
+ public:
+  using Value = std::variant<bool, int8_t, int16_t, int32_t, int64_t, uint8_t,
+                             uint16_t, uint32_t, uint64_t, float, double,
+                             std::string>;
+
+  static constexpr std::array<std::string_view, std::variant_size_v<Value>>
+      typeNames{"bool",  "int8",   "int16",  "int32",  "int64", "uint8",
+                "uint16", "uint32", "uint64", "float", "double", "string"};
+
+  static auto fromString(std::string_view text) -> Schema {
+    Schema schema;
+    schema.build(parseText(text));
+    return schema;
+  }
+
+  static auto fromFile(const std::string& path) -> Schema {
+    auto file = MappedFile::open(path);
+    return fromString(file.view());
+  }
+
+  // Loads the schema at path through a compiled cache kept in cacheDir and
+  // keyed by the hash of the schema text and of the name validation config
+  // in effect. On a hit the mapped cache provides the validated names and
+  // the lookup index, so names are neither validated nor indexed again. On
+  // a miss the cache is written for the next run; failing to write it is
+  // not an error.
+  static auto load(const std::string& path, const std::string& cacheDir)
+      -> Schema {
+    auto file = MappedFile::open(path);
+    const uint64_t hash =
+        hashConfig(NameValidations::config(), hashText(file.view()));
+    const auto cachePath = cacheFile(cacheDir, hash);
+    {
+      Schema cached;
+      if (cached.loadCache(cachePath, hash)) {
+        return cached;
+      }
+    }
+    Schema schema;
+    schema.build(parseText(file.view()));
+    schema.writeCache(cacheDir, cachePath, hash);
+    return schema;
+  }
+
+  [[nodiscard]] auto app() -> Application& { return app_; }
+
+  [[nodiscard]] auto fromCache() const -> bool { return cache_.size() > 0; }
+
+  template <typename T>
+  [[nodiscard]] auto get(std::string_view name) const -> const T& {
+    return std::get<T>(values_.at(fieldIndex(noCommand, name)));
+  }
+
+  template <typename T>
+  [[nodiscard]] auto get(std::string_view command, std::string_view name) const
+      -> const T& {
+    return std::get<T>(values_.at(fieldIndex(commandIndex(command), name)));
+  }
+
+  [[nodiscard]] auto executed(std::string_view command) const -> bool {
+    return executed_.at(commandIndex(command));
+  }
+
+ private:
+  static constexpr uint32_t noCommand = std::numeric_limits<uint32_t>::max();
+  static constexpr std::array<char, 8> cacheMagic{'D', 'O', 'P', 'T',
+                                                  'I', 'D', 'X', '2'};
+
+  struct Field {
+    uint8_t type{0};
+    std::string shortName;
+    std::string longName;
+    std::optional<std::string> defaultValue;
+    uint32_t command{noCommand};
+  };
+
+  struct Definition {
+    std::vector<Field> fields;
+    std::vector<std::string> commands;
+  };
+
+  // Cache layout: header, fields, commands, option index entries, command
+  // index entries, then the option index pool, the command index pool and
+  // the string pool. Every reference is an offset, so the file can be
+  // mapped anywhere.
+  struct CacheHeader {
+    std::array<char, 8> magic;
+    uint64_t schemaHash;
+    uint32_t fieldCount;
+    uint32_t commandCount;
+    uint32_t optionEntryCount;
+    uint32_t commandEntryCount;
+    uint32_t optionPoolSize;
+    uint32_t commandPoolSize;
+    uint32_t stringPoolSize;
+    uint32_t reserved;
+  };
+
+  struct CacheString {
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  struct CacheField {
+    CacheString shortName;
+    CacheString longName;
+    CacheString defaultValue;
+    uint32_t command;
+    uint8_t type;
+    uint8_t hasDefault;
+    uint16_t reserved;
+  };
+
+  Schema() = default;
+
+  static auto hashText(std::string_view text,
+                       uint64_t hash = 14695981039346656037ULL) -> uint64_t {
+    constexpr uint64_t prime = 1099511628211ULL;
+    for (const char chr : text) {
+      hash ^= static_cast<unsigned char>(chr);
+      hash *= prime;
+    }
+    return hash;
+  }
+
+  // Folds every setting that decides which names are valid into hash. Each
+  // reserved name keeps its terminator so names cannot run together.
+  static auto hashConfig(const NameValidationConfig& config, uint64_t hash)
+      -> uint64_t {
+    const std::array<char, 5> flags{
+        static_cast<char>(config.shortNameLimit),
+        static_cast<char>(config.longNameLimit),
+        static_cast<char>(config.nameContainsDots),
+        static_cast<char>(config.nameContainsDashes),
+        static_cast<char>(config.nameContainsUnderscores)};
+    hash = hashText(std::string_view(flags.data(), flags.size()), hash);
+    for (const auto& name : config.reserverNames) {
+      hash = hashText(std::string_view(name.c_str(), name.size() + 1), hash);
+    }
+    return hash;
+  }
+
+  static auto cacheFile(const std::string& cacheDir, uint64_t hash)
+      -> std::string {
+    constexpr std::string_view digits = "0123456789abcdef";
+    std::string name(16, '0');
+    for (size_t idx = 0; idx < name.size(); ++idx) {
+      name[name.size() - 1 - idx] = digits[(hash >> (idx * 4)) & 0xFU];
+    }
+    return (std::filesystem::path(cacheDir) / (name + ".doptidx")).string();
+  }
+
+  static auto parseText(std::string_view text) -> Definition {
+    Definition definition;
+    uint32_t command = noCommand;
+    while (!text.empty()) {
+      const size_t end = text.find('\n');
+      auto line = StringUtils::trim(text.substr(0, end));
+      text = end == std::string_view::npos ? std::string_view{}
+                                           : text.substr(end + 1);
+      if (line.empty() || line.front() == '#') {
+        continue;
+      }
+      if (line.front() == '[') {
+        if (line.back() != ']') {
+          throw BuildException::invalidSchema(line);
+        }
+        std::string name(StringUtils::trim(line.substr(1, line.size() - 2)));
+        NameValidations::validateName(name);
+        NameValidations::validateSize(name, false);
+        command = static_cast<uint32_t>(definition.commands.size());
+        definition.commands.push_back(std::move(name));
+        continue;
+      }
+      definition.fields.push_back(parseField(line, command));
+    }
+    return definition;
+  }
+
+  static auto parseField(std::string_view line, uint32_t command) -> Field {
+    const size_t typeEnd = line.find_first_of(" \t");
+    if (typeEnd == std::string_view::npos) {
+      throw BuildException::invalidSchema(line);
+    }
+    auto rest = StringUtils::trim(line.substr(typeEnd));
+    const size_t namesEnd = rest.find_first_of(" \t");
+    Field field;
+    field.type = typeOf(line.substr(0, typeEnd), line);
+    auto [shortName, longName] =
+        OptionBase::makeNames(std::string(rest.substr(0, namesEnd)));
+    field.shortName = std::move(shortName);
+    field.longName = std::move(longName);
+    if (namesEnd != std::string_view::npos) {
+      field.defaultValue =
+          std::string(StringUtils::trim(rest.substr(namesEnd)));
+    }
+    field.command = command;
+    return field;
+  }
+
+  static auto typeOf(std::string_view name, std::string_view line)
+      -> uint8_t {
+    for (size_t idx = 0; idx < typeNames.size(); ++idx) {
+      if (typeNames.at(idx) == name) {
+        return static_cast<uint8_t>(idx);
+      }
+    }
+    throw BuildException::invalidSchema(line);
+  }
+
+  static auto makeValue(uint8_t type) -> Value {
+    static constexpr auto factories =
+        []<size_t... I>(std::index_sequence<I...>) {
+          return std::array<Value (*)(), sizeof...(I)>{
+              +[]() -> Value { return Value(std::in_place_index<I>); }...};
+        }(std::make_index_sequence<std::variant_size_v<Value>>());
+    return factories.at(type)();
+  }
+
+  auto build(Definition definition) -> void {
+    for (auto& name : definition.commands) {
+      app_.addCommand(Command::createPrevalidated(name),
+                      &executed_.emplace_back(false));
+    }
+    for (auto& field : definition.fields) {
+      auto& value = values_.emplace_back(makeValue(field.type));
+      auto optPtr = std::visit(
+          [&field](auto& var) -> std::unique_ptr<OptionBase> {
+            using T = std::remove_cvref_t<decltype(var)>;
+            if (field.defaultValue.has_value()) {
+              var = fromStr<T>(*field.defaultValue);
+            }
+            return Option<T>::createPrevalidated(field.shortName,
+                                                 field.longName, &var);
+          },
+          value);
+      if (field.command == noCommand) {
+        app_.addOption(std::move(optPtr));
+      } else {
+        app_.commands_.at(field.command).first->addOption(std::move(optPtr));
+      }
+    }
+    fields_ = std::move(definition.fields);
+    commandNames_ = std::move(definition.commands);
+  }
+
+  template <typename T>
+  static auto viewAt(std::string_view blob, size_t& offset, size_t count)
+      -> std::span<const T> {
+    if (count > (blob.size() - offset) / sizeof(T)) {
+      return {};
+    }
+    const auto* first =
+        reinterpret_cast<const T*>(blob.data() + offset);  // NOLINT
+    offset += count * sizeof(T);
+    return {first, count};
+  }
+
+  static auto stringAt(std::string_view pool, CacheString str)
+      -> std::optional<std::string> {
+    if (str.offset > pool.size() || str.length > pool.size() - str.offset) {
+      return std::nullopt;
+    }
+    return std::string(pool.substr(str.offset, str.length));
+  }
+
+  // Whether cached index entries can be searched as is: every id names one
+  // of idCount registered ids, every name lies inside pool and the names are
+  // strictly ascending. Schemas declare no aliases.
+  static auto validIndex(std::string_view pool,
+                         std::span<const NameIndex::Entry> entries,
+                         size_t idCount) -> bool {
+    std::string_view previous;
+    for (size_t idx = 0; idx < entries.size(); ++idx) {
+      const auto& entry = entries[idx];
+      if (entry.id >= idCount || entry.alias != 0 ||
+          entry.offset > pool.size() ||
+          entry.length > pool.size() - entry.offset) {
+        return false;
+      }
+      const auto name = pool.substr(entry.offset, entry.length);
+      if (idx > 0 && !(previous < name)) {
+        return false;
+      }
+      previous = name;
+    }
+    return true;
+  }
+
+  auto loadCache(const std::string& cachePath, uint64_t hash) -> bool {
+    MappedFile file;
+    try {
+      file = MappedFile::open(cachePath);
+    } catch (const std::system_error&) {
+      return false;
+    }
+    auto blob = file.view();
+    CacheHeader header{};
+    if (blob.size() < sizeof(header)) {
+      return false;
+    }
+    std::memcpy(&header, blob.data(), sizeof(header));
+    if (header.magic != cacheMagic || header.schemaHash != hash) {
+      return false;
+    }
+    size_t offset = sizeof(header);
+    auto fields = viewAt<CacheField>(blob, offset, header.fieldCount);
+    auto commands = viewAt<CacheString>(blob, offset, header.commandCount);
+    auto optionEntries =
+        viewAt<NameIndex::Entry>(blob, offset, header.optionEntryCount);
+    auto commandEntries =
+        viewAt<NameIndex::Entry>(blob, offset, header.commandEntryCount);
+    const size_t poolsSize = size_t{header.optionPoolSize} +
+                             header.commandPoolSize + header.stringPoolSize;
+    if (fields.size() != header.fieldCount ||
+        commands.size() != header.commandCount ||
+        optionEntries.size() != header.optionEntryCount ||
+        commandEntries.size() != header.commandEntryCount ||
+        blob.size() - offset != poolsSize) {
+      return false;
+    }
+    auto optionPool = blob.substr(offset, header.optionPoolSize);
+    auto commandPool =
+        blob.substr(offset + header.optionPoolSize, header.commandPoolSize);
+    auto stringPool = blob.substr(
+        offset + header.optionPoolSize + header.commandPoolSize);
+
+    Definition definition;
+    for (const auto& command : commands) {
+      auto name = stringAt(stringPool, command);
+      if (!name.has_value()) {
+        return false;
+      }
+      definition.commands.push_back(std::move(*name));
+    }
+    for (const auto& cached : fields) {
+      auto shortName = stringAt(stringPool, cached.shortName);
+      auto longName = stringAt(stringPool, cached.longName);
+      auto defaultValue = stringAt(stringPool, cached.defaultValue);
+      if (!shortName || !longName || !defaultValue ||
+          cached.type >= typeNames.size() ||
+          (cached.command != noCommand &&
+           cached.command >= definition.commands.size())) {
+        return false;
+      }
+      Field field;
+      field.type = cached.type;
+      field.shortName = std::move(*shortName);
+      field.longName = std::move(*longName);
+      if (cached.hasDefault != 0) {
+        field.defaultValue = std::move(*defaultValue);
+      }
+      field.command = cached.command;
+      definition.fields.push_back(std::move(field));
+    }
+    const auto optionCount = static_cast<size_t>(std::count_if(
+        definition.fields.begin(), definition.fields.end(),
+        [](const Field& field) { return field.command == noCommand; }));
+    if (!validIndex(optionPool, optionEntries, optionCount) ||
+        !validIndex(commandPool, commandEntries,
+                    definition.commands.size())) {
+      return false;
+    }
+    build(std::move(definition));
+    app_.optionIndex_ = NameIndex::fromView(optionPool, optionEntries);
+    app_.commandIndex_ = NameIndex::fromView(commandPool, commandEntries);
+    app_.indexDirty_ = false;
+    cache_ = std::move(file);
+    return true;
+  }
+
+  auto writeCache(const std::string& cacheDir, const std::string& cachePath,
+                  uint64_t hash) -> void {
+    app_.buildIndex();
+    const auto& optionIndex = app_.optionIndex_;
+    const auto& commandIndex = app_.commandIndex_;
+
+    std::string strings;
+    auto addString = [&strings](std::string_view str) -> CacheString {
+      CacheString ref{static_cast<uint32_t>(strings.size()),
+                      static_cast<uint32_t>(str.size())};
+      strings.append(str);
+      return ref;
+    };
+    std::vector<CacheString> commands;
+    for (const auto& name : commandNames_) {
+      commands.push_back(addString(name));
+    }
+    std::vector<CacheField> fields;
+    for (const auto& field : fields_) {
+      CacheField cached{};
+      cached.shortName = addString(field.shortName);
+      cached.longName = addString(field.longName);
+      cached.defaultValue = addString(field.defaultValue.value_or(""));
+      cached.command = field.command;
+      cached.type = field.type;
+      cached.hasDefault = field.defaultValue.has_value() ? 1 : 0;
+      fields.push_back(cached);
+    }
+
+    CacheHeader header{};
+    header.magic = cacheMagic;
+    header.schemaHash = hash;
+    header.fieldCount = static_cast<uint32_t>(fields.size());
+    header.commandCount = static_cast<uint32_t>(commands.size());
+    header.optionEntryCount = static_cast<uint32_t>(optionIndex.size());
+    header.commandEntryCount = static_cast<uint32_t>(commandIndex.size());
+    header.optionPoolSize = static_cast<uint32_t>(optionIndex.pool().size());
+    header.commandPoolSize = static_cast<uint32_t>(commandIndex.pool().size());
+    header.stringPoolSize = static_cast<uint32_t>(strings.size());
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDir, error);
+    const auto tempPath = cachePath + "." + std::to_string(::getpid());
+    {
+      std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+      auto write = [&out](const void* data, size_t size) {
+        out.write(static_cast<const char*>(data),
+                  static_cast<std::streamsize>(size));
+      };
+      write(&header, sizeof(header));
+      write(fields.data(), fields.size() * sizeof(CacheField));
+      write(commands.data(), commands.size() * sizeof(CacheString));
+      write(optionIndex.entries().data(),
+            optionIndex.entries().size_bytes());
+      write(commandIndex.entries().data(),
+            commandIndex.entries().size_bytes());
+      write(optionIndex.pool().data(), optionIndex.pool().size());
+      write(commandIndex.pool().data(), commandIndex.pool().size());
+      write(strings.data(), strings.size());
+      if (!out) {
+        std::filesystem::remove(tempPath, error);
+        return;
+      }
+    }
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+      std::filesystem::remove(tempPath, error);
+    }
+  }
+
+  [[nodiscard]] auto commandIndex(std::string_view command) const -> uint32_t {
+    for (size_t idx = 0; idx < commandNames_.size(); ++idx) {
+      if (commandNames_[idx] == command) {
+        return static_cast<uint32_t>(idx);
+      }
+    }
+    throw BuildException::unknownName(command);
+  }
+
+  [[nodiscard]] auto fieldIndex(uint32_t command, std::string_view name) const
+      -> size_t {
+    for (size_t idx = 0; idx < fields_.size(); ++idx) {
+      const auto& field = fields_[idx];
+      if (field.command == command &&
+          (field.shortName == name || field.longName == name)) {
+        return idx;
+      }
+    }
+    throw BuildException::unknownName(name);
+  }
+
+  Application app_ = Application::createApp();
+  std::deque<Value> values_;
+  std::deque<bool> executed_;
+  std::vector<Field> fields_;
+  std::vector<std::string> commandNames_;
+  MappedFile cache_;
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_SCHEMA_HPP
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#ifndef DOPTIONS_SHARED_CONFIG_HPP
+#define DOPTIONS_SHARED_CONFIG_HPP
+
+namespace doptions {
+
+// Process-wide configuration of type Config that is safe to read from many
+// threads while another one replaces it. Every set() publishes a new
+// immutable snapshot and bumps a version. Readers keep the snapshot they saw
+// last in a thread_local and only take the lock when the version moved, so
+// the steady state is a single atomic load of a cache line nobody writes.
+//
+// A reference returned by get() stays valid until the same thread calls
+// get() again after a set().
+template <typename Config>
+class SharedConfig {
+ public:
+  static auto set(const Config& config) -> void {
+    auto next = std::make_shared<const Config>(config);
+    auto& shared = state();
+    const std::lock_guard lock(shared.mutex);
+    shared.current = std::move(next);
+    shared.version.fetch_add(1, std::memory_order_release);
+  }
+
+  [[nodiscard]] static auto get() -> const Config& {
+    thread_local Snapshot snapshot;
+    auto& shared = state();
+    const uint64_t version = shared.version.load(std::memory_order_acquire);
+    if (snapshot.config == nullptr || snapshot.version != version) {
+      const std::lock_guard lock(shared.mutex);
+      snapshot.config = shared.current;
+      snapshot.version = shared.version.load(std::memory_order_relaxed);
+    }
+    return *snapshot.config;
+  }
+
+ private:
+  struct Snapshot {
+    std::shared_ptr<const Config> config;
+    uint64_t version{0};
+  };
+
+  struct State {
+    std::mutex mutex;
+    std::shared_ptr<const Config> current = std::make_shared<const Config>();
+    // On its own cache line so readers never share it with the lock.
+    alignas(64) std::atomic<uint64_t> version{0};
+  };
+
+  // Function-local so options built during static initialization of other
+  // translation units already see the default configuration.
+  static auto state() -> State& {
+    static State shared;
+    return shared;
+  }
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_SHARED_CONFIG_HPP
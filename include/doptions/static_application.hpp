@@ -0,0 +1,269 @@
+#pragma once
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include "doptions/struct_binding.hpp"
+#include "doptions/utils.hpp"
+#ifndef DOPTIONS_STATIC_APPLICATION_HPP
+#define DOPTIONS_STATIC_APPLICATION_HPP
+
+namespace doptions {
+
+// Why a registration or a parse of a StaticApplication failed.
+enum class StaticError : uint8_t {
+  None,
+  UnknownArg,
+  InsufficientValues,
+  MultiArg,
+  InvalidValue,
+  OutOfRange,
+  InvalidName,
+  DuplicateName,
+  CapacityExceeded,
+};
+
+struct StaticResult {
+  StaticError error{StaticError::None};
+  // Argument or name the error refers to.
+  std::string_view text;
+
+  explicit operator bool() const noexcept {
+    return error == StaticError::None;
+  }
+};
+
+namespace concepts {
+// Types StaticApplication converts without allocating. String values are
+// views of the argument they came from.
+template <typename T>
+concept IsStaticValue =
+    IsArithmetic<T> || std::same_as<std::remove_cvref_t<T>, std::string_view>;
+}  // namespace concepts
+
+// Application for targets where the heap is off limits: options and
+// commands live in fixed arrays inside the object, names are views of
+// strings that outlive it (usually literals), only built-in types are
+// converted and nothing throws. Registering and parsing never allocate.
+//
+// Options given after a command belong to it, as with Application. Names
+// follow the rules of the default NameValidationConfig and match exactly.
+template <size_t MaxOptions, size_t MaxCommands = 0>
+class StaticApplication {
+ public:
+  static constexpr auto createApp() noexcept -> StaticApplication {
+    return {};
+  }
+
+  template <typename T>
+    requires(concepts::IsStaticValue<T>)
+  auto addOption(std::string_view name, T* var) noexcept -> StaticResult {
+    return addSlot(name, var, noCommand);
+  }
+
+  auto addCommand(std::string_view name, bool* var) noexcept
+      -> StaticResult {
+    auto names = FieldNames::tryParse(name);
+    if (!names.has_value() || name.starts_with('-') ||
+        names->longName.empty()) {
+      return {StaticError::InvalidName, name};
+    }
+    if (findCommand(name).has_value()) {
+      return {StaticError::DuplicateName, name};
+    }
+    if (commandCount_ == MaxCommands) {
+      return {StaticError::CapacityExceeded, name};
+    }
+    commands_[commandCount_++] = {name, var};
+    return {};
+  }
+
+  // Registers an option of the command registered as command.
+  template <typename T>
+    requires(concepts::IsStaticValue<T>)
+  auto addOption(std::string_view command, std::string_view name,
+                 T* var) noexcept -> StaticResult {
+    auto cmdIdx = findCommand(command);
+    if (!cmdIdx.has_value()) {
+      return {StaticError::UnknownArg, command};
+    }
+    return addSlot(name, var, *cmdIdx);
+  }
+
+  // Stops at the first error, leaving the options converted so far set.
+  auto parse(int32_t argc, char** argv) noexcept -> StaticResult {
+    std::array<bool, MaxOptions> seen{};
+    size_t owner = noCommand;
+    for (int32_t idx = 1; idx < argc; ++idx) {
+      const std::string_view arg = argv[idx];  // NOLINT
+      if (owner == noCommand) {
+        if (auto cmdIdx = findCommand(arg)) {
+          *commands_[*cmdIdx].var = true;
+          owner = *cmdIdx;
+          continue;
+        }
+      }
+      std::optional<std::string_view> attached;
+      auto optIdx = findOption(arg, owner);
+      if (!optIdx.has_value()) {
+        const size_t equals = arg.find('=');
+        if (equals != std::string_view::npos) {
+          optIdx = findOption(arg.substr(0, equals), owner);
+          attached = arg.substr(equals + 1);
+        }
+        if (!optIdx.has_value() || !options_[*optIdx].needsValue) {
+          return {StaticError::UnknownArg, arg};
+        }
+      }
+      auto& slot = options_[*optIdx];
+      if (seen[*optIdx]) {
+        return {StaticError::MultiArg, arg};
+      }
+      seen[*optIdx] = true;
+      std::string_view value = "true";
+      if (attached.has_value()) {
+        value = *attached;
+      } else if (slot.needsValue) {
+        if (idx + 1 >= argc) {
+          return {StaticError::InsufficientValues, arg};
+        }
+        value = argv[++idx];  // NOLINT
+      }
+      if (auto error = slot.convert(slot.var, value);
+          error != StaticError::None) {
+        return {error, value};
+      }
+    }
+    return {};
+  }
+
+  [[nodiscard]] auto optionCount() const noexcept -> size_t {
+    return optionCount_;
+  }
+
+  [[nodiscard]] auto commandCount() const noexcept -> size_t {
+    return commandCount_;
+  }
+
+ private:
+  static constexpr size_t noCommand = MaxCommands;
+
+  using Converter = StaticError (*)(void*, std::string_view) noexcept;
+
+  struct Slot {
+    FieldNames names;
+    void* var{nullptr};
+    Converter convert{nullptr};
+    size_t owner{noCommand};
+    bool needsValue{true};
+  };
+
+  struct CommandSlot {
+    std::string_view name;
+    bool* var{nullptr};
+  };
+
+  constexpr StaticApplication() = default;
+
+  template <typename T>
+  auto addSlot(std::string_view name, T* var, size_t owner) noexcept
+      -> StaticResult {
+    auto names = FieldNames::tryParse(name);
+    if (!names.has_value()) {
+      return {StaticError::InvalidName, name};
+    }
+    for (size_t idx = 0; idx < optionCount_; ++idx) {
+      const auto& slot = options_[idx];
+      if (slot.owner == owner && slot.names.overlaps(*names)) {
+        return {StaticError::DuplicateName, name};
+      }
+    }
+    if (optionCount_ == MaxOptions) {
+      return {StaticError::CapacityExceeded, name};
+    }
+    options_[optionCount_++] = {*names, var, &convert<T>, owner,
+                                !std::is_same_v<T, bool>};
+    return {};
+  }
+
+  template <typename T>
+  static auto convert(void* var, std::string_view text) noexcept
+      -> StaticError {
+    auto& value = *static_cast<T*>(var);
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      value = text;
+    } else if constexpr (std::is_same_v<T, bool>) {
+      value = text == "true";
+    } else {
+      using Wide = std::conditional_t<
+          std::is_floating_point_v<T>, T,
+          std::conditional_t<concepts::IsSignedInteger<T>, int64_t,
+                             uint64_t>>;
+      Wide parsed{};
+      auto [end, error] =
+          std::from_chars(text.data(), text.data() + text.size(), parsed);
+      if (error == std::errc::result_out_of_range) {
+        return StaticError::OutOfRange;
+      }
+      if (error != std::errc() || end != text.data() + text.size()) {
+        return StaticError::InvalidValue;
+      }
+      if constexpr (!std::is_floating_point_v<T>) {
+        if (std::cmp_less(parsed, std::numeric_limits<T>::min()) ||
+            std::cmp_greater(parsed, std::numeric_limits<T>::max())) {
+          return StaticError::OutOfRange;
+        }
+      }
+      value = static_cast<T>(parsed);
+    }
+    return StaticError::None;
+  }
+
+  [[nodiscard]] auto findOption(std::string_view arg, size_t owner) const
+      noexcept -> std::optional<size_t> {
+    std::string_view name;
+    bool isLong = false;
+    if (arg.starts_with("--")) {
+      name = arg.substr(2);
+      isLong = true;
+    } else if (arg.starts_with('-')) {
+      name = arg.substr(1);
+    } else {
+      return std::nullopt;
+    }
+    for (size_t idx = 0; idx < optionCount_; ++idx) {
+      const auto& slot = options_[idx];
+      const auto& slotName =
+          isLong ? slot.names.longName : slot.names.shortName;
+      if (slot.owner == owner && !slotName.empty() && slotName == name) {
+        return idx;
+      }
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] auto findCommand(std::string_view name) const noexcept
+      -> std::optional<size_t> {
+    for (size_t idx = 0; idx < commandCount_; ++idx) {
+      if (commands_[idx].name == name) {
+        return idx;
+      }
+    }
+    return std::nullopt;
+  }
+
+  std::array<Slot, MaxOptions> options_{};
+  std::array<CommandSlot, MaxCommands> commands_{};
+  size_t optionCount_{0};
+  size_t commandCount_{0};
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_STATIC_APPLICATION_HPP
@@ -0,0 +1,279 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "doptions/exceptions.hpp"
+#include "doptions/option.hpp"
+#include "doptions/validations.hpp"
+#ifndef DOPTIONS_STRUCT_BINDING_HPP
+#define DOPTIONS_STRUCT_BINDING_HPP
+
+namespace doptions {
+
+// Short and long name of a field without their dashes, split and checked
+// when the descriptor is compiled. Names follow the rules of the default
+// NameValidationConfig; a name breaking them does not compile. Binding the
+// struct checks them again against the config in effect.
+struct FieldNames {
+  std::string_view shortName;
+  std::string_view longName;
+
+  static consteval auto parse(std::string_view name) -> FieldNames {
+    if (auto names = tryParse(name)) {
+      return *names;
+    }
+    throw BuildException::invalidName(name);
+  }
+
+  // Same as parse at run time, empty for an invalid name.
+  static constexpr auto tryParse(std::string_view name) noexcept
+      -> std::optional<FieldNames> {
+    FieldNames names;
+    const size_t separator = name.find(',');
+    if (separator != std::string_view::npos) {
+      names.shortName = name.substr(0, separator);
+      names.longName = name.substr(separator + 1);
+      if (names.shortName.starts_with('-')) {
+        names.shortName.remove_prefix(1);
+      }
+      if (names.longName.starts_with("--")) {
+        names.longName.remove_prefix(2);
+      }
+      if (!valid(names.shortName, true) || !valid(names.longName, false)) {
+        return std::nullopt;
+      }
+      return names;
+    }
+    bool isShort = name.size() <= defaultShortLimit;
+    if (name.starts_with("--")) {
+      name.remove_prefix(2);
+      isShort = false;
+    } else if (name.starts_with('-')) {
+      name.remove_prefix(1);
+      isShort = true;
+    }
+    if (!valid(name, isShort)) {
+      return std::nullopt;
+    }
+    (isShort ? names.shortName : names.longName) = name;
+    return names;
+  }
+
+  [[nodiscard]] constexpr auto overlaps(const FieldNames& other) const
+      -> bool {
+    auto same = [](std::string_view lhs, std::string_view rhs) {
+      return !lhs.empty() && lhs == rhs;
+    };
+    return same(shortName, other.shortName) ||
+           same(longName, other.longName);
+  }
+
+ private:
+  static constexpr auto valid(std::string_view name, bool isShort) noexcept
+      -> bool {
+    const size_t min = isShort ? 1 : defaultShortLimit + 1;
+    const size_t max = isShort ? defaultShortLimit : defaultLongLimit;
+    if (name.size() < min || name.size() > max) {
+      return false;
+    }
+    auto alpha = [](char chr) {
+      return (chr >= 'a' && chr <= 'z') || (chr >= 'A' && chr <= 'Z');
+    };
+    if (!alpha(name.front())) {
+      return false;
+    }
+    return std::all_of(name.begin(), name.end(), [&alpha](char chr) {
+      return alpha(chr) || (chr >= '0' && chr <= '9') || chr == '-' ||
+             chr == '_';
+    });
+  }
+};
+
+// One field of a struct bound with Application::bindStruct: where the value
+// lives, its names, the value it starts from and the help text of its
+// option, see OptionBase::help.
+template <typename Config, typename T, typename D>
+struct Field {
+  using Value = T;
+
+  T Config::* member;
+  FieldNames names;
+  D defaultValue;
+  std::string_view help;
+};
+
+template <typename Config, typename T, typename D>
+  requires(concepts::HasFromStr<T> && std::is_constructible_v<T, const D&>)
+consteval auto field(T Config::* member, std::string_view name,
+                     D defaultValue, std::string_view help)
+    -> Field<Config, T, D> {
+  return {member, FieldNames::parse(name), defaultValue, help};
+}
+
+// Specialized next to a struct to describe its options:
+//
+//   template <>
+//   struct doptions::StructFields<ServerConfig> {
+//     static constexpr std::tuple fields{
+//         doptions::field(&ServerConfig::port, "-p,--port", 8080, "Port"),
+//         doptions::field(&ServerConfig::host, "--host", "localhost", "")};
+//   };
+template <typename Config>
+struct StructFields;
+
+template <typename Config>
+concept HasStructFields = requires { StructFields<Config>::fields; };
+
+// Options of a bound struct, all constructed in one flat table inside this
+// object, so binding a struct allocates once whatever its number of fields.
+class BoundStruct {
+ public:
+  BoundStruct() = default;
+  BoundStruct(const BoundStruct&) = delete;
+  BoundStruct(BoundStruct&&) = delete;
+  auto operator=(const BoundStruct&) -> BoundStruct& = delete;
+  auto operator=(BoundStruct&&) -> BoundStruct& = delete;
+  virtual ~BoundStruct() = default;
+
+  [[nodiscard]] virtual auto size() const -> size_t = 0;
+  [[nodiscard]] virtual auto option(size_t idx) -> OptionBase& = 0;
+};
+
+template <typename Config>
+  requires(HasStructFields<Config>)
+class StructBinding : public BoundStruct {
+  using Fields = std::remove_cvref_t<decltype(StructFields<Config>::fields)>;
+  static constexpr size_t count = std::tuple_size_v<Fields>;
+
+  template <size_t I>
+  using OptionAt = Option<typename std::tuple_element_t<I, Fields>::Value>;
+
+  // Offset of every option in the table, each aligned for its type.
+  struct Layout {
+    std::array<size_t, count> offsets{};
+    size_t bytes{0};
+    size_t alignment{alignof(std::max_align_t)};
+  };
+
+  static constexpr auto layout = []<size_t... I>(std::index_sequence<I...>) {
+    constexpr std::array<size_t, count> sizes{sizeof(OptionAt<I>)...};
+    constexpr std::array<size_t, count> alignments{alignof(OptionAt<I>)...};
+    Layout result;
+    for (size_t idx = 0; idx < count; ++idx) {
+      const size_t align = alignments[idx];
+      result.offsets[idx] = (result.bytes + align - 1) / align * align;
+      result.bytes = result.offsets[idx] + sizes[idx];
+      result.alignment = std::max(result.alignment, align);
+    }
+    return result;
+  }(std::make_index_sequence<count>());
+
+  static consteval auto namesUnique() -> bool {
+    constexpr auto& fields = StructFields<Config>::fields;
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+      const std::array<FieldNames, count> names{std::get<I>(fields).names...};
+      for (size_t lhs = 0; lhs < count; ++lhs) {
+        for (size_t rhs = lhs + 1; rhs < count; ++rhs) {
+          if (names[lhs].overlaps(names[rhs])) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }(std::make_index_sequence<count>());
+  }
+
+  static_assert(count > 0, "StructFields must describe at least one field");
+  static_assert(namesUnique(), "Two fields of the struct share a name");
+
+ public:
+  // Assigns every field its default and builds its option. Throws
+  // BuildException, before touching any field, when a name breaks the
+  // NameValidationConfig in effect.
+  explicit StructBinding(Config& config) {
+    std::apply([](const auto&... desc) { (validate(desc.names), ...); },
+               StructFields<Config>::fields);
+    try {
+      constructAll(config, std::make_index_sequence<count>());
+    } catch (...) {
+      destroyAll();
+      throw;
+    }
+  }
+
+  StructBinding(const StructBinding&) = delete;
+  StructBinding(StructBinding&&) = delete;
+  auto operator=(const StructBinding&) -> StructBinding& = delete;
+  auto operator=(StructBinding&&) -> StructBinding& = delete;
+
+  ~StructBinding() override { destroyAll(); }
+
+  [[nodiscard]] auto size() const -> size_t override { return count; }
+
+  [[nodiscard]] auto option(size_t idx) -> OptionBase& override {
+    return *options_.at(idx);
+  }
+
+ private:
+  static auto validate(const FieldNames& names) -> void {
+    if (!names.shortName.empty()) {
+      NameValidations::validateName(names.shortName);
+      NameValidations::validateSize(names.shortName, true);
+    }
+    if (!names.longName.empty()) {
+      NameValidations::validateName(names.longName);
+      NameValidations::validateSize(names.longName, false);
+    }
+  }
+
+  template <size_t... I>
+  auto constructAll(Config& config, std::index_sequence<I...> /*unused*/)
+      -> void {
+    (construct<I>(config), ...);
+  }
+
+  template <size_t I>
+  auto construct(Config& config) -> void {
+    const auto& desc = std::get<I>(StructFields<Config>::fields);
+    using T = typename std::tuple_element_t<I, Fields>::Value;
+    auto& value = config.*desc.member;
+    value = T(desc.defaultValue);
+    std::string shortName;
+    std::string longName;
+    if (!desc.names.shortName.empty()) {
+      shortName.append("-").append(desc.names.shortName);
+    }
+    if (!desc.names.longName.empty()) {
+      longName.append("--").append(desc.names.longName);
+    }
+    options_[I] = OptionAt<I>::constructAt(
+        storage_.data() + layout.offsets[I], std::move(shortName),
+        std::move(longName), &value);
+    options_[I]->setHelp(desc.help);
+  }
+
+  // Last field first, skipping the ones never constructed.
+  auto destroyAll() -> void {
+    for (size_t idx = count; idx-- > 0;) {
+      if (options_[idx] != nullptr) {
+        std::destroy_at(options_[idx]);
+        options_[idx] = nullptr;
+      }
+    }
+  }
+
+  alignas(layout.alignment) std::array<std::byte, layout.bytes> storage_;
+  std::array<OptionBase*, count> options_{};
+};
+
+}  // namespace doptions
+
+#endif  // !DOPTIONS_STRUCT_BINDING_HPP
@@ -1,11 +1,18 @@
 #pragma once
+#include <algorithm>
 #include <cctype>
 #include <concepts>
 #include <cstdint>
+#include <cstring>
+#include <exception>
 #include <limits>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
 #ifndef DOPTIONS_UTILS_HPP
 #define DOPTIONS_UTILS_HPP
 
@@ -34,6 +41,51 @@ class StringUtils {
 
     return str.substr(sIndex, eIndex - sIndex + 1);
   }
+
+  // ASCII lowercase, other bytes unchanged and independent of the locale.
+  static constexpr auto foldCase(char ch) -> char {
+    return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + ('a' - 'A')) : ch;
+  }
+
+  // foldCase on eight bytes at once. Every byte is kept below 0x80 before
+  // the additions so no carry crosses into the next byte.
+  static constexpr auto foldCase(uint64_t word) -> uint64_t {
+    constexpr uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t ascii = word & (ones * 0x7fU);
+    const uint64_t fromA = ascii + ones * (0x80U - 'A');
+    const uint64_t pastZ = ascii + ones * (0x80U - 'Z' - 1);
+    const uint64_t upper = fromA & ~pastZ & ~word & (ones * 0x80U);
+    return word | (upper >> 2U);
+  }
+
+  // Compares an already folded string with key as if key were folded too,
+  // with the same ordering as std::string_view. Keys are read eight bytes
+  // at a time until the first word that differs.
+  static auto compareFolded(std::string_view folded, std::string_view key)
+      -> int {
+    const size_t common = std::min(folded.size(), key.size());
+    size_t idx = 0;
+    for (; idx + sizeof(uint64_t) <= common; idx += sizeof(uint64_t)) {
+      uint64_t lhs = 0;
+      uint64_t rhs = 0;
+      std::memcpy(&lhs, folded.data() + idx, sizeof(lhs));
+      std::memcpy(&rhs, key.data() + idx, sizeof(rhs));
+      if (lhs != foldCase(rhs)) {
+        break;
+      }
+    }
+    for (; idx < common; ++idx) {
+      const auto lhs = static_cast<unsigned char>(folded[idx]);
+      const auto rhs = static_cast<unsigned char>(foldCase(key[idx]));
+      if (lhs != rhs) {
+        return lhs < rhs ? -1 : 1;
+      }
+    }
+    if (folded.size() == key.size()) {
+      return 0;
+    }
+    return folded.size() < key.size() ? -1 : 1;
+  }
 };
 
 namespace concepts {
@@ -74,6 +126,10 @@ concept IsInteger = IsSignedInteger<T> || IsUnsignedInteger<T>;
 template <typename T>
 concept isFloat = std::is_floating_point_v<T>;
 
+template <typename T>
+concept IsArithmetic =
+    IsInteger<T> || isFloat<T> || std::same_as<std::remove_cvref_t<T>, bool>;
+
 template <typename T>
 struct HasFromStrT : std::false_type {};
 
@@ -87,6 +143,13 @@ struct HasFromStrT<std::string> : std::true_type {};
 template <typename V>
 concept HasFromStr = HasFromStrT<V>::value;
 
+// Types whose converter takes a ConvertContext, see REGISTER_CONTEXT_TYPE.
+template <typename T>
+struct HasContextFromStrT : std::false_type {};
+
+template <typename V>
+concept HasContextFromStr = HasContextFromStrT<V>::value;
+
 }  // namespace concepts
 
 class NumberUtils {
@@ -134,6 +197,121 @@ class NumberUtils {
   }
 };
 
+class ParallelUtils {
+ public:
+  // Threads worth using for items units of work, at least minItems each and
+  // at most maxThreads, where 0 stands for std::thread::hardware_concurrency.
+  static auto threadCount(size_t items, size_t minItems, size_t maxThreads)
+      -> size_t {
+    if (maxThreads == 0) {
+      maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    return std::clamp<size_t>(items / std::max<size_t>(minItems, 1), 1,
+                              maxThreads);
+  }
+
+  // Runs work(0..count), each call on its own thread and the first one on
+  // the calling thread. Every thread started is joined before returning,
+  // then the first exception thrown by work is rethrown. When a thread
+  // cannot be started the calling thread skips its own work and rethrows
+  // that failure once the threads already started are joined.
+  template <typename Work>
+  static auto run(size_t count, Work&& work) -> void {
+    if (count == 0) {
+      return;
+    }
+    std::vector<std::exception_ptr> errors(count);
+    auto guarded = [&work, &errors](size_t idx) {
+      try {
+        work(idx);
+      } catch (...) {
+        errors[idx] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> threads;
+    std::exception_ptr startError;
+    try {
+      threads.reserve(count - 1);
+      for (size_t idx = 1; idx < count; ++idx) {
+        threads.emplace_back(guarded, idx);
+      }
+    } catch (...) {
+      startError = std::current_exception();
+    }
+    if (startError == nullptr) {
+      guarded(0);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    if (startError != nullptr) {
+      std::rethrow_exception(startError);
+    }
+    for (const auto& error : errors) {
+      if (error != nullptr) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+};
+
+template <typename Signature>
+class FunctionRef;
+
+// Non-owning, non-allocating reference to a callable. Function pointers and
+// captureless lambdas are stored by value; any other callable must be an
+// lvalue that outlives the reference.
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+ public:
+  using Function = R (*)(Args...);
+
+  template <typename F>
+    requires(std::is_convertible_v<F &&, Function>)
+  FunctionRef(F&& function) noexcept  // NOLINT
+      : callback_(&invokeFunction) {
+    storage_.function = static_cast<Function>(std::forward<F>(function));
+  }
+
+  template <typename F>
+    requires(!std::is_convertible_v<F&, Function> &&
+             !std::is_same_v<std::remove_cvref_t<F>, FunctionRef> &&
+             std::is_invocable_r_v<R, F&, Args...>)
+  FunctionRef(F& callable) noexcept  // NOLINT
+      : callback_(&invokeObject<F>) {
+    storage_.object = const_cast<void*>(  // NOLINT
+        static_cast<const void*>(std::addressof(callable)));
+  }
+
+  template <typename F>
+    requires(!std::is_convertible_v<F &&, Function> &&
+             !std::is_lvalue_reference_v<F> &&
+             !std::is_same_v<std::remove_cvref_t<F>, FunctionRef>)
+  FunctionRef(F&& callable) = delete;
+
+  auto operator()(Args... args) const -> R {
+    return callback_(storage_, std::forward<Args>(args)...);
+  }
+
+ private:
+  union Storage {
+    void* object;
+    Function function;
+  };
+
+  static auto invokeFunction(Storage storage, Args... args) -> R {
+    return storage.function(std::forward<Args>(args)...);
+  }
+
+  template <typename F>
+  static auto invokeObject(Storage storage, Args... args) -> R {
+    return (*static_cast<F*>(storage.object))(std::forward<Args>(args)...);
+  }
+
+  Storage storage_{};
+  R (*callback_)(Storage, Args...);
+};
+
 }  // namespace doptions
 
 #endif  // !DOPTIONS_UTILS_HPP
@@ -4,6 +4,7 @@
 #include <string_view>
 #include <vector>
 #include "exceptions.hpp"
+#include "shared_config.hpp"
 #ifndef DOPTIONS_VALIDATIONS_HPP
 #define DOPTIONS_VALIDATIONS_HPP
 
@@ -28,28 +29,52 @@ static NameValidationConfig defualtConfig = NameValidationConfig{};
 class NameValidations {
  public:
   static auto setConfig(const NameValidationConfig& config) -> void {
-    NameValidations::options = config;
+    SharedConfig<NameValidationConfig>::set(config);
+  }
+
+  [[nodiscard]] static auto config() -> const NameValidationConfig& {
+    return SharedConfig<NameValidationConfig>::get();
   }
 
   static auto validateName(std::string_view name) -> void {
     if (name.empty()) {
       throw BuildException::emptyName("Argument name");
     }
+    const auto& options = config();
     bool first{true};
     for (auto l : name) {
-      if (first && !validChar(l, true)) {
-        throw BuildException::invalidName(std::string(name));
+      if (first && !validChar(l, options, true)) {
+        throw BuildException::invalidName(name);
       }
       if (first) {
         first = false;
       }
-      if (!validChar(l)) {
-        throw BuildException::invalidName(std::string(name));
+      if (!validChar(l, options)) {
+        throw BuildException::invalidName(name);
       }
     }
   }
 
   static auto validChar(const char& ch, bool first = false) -> bool {
+    return validChar(ch, config(), first);
+  }
+
+  static void validateSize(std::string_view name, bool isShort) {
+    const auto& options = config();
+    const size_t size = name.size();
+    if (isShort && (size > options.shortNameLimit || size == 0)) {
+      throw BuildException::invalidSize(name, 0, options.shortNameLimit, true);
+    }
+    if (!isShort && (size <= options.shortNameLimit || size == 0 ||
+                     size > options.longNameLimit)) {
+      throw BuildException::invalidSize(name, options.shortNameLimit,
+                                        options.longNameLimit, false);
+    }
+  }
+
+ private:
+  static auto validChar(const char& ch, const NameValidationConfig& options,
+                        bool first = false) -> bool {
     if (first) {
       return std::isalpha(ch) != 0;
     }
@@ -67,21 +92,6 @@ class NameValidations {
     }
     return false;
   }
-
-  static void validateSize(std::string_view name, bool isShort) {
-    const size_t size = name.size();
-    if (isShort && (size > options.shortNameLimit || size == 0)) {
-      throw BuildException::invalidSize(name, 0, options.shortNameLimit, true);
-    }
-    if (!isShort && (size <= options.shortNameLimit || size == 0 ||
-                     size > options.longNameLimit)) {
-      throw BuildException::invalidSize(name, options.shortNameLimit,
-                                        options.longNameLimit, false);
-    }
-  }
-
- private:
-  inline static NameValidationConfig options = NameValidationConfig();
 };
 
 }  // namespace doptions
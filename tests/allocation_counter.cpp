@@ -0,0 +1,25 @@
+#include "allocation_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<size_t> allocations{0};  // NOLINT
+}  // namespace
+
+auto allocationCount() -> size_t { return allocations.load(); }
+
+auto operator new(size_t size) -> void* {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);  // NOLINT
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+auto operator delete(void* ptr) noexcept -> void { std::free(ptr); }  // NOLINT
+
+auto operator delete(void* ptr, size_t /*size*/) noexcept -> void {
+  std::free(ptr);  // NOLINT
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+
+// Number of allocations made so far through the global operator new, which
+// the test executable replaces so tests can check that a path does not
+// allocate.
+auto allocationCount() -> size_t;
@@ -1,16 +1,32 @@
 #include <gtest/gtest.h>
 #include <doptions/application.hpp>
 #include <doptions/exceptions.hpp>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "allocation_counter.hpp"
 
 // Test fixture for Application tests
 class ApplicationTest : public ::testing::Test {
  protected:
   void SetUp() override {}
 
-  void TearDown() override {}
+  void TearDown() override {
+    doptions::Deprecations::setHandler(nullptr);
+    doptions::Deprecations::clear();
+    notices().clear();
+  }
+
+  static auto notices() -> std::vector<std::string>& {
+    static std::vector<std::string> reported;
+    return reported;
+  }
+
+  static void captureNotice(std::string_view name, std::string_view notice) {
+    notices().push_back(std::string(name) + ": " + std::string(notice));
+  }
 };
 
 // ============================================================================
@@ -655,3 +671,825 @@ TEST_F(ApplicationTest, ParseFloatingPointTypes) {
   EXPECT_FLOAT_EQ(f, 3.14f);
   EXPECT_DOUBLE_EQ(d, 2.71828);
 }
+
+// ============================================================================
+// reparse Tests
+// ============================================================================
+
+struct CountedInt {
+  int value{0};
+  static inline int conversions = 0;
+};
+
+REGISTER_TYPE(CountedInt) {
+  ++CountedInt::conversions;
+  return CountedInt{std::stoi(str)};
+}
+
+TEST_F(ApplicationTest, ReparseFirstCallBehavesLikeParse) {
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  bool verbose = false;
+  app.addOption("-p,--port", &port);
+  app.addOption("-v,--verbose", &verbose);
+
+  doptions::ParseState state;
+  const char* argv[] = {"app", "--port", "8080", "-v"};
+  EXPECT_NO_THROW(app.reparse(state, 4, const_cast<char**>(argv)));
+  EXPECT_EQ(port, 8080);
+  EXPECT_TRUE(verbose);
+  EXPECT_TRUE(state.valid);
+}
+
+TEST_F(ApplicationTest, ReparseSkipsUnchangedConversions) {
+  auto app = doptions::Application::createApp();
+  CountedInt first{};
+  CountedInt second{};
+  app.addOption("--first", &first);
+  app.addOption("--second", &second);
+
+  doptions::ParseState state;
+  CountedInt::conversions = 0;
+  const char* argv1[] = {"app", "--first", "1", "--second", "2"};
+  app.reparse(state, 5, const_cast<char**>(argv1));
+  EXPECT_EQ(CountedInt::conversions, 2);
+
+  const char* argv2[] = {"app", "--first", "1", "--second", "3"};
+  app.reparse(state, 5, const_cast<char**>(argv2));
+  EXPECT_EQ(CountedInt::conversions, 3);
+  EXPECT_EQ(first.value, 1);
+  EXPECT_EQ(second.value, 3);
+
+  // Reordering tokens keeps the values, so nothing is converted again
+  const char* argv3[] = {"app", "--second", "3", "--first", "1"};
+  app.reparse(state, 5, const_cast<char**>(argv3));
+  EXPECT_EQ(CountedInt::conversions, 3);
+}
+
+TEST_F(ApplicationTest, ReparseResetsRemovedOptionsToDefaults) {
+  auto app = doptions::Application::createApp();
+  int port = 80;
+  bool verbose = false;
+  app.addOption("-p,--port", &port);
+  app.addOption("-v,--verbose", &verbose);
+
+  doptions::ParseState state;
+  const char* argv1[] = {"app", "--port", "8080", "-v"};
+  app.reparse(state, 4, const_cast<char**>(argv1));
+  EXPECT_EQ(port, 8080);
+  EXPECT_TRUE(verbose);
+
+  const char* argv2[] = {"app", "-v"};
+  app.reparse(state, 2, const_cast<char**>(argv2));
+  EXPECT_EQ(port, 80);
+  EXPECT_TRUE(verbose);
+
+  const char* argv3[] = {"app"};
+  app.reparse(state, 1, const_cast<char**>(argv3));
+  EXPECT_FALSE(verbose);
+}
+
+TEST_F(ApplicationTest, ReparseSwitchesCommands) {
+  auto app = doptions::Application::createApp();
+  bool buildExecuted = false;
+  bool testExecuted = false;
+  int jobs = 1;
+  auto& build = app.addCommand("build", &buildExecuted);
+  build->addOption("-j,--jobs", &jobs);
+  app.addCommand("test", &testExecuted);
+
+  doptions::ParseState state;
+  const char* argv1[] = {"app", "build", "-j", "8"};
+  app.reparse(state, 4, const_cast<char**>(argv1));
+  EXPECT_TRUE(buildExecuted);
+  EXPECT_EQ(jobs, 8);
+
+  const char* argv2[] = {"app", "test"};
+  app.reparse(state, 2, const_cast<char**>(argv2));
+  EXPECT_FALSE(buildExecuted);
+  EXPECT_TRUE(testExecuted);
+  EXPECT_EQ(jobs, 1);
+}
+
+TEST_F(ApplicationTest, ReparseFailureInvalidatesState) {
+  auto app = doptions::Application::createApp();
+  int port = 80;
+  app.addOption("-p,--port", &port);
+
+  doptions::ParseState state;
+  const char* argv1[] = {"app", "--port", "8080"};
+  app.reparse(state, 3, const_cast<char**>(argv1));
+
+  const char* argv2[] = {"app", "--port", "9090", "--unknown"};
+  EXPECT_THROW(app.reparse(state, 4, const_cast<char**>(argv2)),
+               doptions::ParseException);
+  EXPECT_FALSE(state.valid);
+
+  // The next call starts from defaults and converts everything again
+  const char* argv3[] = {"app", "--port", "8080"};
+  app.reparse(state, 3, const_cast<char**>(argv3));
+  EXPECT_EQ(port, 8080);
+
+  const char* argv4[] = {"app"};
+  app.reparse(state, 1, const_cast<char**>(argv4));
+  EXPECT_EQ(port, 80);
+}
+
+// ============================================================================
+// Observer Tests
+// ============================================================================
+
+TEST_F(ApplicationTest, ObserverFiresAfterParse) {
+  auto app = doptions::Application::createApp();
+  std::string level;
+  std::string seen;
+  app.addOption("-l,--log-level", &level);
+
+  auto observer = [&](const doptions::OptionBase& opt) {
+    seen = opt.longName() + "=" + level;
+  };
+  app.addObserver("--log-level", observer);
+
+  const char* argv[] = {"app", "-l", "debug"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(seen, "--log-level=debug");
+}
+
+TEST_F(ApplicationTest, ObserverNotFiredForUnsetOption) {
+  auto app = doptions::Application::createApp();
+  bool verbose = false;
+  int port = 0;
+  int calls = 0;
+  app.addOption("-v,--verbose", &verbose);
+  app.addOption("-p,--port", &port);
+
+  auto observer = [&](const doptions::OptionBase&) { ++calls; };
+  app.addObserver("--verbose", observer);
+
+  const char* argv[] = {"app", "--port", "80"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(calls, 0);
+}
+
+TEST_F(ApplicationTest, ObserversRunByPriorityAfterParse) {
+  auto app = doptions::Application::createApp();
+  int first = 0;
+  int second = 0;
+  std::vector<std::string> order;
+  app.addOption("--first", &first);
+  app.addOption("--second", &second);
+
+  auto low = [&](const doptions::OptionBase& opt) {
+    order.push_back("low" + opt.longName());
+  };
+  auto high = [&](const doptions::OptionBase& opt) {
+    // Every value is already stored when the batch runs
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 2);
+    order.push_back("high" + opt.longName());
+  };
+  app.addObserver("--first", low);
+  app.addObserver("--second", high, 10);
+  app.addObserver("--first", high, 10);
+
+  const char* argv[] = {"app", "--first", "1", "--second", "2"};
+  app.parse(5, const_cast<char**>(argv));
+  std::vector<std::string> expected = {"high--second", "high--first",
+                                       "low--first"};
+  EXPECT_EQ(order, expected);
+}
+
+TEST_F(ApplicationTest, ObserverNotFiredOnFailedParse) {
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  int calls = 0;
+  app.addOption("-p,--port", &port);
+
+  auto observer = [&](const doptions::OptionBase&) { ++calls; };
+  app.addObserver("-p", observer);
+
+  const char* argv[] = {"app", "-p", "80", "--unknown"};
+  EXPECT_THROW(app.parse(4, const_cast<char**>(argv)),
+               doptions::ParseException);
+  EXPECT_EQ(calls, 0);
+}
+
+TEST_F(ApplicationTest, ObserverForUnknownNameThrows) {
+  auto app = doptions::Application::createApp();
+  auto observer = [](const doptions::OptionBase&) {};
+  EXPECT_THROW(app.addObserver("--missing", observer),
+               doptions::BuildException);
+}
+
+TEST_F(ApplicationTest, ObserverRejectsTemporaryCallables) {
+  using Callback = doptions::FunctionRef<void(const doptions::OptionBase&)>;
+  int calls = 0;
+  auto capturing = [&calls](const doptions::OptionBase&) { ++calls; };
+  auto captureless = [](const doptions::OptionBase&) {};
+  EXPECT_TRUE((std::is_constructible_v<Callback, decltype(capturing)&>));
+  EXPECT_FALSE((std::is_constructible_v<Callback, decltype(capturing)&&>));
+  EXPECT_TRUE((std::is_constructible_v<Callback, decltype(captureless)&&>));
+}
+
+// ============================================================================
+// memoryUsage Tests
+// ============================================================================
+
+TEST_F(ApplicationTest, MemoryUsageEmptyApplication) {
+  auto app = doptions::Application::createApp();
+  EXPECT_EQ(app.memoryUsage().total(), 0U);
+}
+
+TEST_F(ApplicationTest, MemoryUsageGrowsWithOptions) {
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  app.addOption("-p,--port", &port);
+  auto small = app.memoryUsage();
+  EXPECT_GT(small.options, 0U);
+
+  std::string host;
+  app.addOption("--a-rather-long-option-name-for-the-host", &host);
+  auto large = app.memoryUsage();
+  EXPECT_GT(large.options, small.options);
+  EXPECT_GT(large.names, small.names);
+}
+
+TEST_F(ApplicationTest, MemoryUsageCountsLookupTablesAfterParse) {
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  app.addOption("-p,--port", &port);
+  EXPECT_EQ(app.memoryUsage().lookupTables, 0U);
+
+  const char* argv[] = {"app", "-p", "80"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_GT(app.memoryUsage().lookupTables, 0U);
+}
+
+TEST_F(ApplicationTest, MemoryUsageCountsCommandsAndBoundValues) {
+  auto app = doptions::Application::createApp();
+  bool executed = false;
+  std::string message;
+  auto& cmd = app.addCommand("commit", &executed);
+  cmd->addOption("-m,--message", &message);
+  EXPECT_GT(app.memoryUsage().commands, 0U);
+  EXPECT_EQ(app.memoryUsage().boundValues, 0U);
+
+  const char* argv[] = {"app", "commit", "-m",
+                        "a commit message that does not fit inline"};
+  app.parse(4, const_cast<char**>(argv));
+  EXPECT_GT(app.memoryUsage().boundValues, message.size());
+}
+
+TEST_F(ApplicationTest, MemoryUsageCountsReparseState) {
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  app.addOption("-p,--port", &port);
+
+  doptions::ParseState state;
+  const char* argv[] = {"app", "-p", "80"};
+  app.reparse(state, 3, const_cast<char**>(argv));
+  EXPECT_GT(app.memoryUsage(state).scratch, app.memoryUsage().scratch);
+}
+
+// ============================================================================
+// Case-Insensitive Matching Tests
+// ============================================================================
+
+TEST_F(ApplicationTest, ExactMatchingIsDefault) {
+  auto app = doptions::Application::createApp();
+  bool verbose = false;
+  app.addOption("-v,--verbose", &verbose);
+  EXPECT_EQ(app.matchPolicy(), doptions::MatchPolicy::Exact);
+
+  const char* argv[] = {"app", "--Verbose"};
+  EXPECT_THROW(app.parse(2, const_cast<char**>(argv)),
+               doptions::ParseException);
+}
+
+TEST_F(ApplicationTest, IgnoreCaseMatchesOptionsAndCommands) {
+  auto app = doptions::Application::createApp();
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  bool verbose = false;
+  int threads = 0;
+  bool executed = false;
+  std::string message;
+  app.addOption("-v,--verbose", &verbose);
+  app.addOption("--Threads", &threads);
+  auto& cmd = app.addCommand("commit", &executed);
+  cmd->addOption("-m,--message", &message);
+
+  const char* argv[] = {"app",    "--VERBOSE", "--threads", "8",
+                        "Commit", "--Message", "Fix"};
+  app.parse(7, const_cast<char**>(argv));
+  EXPECT_TRUE(verbose);
+  EXPECT_EQ(threads, 8);
+  EXPECT_TRUE(executed);
+  EXPECT_EQ(message, "Fix");
+}
+
+TEST_F(ApplicationTest, IgnoreCaseKeepsValuesAndErrorTokens) {
+  auto app = doptions::Application::createApp();
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  std::string name;
+  app.addOption("--name", &name);
+
+  const char* argv[] = {"app", "--NAME", "MixedCase"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(name, "MixedCase");
+
+  const char* unknown[] = {"app", "--Unknown-Option"};
+  try {
+    app.parse(2, const_cast<char**>(unknown));
+    FAIL() << "expected ParseException";
+  } catch (const doptions::ParseException& error) {
+    EXPECT_NE(std::string(error.what()).find("--Unknown-Option"),
+              std::string::npos);
+  }
+}
+
+TEST_F(ApplicationTest, IgnoreCaseDetectsDuplicateSpellings) {
+  auto app = doptions::Application::createApp();
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  int value = 0;
+  app.addOption("--value", &value);
+
+  const char* argv[] = {"app", "--value", "1", "--VALUE", "2"};
+  EXPECT_THROW(app.parse(5, const_cast<char**>(argv)),
+               doptions::ParseException);
+}
+
+TEST_F(ApplicationTest, IgnoreCaseRejectsNamesDifferingInCase) {
+  auto app = doptions::Application::createApp();
+  bool lower = false;
+  bool upper = false;
+  app.addOption("-v", &lower);
+  app.addOption("-V", &upper);
+
+  const char* argv[] = {"app", "-V"};
+  EXPECT_NO_THROW(app.parse(2, const_cast<char**>(argv)));
+  EXPECT_TRUE(upper);
+
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  EXPECT_THROW(app.parse(2, const_cast<char**>(argv)),
+               doptions::BuildException);
+}
+
+TEST_F(ApplicationTest, IgnoreCaseAppliesToExistingCommands) {
+  auto app = doptions::Application::createApp();
+  bool executed = false;
+  bool force = false;
+  auto& cmd = app.addCommand("push", &executed);
+  cmd->addOption("--force", &force);
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  EXPECT_EQ(cmd->matchPolicy(), doptions::MatchPolicy::IgnoreCase);
+
+  const char* argv[] = {"app", "PUSH", "--Force"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_TRUE(executed);
+  EXPECT_TRUE(force);
+}
+
+TEST_F(ApplicationTest, ReparseAfterMatchPolicyChangeRelooksTokens) {
+  auto app = doptions::Application::createApp();
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  int port = 0;
+  app.addOption("--port", &port);
+
+  doptions::ParseState state;
+  const char* argv[] = {"app", "--PORT", "1"};
+  app.reparse(state, 3, const_cast<char**>(argv));
+  EXPECT_EQ(port, 1);
+
+  app.setMatchPolicy(doptions::MatchPolicy::Exact);
+  EXPECT_THROW(app.reparse(state, 3, const_cast<char**>(argv)),
+               doptions::ParseException);
+}
+
+TEST_F(ApplicationTest, IgnoreCaseAppliesToJsonKeys) {
+  auto app = doptions::Application::createApp();
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  int threads = 0;
+  app.addOption("--threads", &threads);
+  app.parseJson(R"({"Threads": 4})");
+  EXPECT_EQ(threads, 4);
+}
+
+TEST_F(ApplicationTest, IgnoreCaseLongNames) {
+  auto app = doptions::Application::createApp();
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  int first = 0;
+  int second = 0;
+  app.addOption("--connection-timeout-milliseconds", &first);
+  app.addOption("--connection-timeout-seconds", &second);
+
+  const char* argv[] = {"app", "--CONNECTION-Timeout-Milliseconds", "250",
+                        "--Connection-Timeout-SECONDS", "3"};
+  app.parse(5, const_cast<char**>(argv));
+  EXPECT_EQ(first, 250);
+  EXPECT_EQ(second, 3);
+}
+
+TEST_F(ApplicationTest, FoldCaseWordMatchesBytewiseFold) {
+  for (int value = 0; value < 256; ++value) {
+    const auto byte = static_cast<char>(value);
+    uint64_t word = 0;
+    for (size_t shift = 0; shift < 64; shift += 8) {
+      word |= static_cast<uint64_t>(static_cast<unsigned char>(byte)) << shift;
+    }
+    const auto folded = static_cast<uint64_t>(static_cast<unsigned char>(
+        doptions::StringUtils::foldCase(byte)));
+    EXPECT_EQ(doptions::StringUtils::foldCase(word),
+              folded * 0x0101010101010101ULL)
+        << "byte " << value;
+  }
+}
+
+TEST_F(ApplicationTest, CompareFoldedOrdersLikeFoldedStrings) {
+  using doptions::StringUtils;
+  EXPECT_EQ(StringUtils::compareFolded("--verbose", "--VERBOSE"), 0);
+  EXPECT_LT(StringUtils::compareFolded("--verbose", "--VERBOSEx"), 0);
+  EXPECT_GT(StringUtils::compareFolded("--verbose-level", "--VERBOSE"), 0);
+  EXPECT_LT(StringUtils::compareFolded("--abcdefghij", "--ABCDEFGHIK"), 0);
+  EXPECT_GT(StringUtils::compareFolded("--abcdefghik", "--ABCDEFGHIJ"), 0);
+  // Bytes above 0x7f are never folded, even when their low bits spell a
+  // capital letter.
+  EXPECT_NE(StringUtils::compareFolded("--\xe1", "--\xc1"), 0);
+  EXPECT_LT(StringUtils::compareFolded("--z", "--\xc1"), 0);
+}
+
+// ============================================================================
+// Alias Tests
+// ============================================================================
+
+TEST_F(ApplicationTest, AliasResolvesToSameOption) {
+  auto app = doptions::Application::createApp();
+  int threads = 0;
+  auto& opt = app.addOption("-t,--threads", &threads);
+  app.addAlias("--threads", "--jobs");
+  app.addAlias("-t", "-j,--workers");
+
+  for (const char* name : {"--threads", "-t", "--jobs", "-j", "--workers"}) {
+    const char* argv[] = {"app", name, "6"};
+    threads = 0;
+    app.parse(3, const_cast<char**>(argv));
+    EXPECT_EQ(threads, 6) << name;
+  }
+  EXPECT_EQ(opt->aliases().size(), 3U);
+}
+
+TEST_F(ApplicationTest, AliasAndNameTogetherIsRepeated) {
+  auto app = doptions::Application::createApp();
+  int threads = 0;
+  app.addOption("--threads", &threads);
+  app.addAlias("--threads", "--jobs");
+
+  const char* argv[] = {"app", "--threads", "2", "--jobs", "4"};
+  try {
+    app.parse(5, const_cast<char**>(argv));
+    FAIL() << "expected ParseException";
+  } catch (const doptions::ParseException& error) {
+    const std::string message = error.what();
+    EXPECT_NE(message.find("--threads"), std::string::npos);
+    EXPECT_NE(message.find("--jobs"), std::string::npos);
+  }
+}
+
+TEST_F(ApplicationTest, AliasOfUnknownOptionThrows) {
+  auto app = doptions::Application::createApp();
+  int threads = 0;
+  app.addOption("--threads", &threads);
+  EXPECT_THROW(app.addAlias("--missing", "--jobs"), doptions::BuildException);
+  EXPECT_THROW(app.addAlias("--threads", "--1bad"), doptions::BuildException);
+}
+
+TEST_F(ApplicationTest, AliasAddedAfterParse) {
+  auto app = doptions::Application::createApp();
+  int threads = 0;
+  app.addOption("--threads", &threads);
+  const char* first[] = {"app", "--threads", "1"};
+  app.parse(3, const_cast<char**>(first));
+
+  app.addAlias("--threads", "--jobs");
+  const char* second[] = {"app", "--jobs", "3"};
+  app.parse(3, const_cast<char**>(second));
+  EXPECT_EQ(threads, 3);
+}
+
+TEST_F(ApplicationTest, DeprecatedAliasReportedOncePerProcess) {
+  doptions::Deprecations::setHandler(captureNotice);
+  auto app = doptions::Application::createApp();
+  int threads = 0;
+  app.addOption("--threads", &threads);
+  app.addDeprecatedAlias("--threads", "--num-threads", "use --threads");
+
+  const char* current[] = {"app", "--threads", "2"};
+  app.parse(3, const_cast<char**>(current));
+  EXPECT_TRUE(notices().empty());
+
+  const char* old[] = {"app", "--num-threads", "4"};
+  app.parse(3, const_cast<char**>(old));
+  app.parse(3, const_cast<char**>(old));
+  EXPECT_EQ(threads, 4);
+  ASSERT_EQ(notices().size(), 1U);
+  EXPECT_EQ(notices()[0], "--num-threads: use --threads");
+
+  auto other = doptions::Application::createApp();
+  int count = 0;
+  other.addOption("--count", &count);
+  other.addDeprecatedAlias("--count", "--num-threads");
+  other.parse(3, const_cast<char**>(old));
+  EXPECT_EQ(notices().size(), 1U);
+  EXPECT_TRUE(doptions::Deprecations::reported("--num-threads"));
+}
+
+TEST_F(ApplicationTest, DeprecatedAliasReportedFromJsonAndReparse) {
+  doptions::Deprecations::setHandler(captureNotice);
+  auto app = doptions::Application::createApp();
+  int threads = 0;
+  int depth = 0;
+  app.addOption("--threads", &threads);
+  app.addOption("--depth", &depth);
+  app.addDeprecatedAlias("--threads", "--jobs", "renamed");
+  app.addDeprecatedAlias("--depth", "--level");
+
+  app.parseJson(R"({"jobs": 3})");
+  EXPECT_EQ(threads, 3);
+
+  doptions::ParseState state;
+  const char* argv[] = {"app", "--level", "2"};
+  app.reparse(state, 3, const_cast<char**>(argv));
+  EXPECT_EQ(depth, 2);
+  EXPECT_EQ(notices(),
+            (std::vector<std::string>{"--jobs: renamed", "--level: "}));
+}
+
+TEST_F(ApplicationTest, AliasesFollowMatchPolicy) {
+  auto app = doptions::Application::createApp();
+  app.setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+  int threads = 0;
+  app.addOption("--threads", &threads);
+  app.addAlias("--threads", "--Jobs");
+
+  const char* argv[] = {"app", "--JOBS", "5"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(threads, 5);
+}
+
+TEST_F(ApplicationTest, MemoryUsageCountsAliases) {
+  auto app = doptions::Application::createApp();
+  int threads = 0;
+  app.addOption("--threads", &threads);
+  const size_t before = app.memoryUsage().names;
+  app.addAlias("--threads", "--a-rather-long-alias-name-for-threads");
+  EXPECT_GT(app.memoryUsage().names, before);
+}
+
+// ============================================================================
+// Attached Value Tests
+// ============================================================================
+
+TEST_F(ApplicationTest, ParseAttachedValues) {
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  std::string query;
+  bool verbose = false;
+  app.addOption("-p,--port", &port);
+  app.addOption("--query", &query);
+  app.addOption("--verbose", &verbose);
+
+  const char* argv[] = {"app", "--port=8080", "--query=a=b", "-p=1"};
+  EXPECT_THROW(app.parse(4, const_cast<char**>(argv)),
+               doptions::ParseException);
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(port, 8080);
+  EXPECT_EQ(query, "a=b");
+
+  const char* flag[] = {"app", "--verbose=true"};
+  EXPECT_THROW(app.parse(2, const_cast<char**>(flag)),
+               doptions::ParseException);
+}
+
+TEST_F(ApplicationTest, AttachedAndSeparateValuesConvertAlike) {
+  for (const std::string value : {"+5", " 5", "5abc", "0x10", "abc"}) {
+    auto app = doptions::Application::createApp();
+    int count = -1;
+    app.addOption("--count", &count);
+
+    std::optional<int> separate;
+    const char* split[] = {"app", "--count", value.c_str()};
+    try {
+      app.parse(3, const_cast<char**>(split));
+      separate = count;
+    } catch (const std::invalid_argument&) {
+    }
+    count = -1;
+    std::optional<int> attached;
+    const auto joined = "--count=" + value;
+    const char* join[] = {"app", joined.c_str()};
+    try {
+      app.parse(2, const_cast<char**>(join));
+      attached = count;
+    } catch (const std::invalid_argument&) {
+    }
+    EXPECT_EQ(separate, attached) << value;
+  }
+}
+
+TEST_F(ApplicationTest, ReparseAttachedValues) {
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  app.addOption("--port", &port);
+
+  doptions::ParseState state;
+  const char* first[] = {"app", "--port=80"};
+  app.reparse(state, 2, const_cast<char**>(first));
+  EXPECT_EQ(port, 80);
+  const char* second[] = {"app", "--port=81"};
+  app.reparse(state, 2, const_cast<char**>(second));
+  EXPECT_EQ(port, 81);
+}
+
+// ============================================================================
+// Storage Tests
+// ============================================================================
+
+namespace {
+
+// Option counting how many instances were destroyed.
+class TrackedOption : public doptions::OptionBase {
+ public:
+  explicit TrackedOption(size_t& destroyed) : destroyed_(destroyed) {}
+  TrackedOption(const TrackedOption&) = delete;
+  TrackedOption(TrackedOption&&) = delete;
+  auto operator=(const TrackedOption&) -> TrackedOption& = delete;
+  auto operator=(TrackedOption&&) -> TrackedOption& = delete;
+  ~TrackedOption() override { ++destroyed_; }
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return name_;
+  }
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return longName_;
+  }
+  [[nodiscard]] auto needsValue() const -> bool override { return false; }
+  auto parseValue(const std::string& /*str*/) -> void override {}
+  auto reset() -> void override {}
+  [[nodiscard]] auto memoryUsage() const -> doptions::MemoryUsage override {
+    return {};
+  }
+
+ private:
+  size_t& destroyed_;
+  std::string name_{"-t"};
+  std::string longName_;
+};
+
+}  // namespace
+
+TEST_F(ApplicationTest, ArenaStorageParsesAsUsual) {
+  auto app = doptions::Application::createApp({.arena = true});
+  int32_t port = 0;
+  std::string host = "localhost";
+  bool verbose = false;
+  std::vector<int32_t> ids;
+  app.addOption("-p,--port", &port);
+  app.addOption("--host", &host);
+  app.addOption("--verbose", &verbose);
+  app.addOption("--id-list", &ids);
+
+  doptions::ParseState state;
+  const char* first[] = {"app", "-p", "80", "--host=a", "--verbose",
+                         "--id-list", "1,2"};
+  app.reparse(state, 7, const_cast<char**>(first));
+  EXPECT_EQ(port, 80);
+  EXPECT_EQ(host, "a");
+  EXPECT_TRUE(verbose);
+  EXPECT_EQ(ids, (std::vector<int32_t>{1, 2}));
+  const char* second[] = {"app", "--port", "81"};
+  app.reparse(state, 3, const_cast<char**>(second));
+  EXPECT_EQ(port, 81);
+  EXPECT_EQ(host, "localhost");
+  EXPECT_FALSE(verbose);
+}
+
+TEST_F(ApplicationTest, ArenaStorageKeepsOptionHandles) {
+  auto app = doptions::Application::createApp({.arena = true});
+  int32_t port = 0;
+  std::unique_ptr<doptions::OptionBase>& opt = app.addOption("--port", &port);
+  EXPECT_EQ(opt->longName(), "--port");
+  EXPECT_TRUE(opt->needsValue());
+  std::unique_ptr<doptions::OptionBase>& preset =
+      app.addPresetOption("--profile");
+  EXPECT_EQ(preset->longName(), "--profile");
+}
+
+TEST_F(ApplicationTest, ArenaStorageAllocatesInBlocks) {
+  constexpr size_t count = 64;
+  std::vector<int32_t> values(count);
+  std::vector<std::string> names;
+  for (size_t idx = 0; idx < count; ++idx) {
+    names.push_back("--opt-" + std::to_string(idx));
+  }
+  auto measure = [&](doptions::StorageConfig storage) {
+    const size_t before = allocationCount();
+    auto app = doptions::Application::createApp(storage);
+    for (size_t idx = 0; idx < count; ++idx) {
+      app.addOption(names[idx], &values[idx]);
+    }
+    return allocationCount() - before;
+  };
+  const size_t heap = measure({});
+  const size_t arena = measure({.arena = true});
+  EXPECT_LE(arena + count - 2, heap);
+}
+
+TEST_F(ApplicationTest, ArenaStorageMemoryUsage) {
+  constexpr size_t count = 64;
+  std::vector<int32_t> values(count);
+  auto fill = [&values](doptions::Application& app) {
+    for (size_t idx = 0; idx < count; ++idx) {
+      app.addOption("--opt-" + std::to_string(idx), &values[idx]);
+    }
+  };
+  auto heap = doptions::Application::createApp();
+  auto arena = doptions::Application::createApp({.arena = true});
+  // Before the first block only the arena itself is counted.
+  const size_t empty = arena.memoryUsage().arena;
+  EXPECT_GT(empty, 0U);
+  EXPECT_LT(empty, size_t{1024});
+  fill(heap);
+  fill(arena);
+
+  // The placed options move from options to arena, which counts the whole
+  // block they were placed in.
+  const auto heapUsage = heap.memoryUsage();
+  const auto arenaUsage = arena.memoryUsage();
+  EXPECT_EQ(heapUsage.arena, 0U);
+  const size_t placed = heapUsage.options - arenaUsage.options;
+  EXPECT_GE(placed, count * sizeof(doptions::OptionBase));
+  EXPECT_GE(arenaUsage.arena, placed);
+  EXPECT_EQ(arenaUsage.names, heapUsage.names);
+  EXPECT_EQ(arenaUsage.total(), heapUsage.total() - placed + arenaUsage.arena);
+}
+
+TEST_F(ApplicationTest, ArenaStorageMoveAssignment) {
+  size_t destroyed = 0;
+  int32_t port = 0;
+  std::string host;
+  auto app = doptions::Application::createApp({.arena = true});
+  app.addOption(std::make_unique<TrackedOption>(destroyed));
+  app.addOption("--port", &port);
+  {
+    auto other = doptions::Application::createApp({.arena = true});
+    other.addOption("--host", &host);
+    app = std::move(other);
+  }
+  EXPECT_EQ(destroyed, 1U);
+  const char* argv[] = {"app", "--host", "example.org"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(host, "example.org");
+  const char* unknown[] = {"app", "--port", "1"};
+  EXPECT_THROW(app.parse(3, const_cast<char**>(unknown)),
+               doptions::ParseException);
+
+  app = doptions::Application::createApp();
+  app.addOption("--port", &port);
+  app.parse(3, const_cast<char**>(unknown));
+  EXPECT_EQ(port, 1);
+}
+
+TEST_F(ApplicationTest, LeakAtExitSkipsDestruction) {
+  size_t destroyed = 0;
+  int32_t port = 0;
+  {
+    auto app = doptions::Application::createApp();
+    app.addOption(std::make_unique<TrackedOption>(destroyed));
+    app.addOption("--port", &port);
+    const char* argv[] = {"app", "--port", "8"};
+    app.parse(3, const_cast<char**>(argv));
+    app.leakAtExit();
+  }
+  EXPECT_EQ(destroyed, 0U);
+  EXPECT_EQ(port, 8);
+  {
+    auto app = doptions::Application::createApp();
+    app.addOption(std::make_unique<TrackedOption>(destroyed));
+  }
+  EXPECT_EQ(destroyed, 1U);
+}
+
+TEST_F(ApplicationTest, LeakAtExitFollowsMovedSchema) {
+  size_t destroyed = 0;
+  auto* const previous = doptions::LeakedApplication::head.load();
+  {
+    auto app = doptions::Application::createApp();
+    app.addOption(std::make_unique<TrackedOption>(destroyed));
+    app.leakAtExit();
+    auto moved = doptions::Application::createApp();
+    moved = std::move(app);
+  }
+  EXPECT_EQ(destroyed, 0U);
+  auto* const head = doptions::LeakedApplication::head.load();
+  ASSERT_NE(head, previous);
+  EXPECT_EQ(head->next, previous);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <doptions/application.hpp>
+#include <doptions/array_file.hpp>
+#include <doptions/exceptions.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Test fixture for ArrayFile tests
+class ArrayFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+    dir_ = std::filesystem::temp_directory_path() /
+           ("doptions-array-" + std::to_string(::getpid()) + "-" +
+            info->name());
+    std::filesystem::create_directories(dir_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  template <typename T>
+  auto writeBinary(const std::string& name, const std::vector<T>& values)
+      -> std::string {
+    auto path = (dir_ / name).string();
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<std::streamsize>(values.size() * sizeof(T)));
+    return path;
+  }
+
+  auto writeText(const std::string& name, const std::string& text)
+      -> std::string {
+    auto path = (dir_ / name).string();
+    std::ofstream(path) << text;
+    return path;
+  }
+
+  std::filesystem::path dir_;
+};
+
+// ============================================================================
+// Loading Tests
+// ============================================================================
+
+TEST_F(ArrayFileTest, MapsBinaryFiles) {
+  auto path = writeBinary<float>("weights.f32", {0.5F, -1.0F, 2.25F});
+  doptions::ArrayFile<float> weights(path);
+  ASSERT_EQ(weights.size(), 3U);
+  EXPECT_FLOAT_EQ(weights[2], 2.25F);
+  EXPECT_EQ(weights.heapBytes(), 0U);
+}
+
+TEST_F(ArrayFileTest, ParsesTextIntoAlignedBuffer) {
+  auto path = writeText("t.csv", "1.5, 2\n3\t4,\n");
+  doptions::ArrayFile<double> values(path);
+  auto span = values.span();
+  ASSERT_EQ(span.size(), 4U);
+  EXPECT_DOUBLE_EQ(span[0], 1.5);
+  EXPECT_DOUBLE_EQ(span[3], 4.0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(span.data()) %
+                doptions::ArrayFile<double>::bufferAlignment,
+            0U);
+}
+
+TEST_F(ArrayFileTest, ExplicitFormatOverridesExtension) {
+  auto path = writeText("ids.data", "7 8 9");
+  doptions::ArrayFile<int32_t> ids(path, doptions::ArrayFormat::Text);
+  EXPECT_EQ(std::vector<int32_t>(ids.begin(), ids.end()),
+            (std::vector<int32_t>{7, 8, 9}));
+}
+
+TEST_F(ArrayFileTest, EmptyPathIsEmptyArray) {
+  doptions::ArrayFile<float> weights;
+  EXPECT_TRUE(weights.span().empty());
+}
+
+TEST_F(ArrayFileTest, TextErrorsReportPosition) {
+  auto path = writeText("t.csv", "1,2,oops");
+  doptions::ArrayFile<int32_t> values(path);
+  try {
+    (void)values.span();
+    FAIL() << "expected an exception";
+  } catch (const doptions::ParseException& error) {
+    EXPECT_STREQ(error.what(),
+                 "Parse Exception: Invalid list element at position 2: oops");
+  }
+}
+
+TEST_F(ArrayFileTest, TruncatedBinaryThrows) {
+  auto path = writeText("bad.f32", "abcdef");
+  doptions::ArrayFile<float> weights(path);
+  EXPECT_THROW((void)weights.span(), doptions::ParseException);
+}
+
+// ============================================================================
+// Option Tests
+// ============================================================================
+
+TEST_F(ArrayFileTest, OptionLoadsLazily) {
+  auto path = writeBinary<uint16_t>("ids.u16", {4, 5});
+  auto app = doptions::Application::createApp();
+  doptions::ArrayFile<uint16_t> ids;
+  app.addOption("--idents", &ids);
+  std::string arg = path;
+  const char* argv[] = {"prog", "--idents", arg.c_str()};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_FALSE(ids.loaded());
+  EXPECT_EQ(ids.path(), path);
+  EXPECT_EQ(ids[1], 5);
+  EXPECT_TRUE(ids.loaded());
+}
+
+TEST_F(ArrayFileTest, OptionKeepsExplicitFormat) {
+  auto path = writeText("w.dat", "0.5 1.5");
+  auto app = doptions::Application::createApp();
+  doptions::ArrayFile<float> weights{"", doptions::ArrayFormat::Text};
+  app.addOption("--weights", &weights);
+  std::string arg = path;
+  const char* argv[] = {"prog", "--weights", arg.c_str()};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(weights.format(), doptions::ArrayFormat::Text);
+  ASSERT_EQ(weights.size(), 2U);
+  EXPECT_FLOAT_EQ(weights[1], 1.5F);
+}
+
+TEST_F(ArrayFileTest, MissingFileFailsOnAccess) {
+  auto app = doptions::Application::createApp();
+  doptions::ArrayFile<float> weights;
+  app.addOption("--weights", &weights);
+  const char* argv[] = {"prog", "--weights", "/nonexistent/w.f32"};
+  EXPECT_NO_THROW(app.parse(3, const_cast<char**>(argv)));
+  EXPECT_THROW((void)weights.span(), std::system_error);
+}
+
+TEST_F(ArrayFileTest, ResetRestoresDefaultPath) {
+  auto path = writeText("t.csv", "1");
+  doptions::ArrayFile<int32_t> values(path);
+  auto opt = doptions::ArrayFileOption<int32_t>::createOption("--values",
+                                                              &values);
+  opt->parseValue("other.csv");
+  opt->reset();
+  EXPECT_EQ(values.path(), path);
+  EXPECT_EQ(values[0], 1);
+}
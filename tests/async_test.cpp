@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <array>
+#include <doptions/application.hpp>
+#include <doptions/async.hpp>
+#include <doptions/epoll_executor.hpp>
+#include <doptions/exceptions.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Test fixture for async parse tests
+class AsyncTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(::pipe(first_.data()), 0);
+    ASSERT_EQ(::pipe(second_.data()), 0);
+  }
+
+  void TearDown() override {
+    for (int fd : {first_[0], first_[1], second_[0], second_[1]}) {
+      ::close(fd);
+    }
+  }
+
+  static auto readAll(doptions::EpollExecutor& executor, int fd)
+      -> doptions::Task<std::string> {
+    co_await executor.readable(fd);
+    std::array<char, 64> buffer{};
+    auto bytes = ::read(fd, buffer.data(), buffer.size());
+    co_return std::string(buffer.data(), static_cast<size_t>(bytes));
+  }
+
+  static auto writeAll(int fd, const std::string& data) -> void {
+    ASSERT_EQ(::write(fd, data.data(), data.size()),
+              static_cast<ssize_t>(data.size()));
+  }
+
+  std::array<int, 2> first_{};
+  std::array<int, 2> second_{};
+};
+
+// ============================================================================
+// Task Tests
+// ============================================================================
+
+TEST_F(AsyncTest, TaskReturnsValue) {
+  doptions::EpollExecutor executor;
+  auto compute = []() -> doptions::Task<int> { co_return 42; };
+  auto task = compute();
+  EXPECT_EQ(executor.run(task), 42);
+}
+
+TEST_F(AsyncTest, TaskPropagatesException) {
+  doptions::EpollExecutor executor;
+  auto fail = []() -> doptions::Task<int> {
+    throw std::runtime_error("boom");
+    co_return 0;
+  };
+  auto task = fail();
+  EXPECT_THROW(executor.run(task), std::runtime_error);
+}
+
+TEST_F(AsyncTest, TaskAwaitsReadableFd) {
+  doptions::EpollExecutor executor;
+  writeAll(first_[1], "secret");
+  auto task = readAll(executor, first_[0]);
+  EXPECT_EQ(executor.run(task), "secret");
+}
+
+// ============================================================================
+// parseAsync Tests
+// ============================================================================
+
+TEST_F(AsyncTest, ParseAsyncConvertsSyncAndAsyncOptions) {
+  doptions::EpollExecutor executor;
+  auto app = doptions::Application::createApp();
+  int port = 0;
+  std::string token;
+  app.addOption("-p,--port", &port);
+  int fd = first_[0];
+  app.addAsyncOption<std::string>(
+      "--token-file", &token,
+      [&executor, fd](std::string path) -> doptions::Task<std::string> {
+        auto content = co_await readAll(executor, fd);
+        co_return path + ":" + content;
+      });
+
+  writeAll(first_[1], "abc");
+  const char* argv[] = {"app", "--port", "80", "--token-file", "fd"};
+  auto task = app.parseAsync(5, const_cast<char**>(argv), executor);
+  EXPECT_EQ(port, 80);
+  EXPECT_TRUE(token.empty());
+  executor.run(task);
+  EXPECT_EQ(token, "fd:abc");
+}
+
+TEST_F(AsyncTest, ParseAsyncRunsConversionsConcurrently) {
+  doptions::EpollExecutor executor;
+  auto app = doptions::Application::createApp();
+  std::string first;
+  std::string second;
+  int firstRead = first_[0];
+  int secondRead = second_[0];
+  int firstWrite = first_[1];
+
+  // The first conversion can only finish after the second one ran
+  app.addAsyncOption<std::string>(
+      "--first", &first,
+      [&executor, firstRead](std::string) -> doptions::Task<std::string> {
+        co_return co_await readAll(executor, firstRead);
+      });
+  app.addAsyncOption<std::string>(
+      "--second", &second,
+      [&executor, secondRead,
+       firstWrite](std::string) -> doptions::Task<std::string> {
+        auto value = co_await readAll(executor, secondRead);
+        writeAll(firstWrite, "from-second");
+        co_return value;
+      });
+
+  writeAll(second_[1], "direct");
+  const char* argv[] = {"app", "--first", "a", "--second", "b"};
+  auto task = app.parseAsync(5, const_cast<char**>(argv), executor);
+  executor.run(task);
+  EXPECT_EQ(first, "from-second");
+  EXPECT_EQ(second, "direct");
+}
+
+TEST_F(AsyncTest, ParseAsyncReportsConverterError) {
+  doptions::EpollExecutor executor;
+  auto app = doptions::Application::createApp();
+  int value = 0;
+  app.addAsyncOption<int>("--value",
+                          &value, [](std::string str) -> doptions::Task<int> {
+                            co_return std::stoi(str);
+                          });
+
+  const char* argv[] = {"app", "--value", "not-a-number"};
+  auto task = app.parseAsync(3, const_cast<char**>(argv), executor);
+  EXPECT_THROW(executor.run(task), std::invalid_argument);
+}
+
+TEST_F(AsyncTest, ParseAsyncThrowsTokenErrorsImmediately) {
+  doptions::EpollExecutor executor;
+  auto app = doptions::Application::createApp();
+  const char* argv[] = {"app", "--unknown"};
+  EXPECT_THROW(app.parseAsync(2, const_cast<char**>(argv), executor),
+               doptions::ParseException);
+}
+
+TEST_F(AsyncTest, ParseAsyncFiresObserversAfterConversions) {
+  doptions::EpollExecutor executor;
+  auto app = doptions::Application::createApp();
+  int value = 0;
+  int observed = -1;
+  app.addAsyncOption<int>("--value",
+                          &value, [](std::string str) -> doptions::Task<int> {
+                            co_return std::stoi(str);
+                          });
+  auto observer = [&](const doptions::OptionBase&) { observed = value; };
+  app.addObserver("--value", observer);
+
+  const char* argv[] = {"app", "--value", "7"};
+  auto task = app.parseAsync(3, const_cast<char**>(argv), executor);
+  EXPECT_EQ(observed, -1);
+  executor.run(task);
+  EXPECT_EQ(observed, 7);
+}
+
+TEST_F(AsyncTest, SyncParseRejectsAsyncOptions) {
+  auto app = doptions::Application::createApp();
+  int value = 0;
+  int port = 0;
+  int notified = 0;
+  app.addAsyncOption<int>("--value", &value,
+                          [](std::string str) -> doptions::Task<int> {
+                            co_return std::stoi(str);
+                          });
+  app.addOption("--port", &port);
+  auto count = [&notified](const doptions::OptionBase&) { ++notified; };
+  app.addObserver("--value", count);
+
+  const char* argv[] = {"app", "--value", "7"};
+  EXPECT_THROW(app.parse(3, const_cast<char**>(argv)),
+               doptions::ParseException);
+  EXPECT_THROW(app.parseJson(R"({"value": 7})"), doptions::ParseException);
+  doptions::ParseState state;
+  EXPECT_THROW(app.reparse(state, 3, const_cast<char**>(argv)),
+               doptions::ParseException);
+  EXPECT_EQ(notified, 0);
+
+  // Parses not giving the option are unaffected.
+  const char* other[] = {"app", "--port", "1"};
+  app.parse(3, const_cast<char**>(other));
+  EXPECT_EQ(port, 1);
+}
+
+TEST_F(AsyncTest, ParseAsyncIgnoresValueOfFailedParse) {
+  doptions::EpollExecutor executor;
+  auto app = doptions::Application::createApp();
+  int value = 0;
+  int port = 0;
+  app.addAsyncOption<int>("--value", &value,
+                          [](std::string str) -> doptions::Task<int> {
+                            co_return std::stoi(str);
+                          });
+  app.addOption("--port", &port);
+
+  const char* failing[] = {"app", "--value", "7", "--unknown"};
+  EXPECT_THROW(app.parseAsync(4, const_cast<char**>(failing), executor),
+               doptions::ParseException);
+  const char* argv[] = {"app", "--port", "2"};
+  auto task = app.parseAsync(3, const_cast<char**>(argv), executor);
+  executor.run(task);
+  EXPECT_EQ(port, 2);
+  EXPECT_EQ(value, 0);
+}
+
+TEST_F(AsyncTest, AsyncOptionWithoutVariable) {
+  auto opt = doptions::AsyncOption<int>::createOption(
+      "--value", nullptr, [](std::string) -> doptions::Task<int> {
+        co_return 0;
+      });
+  EXPECT_NO_THROW(opt->reset());
+  EXPECT_EQ(opt->memoryUsage().boundValues, 0U);
+}
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <doptions/application.hpp>
+#include <doptions/child_command.hpp>
+#include <doptions/mapped_file.hpp>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Test fixture for child command line tests
+class ChildCommandTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (int32_t idx = 0; idx < 3000; ++idx) {
+      ids_ += (idx == 0 ? "" : ",") + std::to_string(idx);
+    }
+    paths_ = "/data/a,/data/b";
+    for (auto* app : {&app_, &child_}) {
+      app->addOption("--id-list", &parsedIds_);
+      app->addOption("--paths", &parsedPaths_);
+      app->addOption("--name", &name_);
+      app->addOption("-v,--verbose", &verbose_);
+      app->addCommand("sync", &sync_)->addOption("--target", &target_);
+    }
+  }
+
+  void TearDown() override {}
+
+  auto reparse(std::vector<std::string> args) -> void {
+    args.insert(args.begin(), "app");
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+      argv.push_back(arg.data());
+    }
+    app_.reparse(state_, static_cast<int32_t>(argv.size()), argv.data());
+  }
+
+  // Parses args with the plain parse and builds the child command from them.
+  auto fromParse(std::vector<std::string> args,
+                 const doptions::SpillConfig& config = {})
+      -> doptions::ChildCommand {
+    args.insert(args.begin(), "app");
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+      argv.push_back(arg.data());
+    }
+    const auto argc = static_cast<int32_t>(argv.size());
+    app_.parse(argc, argv.data());
+    return doptions::ChildCommand::fromArgs(app_, argc, argv.data(), "child",
+                                            config);
+  }
+
+  // Parses the arguments of cmd with the same schema, as the child would.
+  auto parseInChild(doptions::ChildCommand& cmd) -> void {
+    parsedIds_.clear();
+    parsedPaths_.clear();
+    auto argv = cmd.argv();
+    child_.parse(static_cast<int32_t>(argv.size() - 1), argv.data());
+  }
+
+  static auto smallLimit() -> doptions::SpillConfig {
+    static char* environment[] = {nullptr};
+    doptions::SpillConfig config;
+    config.argMax = 8192;
+    config.headroom = 0;
+    config.minSpillBytes = 64;
+    config.environment = environment;
+    return config;
+  }
+
+  std::string ids_;
+  std::string paths_;
+  std::vector<int32_t> parsedIds_;
+  std::vector<std::string> parsedPaths_;
+  std::string name_;
+  bool verbose_{false};
+  bool sync_{false};
+  std::string target_;
+  doptions::ParseState state_;
+  doptions::Application app_ = doptions::Application::createApp();
+  doptions::Application child_ = doptions::Application::createApp();
+};
+
+// ============================================================================
+// Building
+// ============================================================================
+
+TEST_F(ChildCommandTest, RepeatsArgumentsThatFit) {
+  reparse({"--id-list", "1,2", "-v", "--name=worker", "sync", "--target", "b"});
+  auto cmd = doptions::ChildCommand::fromState(app_, state_, "child");
+  EXPECT_EQ(cmd.args(),
+            (std::vector<std::string>{"child", "--id-list", "1,2", "-v",
+                                      "--name=worker", "sync", "--target",
+                                      "b"}));
+  EXPECT_TRUE(cmd.files().empty());
+  const auto argv = cmd.argv();
+  EXPECT_EQ(argv.size(), 9U);
+  EXPECT_EQ(argv.back(), nullptr);
+}
+
+TEST_F(ChildCommandTest, EncodedSizeCountsStringsAndPointers) {
+  reparse({"--name", "abc"});
+  auto cmd = doptions::ChildCommand::fromState(app_, state_, "child");
+  EXPECT_EQ(cmd.encodedSize(),
+            (6 + 7 + 4) + 4 * sizeof(char*));
+}
+
+TEST_F(ChildCommandTest, SpillsLargestListValuesPastTheLimit) {
+  reparse({"--paths", paths_, "--id-list", ids_, "--name", "worker"});
+  auto cmd =
+      doptions::ChildCommand::fromState(app_, state_, "child", smallLimit());
+  ASSERT_EQ(cmd.files().size(), 1U);
+  const std::string spilled =
+      "@/proc/self/fd/" + std::to_string(cmd.files()[0]);
+  EXPECT_EQ(cmd.args()[4], spilled);
+  EXPECT_EQ(cmd.args()[2], paths_);
+  EXPECT_LE(cmd.encodedSize(), 8192U);
+  EXPECT_EQ(doptions::MappedFile::open(spilled.substr(1)).view(), ids_);
+
+  parseInChild(cmd);
+  EXPECT_EQ(parsedIds_.size(), 3000U);
+  EXPECT_EQ(parsedIds_.back(), 2999);
+  EXPECT_EQ(parsedPaths_, (std::vector<std::string>{"/data/a", "/data/b"}));
+  EXPECT_EQ(name_, "worker");
+}
+
+TEST_F(ChildCommandTest, SpillsAttachedValues) {
+  reparse({"--id-list=" + ids_});
+  auto cmd =
+      doptions::ChildCommand::fromState(app_, state_, "child", smallLimit());
+  ASSERT_EQ(cmd.files().size(), 1U);
+  EXPECT_TRUE(cmd.args()[1].starts_with("--id-list=@/proc/self/fd/"));
+  parseInChild(cmd);
+  EXPECT_EQ(parsedIds_.size(), 3000U);
+}
+
+TEST_F(ChildCommandTest, SpillsValuesTooLongForOneArgument) {
+  std::string many = ids_;
+  while (many.size() < doptions::ChildCommand::maxArgLength()) {
+    many += "," + ids_;
+  }
+  reparse({"--id-list", many});
+  doptions::SpillConfig config;
+  config.argMax = 1U << 30U;
+  auto cmd = doptions::ChildCommand::fromState(app_, state_, "child", config);
+  EXPECT_EQ(cmd.files().size(), 1U);
+  EXPECT_LT(cmd.args()[2].size(), 64U);
+}
+
+TEST_F(ChildCommandTest, CommandArgumentsStayInline) {
+  reparse({"--id-list", ids_, "sync", "--target", paths_});
+  auto cmd =
+      doptions::ChildCommand::fromState(app_, state_, "child", smallLimit());
+  ASSERT_EQ(cmd.files().size(), 1U);
+  EXPECT_EQ(cmd.args().size(), 6U);
+  EXPECT_EQ(cmd.args()[3], "sync");
+  EXPECT_EQ(cmd.args()[5], paths_);
+  parseInChild(cmd);
+  EXPECT_EQ(parsedIds_.size(), 3000U);
+  EXPECT_TRUE(sync_);
+  EXPECT_EQ(target_, paths_);
+}
+
+TEST_F(ChildCommandTest, BuildsFromPlainParse) {
+  auto cmd = fromParse({"-v", "--id-list", ids_, "--name=worker", "sync",
+                        "--target", paths_},
+                       smallLimit());
+  ASSERT_EQ(cmd.files().size(), 1U);
+  EXPECT_EQ(cmd.args().size(), 8U);
+  EXPECT_EQ(cmd.args()[1], "-v");
+  EXPECT_TRUE(cmd.args()[3].starts_with("@/proc/self/fd/"));
+  EXPECT_EQ(cmd.args()[4], "--name=worker");
+  EXPECT_EQ(cmd.args()[7], paths_);
+  parseInChild(cmd);
+  EXPECT_EQ(parsedIds_.size(), 3000U);
+  EXPECT_EQ(name_, "worker");
+  EXPECT_TRUE(sync_);
+}
+
+TEST_F(ChildCommandTest, ValuesWithNewlinesStayInline) {
+  // Read from a file, "/c\nd" would be two elements.
+  std::string lines = paths_;
+  while (lines.size() < 2 * ids_.size()) {
+    lines += ",/c\nd";
+  }
+  reparse({"--paths", lines, "--id-list", ids_});
+  doptions::SpillConfig config = smallLimit();
+  config.argMax = lines.size() + 1024;
+  auto cmd = doptions::ChildCommand::fromState(app_, state_, "child", config);
+  ASSERT_EQ(cmd.files().size(), 1U);
+  EXPECT_EQ(cmd.args()[2], lines);
+  EXPECT_TRUE(cmd.args()[4].starts_with("@/proc/self/fd/"));
+  parseInChild(cmd);
+  EXPECT_EQ(parsedPaths_.size(), 2 + (lines.size() - paths_.size()) / 5);
+  EXPECT_EQ(parsedPaths_.back(), "/c\nd");
+  EXPECT_EQ(parsedIds_.size(), 3000U);
+}
+
+TEST_F(ChildCommandTest, AtFileValuesAreNotWrappedAgain) {
+  const std::string file = "/tmp/doptions-child-" + std::to_string(getpid());
+  std::ofstream(file) << paths_;
+  // A long spelling of the same path, so it is the largest value.
+  std::string path = "/tmp";
+  while (path.size() < 4000) {
+    path += "/.";
+  }
+  path += file.substr(4);
+  const std::string ids = ids_.substr(0, ids_.find(',', 3000));
+  reparse({"--paths", "@" + path, "--id-list", ids});
+  doptions::SpillConfig config = smallLimit();
+  config.argMax = 6000;
+  auto cmd = doptions::ChildCommand::fromState(app_, state_, "child", config);
+  ASSERT_EQ(cmd.files().size(), 1U);
+  EXPECT_EQ(cmd.args()[2], "@" + path);
+  EXPECT_TRUE(cmd.args()[4].starts_with("@/proc/self/fd/"));
+  parseInChild(cmd);
+  EXPECT_EQ(parsedPaths_, (std::vector<std::string>{"/data/a", "/data/b"}));
+  std::remove(file.c_str());
+}
+
+TEST_F(ChildCommandTest, ThrowsWhenNothingCanBeSpilled) {
+  reparse({"--name", ids_});
+  try {
+    static_cast<void>(
+        doptions::ChildCommand::fromState(app_, state_, "child", smallLimit()));
+    FAIL() << "Expected std::system_error";
+  } catch (const std::system_error& error) {
+    EXPECT_EQ(error.code().value(), E2BIG);
+  }
+}
+
+TEST_F(ChildCommandTest, RequiresSuccessfulParse) {
+  EXPECT_THROW(
+      static_cast<void>(doptions::ChildCommand::fromState(app_, state_, "c")),
+      std::logic_error);
+}
+
+TEST_F(ChildCommandTest, ChildReadsInheritedFile) {
+  reparse({"--id-list", ids_});
+  auto cmd =
+      doptions::ChildCommand::fromState(app_, state_, "/bin/sh", smallLimit());
+  ASSERT_EQ(cmd.files().size(), 1U);
+  // The child sees the same descriptor under its own /proc/self.
+  const std::string script = "test \"$(cat \"${0#@}\")\" = \"$1\"";
+  const std::string path = cmd.args()[2];
+  std::vector<std::string> args = {"/bin/sh", "-c", script, path, ids_};
+  std::vector<char*> argv;
+  for (auto& arg : args) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+  const pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    execv(argv[0], argv.data());
+    _exit(127);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
@@ -1,8 +1,10 @@
 #include <gtest/gtest.h>
 #include <doptions/command.hpp>
+#include <doptions/deprecations.hpp>
 #include <doptions/exceptions.hpp>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Test fixture for Command tests
@@ -679,3 +681,99 @@ TEST_F(CommandTest, ParseOptionsInDifferentOrder) {
   EXPECT_EQ(host, "example.com");
   EXPECT_TRUE(verbose);
 }
+
+// ============================================================================
+// parseCommand Tests - Case-Insensitive Matching
+// ============================================================================
+
+TEST_F(CommandTest, ParseCommandIgnoreCase) {
+  auto cmd = doptions::Command::createCommand("build");
+  int jobs = 0;
+  bool release = false;
+  cmd->addOption("-j,--jobs", &jobs);
+  cmd->addOption("--release", &release);
+  cmd->setMatchPolicy(doptions::MatchPolicy::IgnoreCase);
+
+  cmd->parseCommand({"-J", "4", "--Release"});
+  EXPECT_EQ(jobs, 4);
+  EXPECT_TRUE(release);
+}
+
+TEST_F(CommandTest, ParseCommandExactByDefault) {
+  auto cmd = doptions::Command::createCommand("build");
+  int jobs = 0;
+  cmd->addOption("--jobs", &jobs);
+  EXPECT_THROW(cmd->parseCommand({"--JOBS", "4"}), doptions::ParseException);
+}
+
+TEST_F(CommandTest, ParseCommandReusesIndexAcrossParses) {
+  auto cmd = doptions::Command::createCommand("build");
+  int jobs = 0;
+  cmd->addOption("--jobs", &jobs);
+  cmd->parseCommand({"--jobs", "2"});
+  EXPECT_EQ(jobs, 2);
+  EXPECT_GT(cmd->memoryUsage().lookupTables, 0U);
+
+  bool release = false;
+  cmd->addOption("--release", &release);
+  cmd->parseCommand({"--release"});
+  EXPECT_TRUE(release);
+}
+
+TEST_F(CommandTest, ParseCommandAliases) {
+  auto cmd = doptions::Command::createCommand("build");
+  int jobs = 0;
+  cmd->addOption("-j,--jobs", &jobs);
+  cmd->addAlias("--jobs", "--parallel");
+
+  cmd->parseCommand({"--parallel", "8"});
+  EXPECT_EQ(jobs, 8);
+  EXPECT_THROW(cmd->parseCommand({"--parallel", "8", "-j", "2"}),
+               doptions::ParseException);
+  EXPECT_THROW(cmd->addAlias("--missing", "--other"),
+               doptions::BuildException);
+}
+
+TEST_F(CommandTest, ParseCommandDeprecatedAlias) {
+  static std::vector<std::string> reported;
+  doptions::Deprecations::setHandler(
+      [](std::string_view name, std::string_view /*notice*/) {
+        reported.emplace_back(name);
+      });
+  auto cmd = doptions::Command::createCommand("build");
+  int jobs = 0;
+  cmd->addOption("--jobs", &jobs);
+  cmd->addDeprecatedAlias("--jobs", "--cmd-old-jobs", "use --jobs");
+
+  cmd->parseCommand({"--cmd-old-jobs", "3"});
+  cmd->parseCommand({"--cmd-old-jobs", "4"});
+  EXPECT_EQ(jobs, 4);
+  EXPECT_EQ(reported, std::vector<std::string>{"--cmd-old-jobs"});
+  doptions::Deprecations::setHandler(nullptr);
+  doptions::Deprecations::clear();
+}
+
+TEST_F(CommandTest, ParseCommandAttachedValue) {
+  auto cmd = doptions::Command::createCommand("build");
+  int jobs = 0;
+  bool release = false;
+  cmd->addOption("-j,--jobs", &jobs);
+  cmd->addOption("--release", &release);
+
+  cmd->parseCommand({"--jobs=12"});
+  EXPECT_EQ(jobs, 12);
+  EXPECT_THROW(cmd->parseCommand({"--release=yes"}),
+               doptions::ParseException);
+}
+
+TEST_F(CommandTest, ParseCommandAttachedValueConvertsLikeSeparate) {
+  auto cmd = doptions::Command::createCommand("build");
+  int jobs = 0;
+  cmd->addOption("-j,--jobs", &jobs);
+
+  cmd->parseCommand({"--jobs", "+5"});
+  EXPECT_EQ(jobs, 5);
+  jobs = 0;
+  cmd->parseCommand({"--jobs=+5"});
+  EXPECT_EQ(jobs, 5);
+}
@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <doptions/application.hpp>
+#include <doptions/exceptions.hpp>
+#include <doptions/list.hpp>
+#include <doptions/validations.hpp>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Builds and parses independent applications on many threads at once. Run
+// the doptions_stress_tests target, built with ThreadSanitizer, to have data
+// races reported instead of only crashes and wrong values.
+class ConcurrencyTest : public ::testing::Test {
+ protected:
+  static constexpr size_t threadCount = 8;
+  static constexpr size_t rounds = 200;
+
+  void SetUp() override {}
+
+  void TearDown() override {
+    doptions::NameValidations::setConfig(doptions::NameValidationConfig{});
+    doptions::ListConversions::setConfig(doptions::ListConversionConfig{});
+  }
+
+  // Builds a fresh application for the given seed, parses a command line
+  // derived from it and returns whether every bound value came out right.
+  static auto buildAndParse(size_t seed) -> bool {
+    auto app = doptions::Application::createApp();
+    int32_t number = 0;
+    std::string name;
+    bool verbose = false;
+    std::vector<int32_t> values;
+    bool executed = false;
+    int32_t level = 0;
+    app.addOption("-n,--number", &number);
+    app.addOption("--name", &name);
+    app.addOption("-v,--verbose", &verbose);
+    app.addOption("--values", &values);
+    auto& cmd = app.addCommand("process", &executed);
+    cmd->addOption("-l,--level", &level);
+
+    const std::string seedText = std::to_string(seed);
+    const std::string list = seedText + "," + seedText;
+    const char* argv[] = {"app",      "--number", seedText.c_str(),
+                          "--name",   "worker",   "-v",
+                          "--values", list.c_str(), "process",
+                          "--level",  seedText.c_str()};
+    app.parse(11, const_cast<char**>(argv));
+    return number == static_cast<int32_t>(seed) && name == "worker" &&
+           verbose && values.size() == 2 &&
+           values[1] == static_cast<int32_t>(seed) && executed &&
+           level == static_cast<int32_t>(seed);
+  }
+
+  // Runs body(thread, round) on threadCount threads and returns the number
+  // of calls that returned false or threw.
+  template <typename Body>
+  static auto runThreads(Body body) -> size_t {
+    std::atomic<size_t> failures{0};
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t thread = 0; thread < threadCount; ++thread) {
+      threads.emplace_back([&failures, &body, thread] {
+        for (size_t round = 0; round < rounds; ++round) {
+          try {
+            if (!body(thread, round)) {
+              failures.fetch_add(1, std::memory_order_relaxed);
+            }
+          } catch (...) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return failures.load();
+  }
+};
+
+// ============================================================================
+// Independent Applications
+// ============================================================================
+
+TEST_F(ConcurrencyTest, BuildAndParseOnManyThreads) {
+  const size_t failures = runThreads([](size_t thread, size_t round) {
+    return buildAndParse(thread * rounds + round);
+  });
+  EXPECT_EQ(failures, 0U);
+}
+
+TEST_F(ConcurrencyTest, ReparseSharedNothingApplications) {
+  const size_t failures = runThreads([](size_t thread, size_t /*round*/) {
+    thread_local auto app = doptions::Application::createApp();
+    thread_local int32_t value = 0;
+    thread_local bool registered = false;
+    if (!registered) {
+      app.addOption("--value", &value);
+      registered = true;
+    }
+    const std::string text = std::to_string(thread);
+    const char* argv[] = {"app", "--value", text.c_str()};
+    app.parse(3, const_cast<char**>(argv));
+    return value == static_cast<int32_t>(thread);
+  });
+  EXPECT_EQ(failures, 0U);
+}
+
+TEST_F(ConcurrencyTest, ErrorsOnManyThreads) {
+  const size_t failures = runThreads([](size_t /*thread*/, size_t round) {
+    auto app = doptions::Application::createApp();
+    int32_t number = 0;
+    app.addOption("--number", &number);
+    const std::string text = "bad" + std::to_string(round);
+    const char* argv[] = {"app", "--number", text.c_str()};
+    try {
+      app.parse(3, const_cast<char**>(argv));
+    } catch (const std::exception&) {
+      return true;
+    }
+    return false;
+  });
+  EXPECT_EQ(failures, 0U);
+}
+
+// ============================================================================
+// Shared Configuration
+// ============================================================================
+
+TEST_F(ConcurrencyTest, SetConfigWhileBuilding) {
+  std::atomic<bool> done{false};
+  std::thread writer([&done] {
+    doptions::NameValidationConfig config;
+    doptions::ListConversionConfig listConfig;
+    for (size_t idx = 0; !done.load(std::memory_order_relaxed); ++idx) {
+      // Every name the workers use stays valid under both configurations.
+      config.nameContainsDots = idx % 2 == 0;
+      config.reserverNames.assign(idx % 4, "reserved");
+      doptions::NameValidations::setConfig(config);
+      listConfig.parallelThreshold = idx % 2 == 0 ? 0 : size_t{1} << 20U;
+      listConfig.minChunkBytes = 1;
+      listConfig.maxThreads = 2;
+      doptions::ListConversions::setConfig(listConfig);
+      std::this_thread::yield();
+    }
+  });
+  const size_t failures = runThreads([](size_t thread, size_t round) {
+    return buildAndParse(thread * rounds + round);
+  });
+  done = true;
+  writer.join();
+  EXPECT_EQ(failures, 0U);
+}
+
+TEST_F(ConcurrencyTest, NewConfigVisibleToOtherThreads) {
+  EXPECT_THROW(doptions::NameValidations::validateName("with.dot"),
+               doptions::BuildException);
+  doptions::NameValidationConfig config;
+  config.nameContainsDots = true;
+  doptions::NameValidations::setConfig(config);
+  EXPECT_NO_THROW(doptions::NameValidations::validateName("with.dot"));
+
+  bool accepted = false;
+  std::thread reader([&accepted] {
+    try {
+      doptions::NameValidations::validateName("with.dot");
+      accepted = true;
+    } catch (const doptions::BuildException&) {
+      accepted = false;
+    }
+  });
+  reader.join();
+  EXPECT_TRUE(accepted);
+}
+
+TEST_F(ConcurrencyTest, ParallelListsOnManyThreads) {
+  doptions::ListConversionConfig config;
+  config.parallelThreshold = 0;
+  config.minChunkBytes = 1;
+  config.maxThreads = 2;
+  doptions::ListConversions::setConfig(config);
+  const size_t failures = runThreads([](size_t thread, size_t round) {
+    const auto values = doptions::ListConversions::convert<int32_t>(
+        std::to_string(thread) + ",1,2,3," + std::to_string(round));
+    return values.size() == 5 && values[0] == static_cast<int32_t>(thread) &&
+           values[4] == static_cast<int32_t>(round);
+  });
+  EXPECT_EQ(failures, 0U);
+}
+
+// ============================================================================
+// Parallel Parse
+// ============================================================================
+
+// Application with many int options parsed with conversions split over
+// several threads, whatever the size of the command line.
+class ParallelParseTest : public ::testing::Test {
+ protected:
+  static constexpr size_t optionCount = 512;
+
+  void SetUp() override {
+    for (size_t idx = 0; idx < optionCount; ++idx) {
+      app_.addOption(name(idx), &values_[idx]);
+    }
+    app_.addOption("-v,--verbose", &verbose_);
+    app_.addOption("--names", &names_);
+    app_.addCommand("execute", &run_)->addOption("--level", &level_);
+    doptions::ParallelParseConfig config;
+    config.threshold = 0;
+    config.minChunkValues = 1;
+    config.maxThreads = 4;
+    app_.setParallelParse(config);
+  }
+
+  void TearDown() override {}
+
+  static auto name(size_t idx) -> std::string {
+    return "--value-" + std::to_string(idx);
+  }
+
+  auto parse(const std::vector<std::string>& args) -> void {
+    std::vector<const char*> argv{"app"};
+    for (const auto& arg : args) {
+      argv.push_back(arg.c_str());
+    }
+    app_.parse(static_cast<int32_t>(argv.size()),
+               const_cast<char**>(argv.data()));
+  }
+
+  // Every option with its index as value.
+  static auto allValues() -> std::vector<std::string> {
+    std::vector<std::string> args;
+    for (size_t idx = 0; idx < optionCount; ++idx) {
+      args.push_back(name(idx));
+      args.push_back(std::to_string(idx));
+    }
+    return args;
+  }
+
+  // Message of the exception parse throws, or an empty string.
+  auto parseError(const std::vector<std::string>& args) -> std::string {
+    try {
+      parse(args);
+    } catch (const std::exception& error) {
+      return error.what();
+    }
+    return {};
+  }
+
+  std::vector<int32_t> values_ = std::vector<int32_t>(optionCount, -1);
+  bool verbose_{false};
+  std::vector<std::string> names_;
+  bool run_{false};
+  int32_t level_{0};
+  doptions::Application app_ = doptions::Application::createApp();
+};
+
+TEST_F(ParallelParseTest, ConvertsEveryValue) {
+  size_t notified = 0;
+  auto count = [&notified](const doptions::OptionBase&) { ++notified; };
+  app_.addObserver(name(0), count);
+  app_.addObserver(name(optionCount - 1), count);
+  parse(allValues());
+  for (size_t idx = 0; idx < optionCount; ++idx) {
+    EXPECT_EQ(values_[idx], static_cast<int32_t>(idx));
+  }
+  EXPECT_EQ(notified, 2U);
+}
+
+TEST_F(ParallelParseTest, FlagsAttachedValuesAndCommands) {
+  auto args = allValues();
+  args.erase(args.begin(), args.begin() + 2);
+  args.insert(args.begin(), "--value-0=42");
+  args.insert(args.begin() + 3, "-v");
+  args.emplace_back("--names");
+  args.emplace_back("a,b");
+  args.emplace_back("execute");
+  args.emplace_back("--level");
+  args.emplace_back("3");
+  parse(args);
+  EXPECT_EQ(values_[0], 42);
+  EXPECT_EQ(values_[1], 1);
+  EXPECT_TRUE(verbose_);
+  EXPECT_EQ(names_, (std::vector<std::string>{"a", "b"}));
+  EXPECT_TRUE(run_);
+  EXPECT_EQ(level_, 3);
+}
+
+TEST_F(ParallelParseTest, AttachedValuesConvertLikeSeparateValues) {
+  parse({"--value-0=+5", "--value-1", "+5"});
+  EXPECT_EQ(values_[0], 5);
+  EXPECT_EQ(values_[1], 5);
+}
+
+TEST_F(ParallelParseTest, EarliestConversionErrorWins) {
+  auto args = allValues();
+  args[2 * 100 + 1] = "3000000001";
+  args[2 * 400 + 1] = "3000000002";
+  for (size_t round = 0; round < 20; ++round) {
+    EXPECT_NE(parseError(args).find("3000000001"), std::string::npos);
+  }
+}
+
+TEST_F(ParallelParseTest, ConversionErrorBeforeScanError) {
+  auto args = allValues();
+  args[2 * 100 + 1] = "3000000001";
+  args.emplace_back("--unknown");
+  EXPECT_NE(parseError(args).find("3000000001"), std::string::npos);
+
+  args[2 * 100 + 1] = "100";
+  args[2 * 400 + 1] = "bad";
+  args.insert(args.begin() + 2 * 200, "--unknown");
+  const auto message = parseError(args);
+  EXPECT_NE(message.find("Unknown argument: --unknown"), std::string::npos);
+}
+
+TEST_F(ParallelParseTest, RepeatedOptionThrows) {
+  auto args = allValues();
+  args.emplace_back(name(7));
+  args.emplace_back("7");
+  EXPECT_NE(parseError(args).find("multiple times"), std::string::npos);
+}
+
+TEST_F(ParallelParseTest, SmallCommandLinesStaySequential) {
+  doptions::ParallelParseConfig config;
+  config.threshold = 4;
+  app_.setParallelParse(config);
+  parse({name(1), "1"});
+  EXPECT_EQ(values_[1], 1);
+  app_.setParallelParse(std::nullopt);
+  parse(allValues());
+  EXPECT_EQ(values_[optionCount - 1], static_cast<int32_t>(optionCount - 1));
+}
@@ -1,8 +1,11 @@
+#include <doptions/application.hpp>
+#include <doptions/convert_context.hpp>
 #include <doptions/option.hpp>
 #include <doptions/exceptions.hpp>
 #include <gtest/gtest.h>
 #include <algorithm>
 #include <map>
+#include <memory_resource>
 #include <set>
 #include <sstream>
 #include <stdexcept>
@@ -853,3 +856,162 @@ TEST_F(CustomStructuresTest, SetSorted) {
   ++it;
   EXPECT_EQ(*it, 3);
 }
+
+// ============================================================================
+// Context Converters - Arena-backed Polygon
+// ============================================================================
+
+struct ArenaPolygon {
+  std::span<Point> vertices;
+  size_t optionId{doptions::ConvertContext::noOption};
+};
+
+REGISTER_CONTEXT_TYPE(ArenaPolygon) {
+  // Format: "(x1,y1);(x2,y2);..." with vertices placed in the context memory
+  const auto count = static_cast<size_t>(std::count(str.begin(), str.end(),
+                                                    ';')) + 1;
+  if (count < 3) {
+    context.errors().report(doptions::ParseException::invalidValue(str));
+    return {};
+  }
+  auto vertices = context.allocate<Point>(count);
+  size_t start = 0;
+  for (auto& vertex : vertices) {
+    const size_t end = std::min(str.find(';', start), str.size());
+    vertex = doptions::fromStr<Point>(std::string(str.substr(start,
+                                                             end - start)));
+    start = end + 1;
+  }
+  return {vertices, context.optionId()};
+}
+
+// Memory resource counting the bytes requested from it.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t bytes{0};
+
+ private:
+  auto do_allocate(size_t size, size_t align) -> void* override {
+    bytes += size;
+    return std::pmr::new_delete_resource()->allocate(size, align);
+  }
+
+  auto do_deallocate(void* ptr, size_t size, size_t align) -> void override {
+    std::pmr::new_delete_resource()->deallocate(ptr, size, align);
+  }
+
+  [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other)
+      const noexcept -> bool override {
+    return this == &other;
+  }
+};
+
+TEST_F(CustomStructuresTest, ContextConverterUsesContextMemory) {
+  CountingResource counting;
+  std::pmr::monotonic_buffer_resource upstream(&counting);
+  doptions::ConvertContext context(&upstream, 7);
+  auto polygon =
+      doptions::fromStr<ArenaPolygon>("(0,0);(1,0);(1,1)", context);
+  ASSERT_EQ(polygon.vertices.size(), 3U);
+  EXPECT_EQ(polygon.vertices[2], (Point{1, 1}));
+  EXPECT_EQ(polygon.optionId, 7U);
+  EXPECT_GT(counting.bytes, 0U);
+  EXPECT_FALSE(context.errors().failed());
+  EXPECT_EQ(context.store("text"), "text");
+}
+
+TEST_F(CustomStructuresTest, ContextConverterStandaloneOption) {
+  ArenaPolygon polygon{};
+  auto opt =
+      doptions::Option<ArenaPolygon>::createOption("--polygon", &polygon);
+  EXPECT_TRUE(opt->takesContext());
+  opt->parseValue("(0,0);(2,0);(2,2);(0,2)");
+  ASSERT_EQ(polygon.vertices.size(), 4U);
+  EXPECT_EQ(polygon.vertices[1], (Point{2, 0}));
+  EXPECT_EQ(polygon.optionId, doptions::ConvertContext::noOption);
+}
+
+TEST_F(CustomStructuresTest, ContextConverterReportedErrorThrows) {
+  ArenaPolygon polygon{};
+  auto opt =
+      doptions::Option<ArenaPolygon>::createOption("--polygon", &polygon);
+  opt->parseValue("(0,0);(1,0);(1,1)");
+  try {
+    opt->parseValue("(0,0);(1,1)");
+    FAIL() << "Expected ParseException";
+  } catch (const doptions::ParseException& error) {
+    EXPECT_EQ(error.text(), "(0,0);(1,1)");
+  }
+  EXPECT_EQ(polygon.vertices.size(), 3U);
+}
+
+TEST_F(CustomStructuresTest, ContextConverterInApplication) {
+  auto app = doptions::Application::createApp();
+  int32_t count = 0;
+  ArenaPolygon polygon{};
+  app.addOption("--count", &count);
+  app.addOption("--polygon", &polygon);
+  const char* argv[] = {"app", "--count", "1", "--polygon",
+                        "(0,0);(1,0);(1,1)"};
+  app.parse(5, const_cast<char**>(argv));
+  ASSERT_EQ(polygon.vertices.size(), 3U);
+  EXPECT_EQ(polygon.optionId, 1U);
+
+  app.releaseConversionMemory();
+  EXPECT_TRUE(polygon.vertices.empty());
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(CustomStructuresTest, ContextConverterReparseAfterRelease) {
+  auto app = doptions::Application::createApp();
+  ArenaPolygon polygon{};
+  app.addOption("--polygon", &polygon);
+  doptions::ParseState state;
+  const char* argv[] = {"app", "--polygon", "(0,0);(1,0);(1,1)"};
+  app.reparse(state, 3, const_cast<char**>(argv));
+  app.releaseConversionMemory();
+  app.reparse(state, 3, const_cast<char**>(argv));
+  ASSERT_EQ(polygon.vertices.size(), 3U);
+  EXPECT_EQ(polygon.vertices[1], (Point{1, 0}));
+}
+
+TEST_F(CustomStructuresTest, ContextConverterParseDropsPreviousArena) {
+  auto app = doptions::Application::createApp();
+  int32_t count = 0;
+  ArenaPolygon polygon{};
+  app.addOption("--count", &count);
+  app.addOption("--polygon", &polygon);
+  const char* first[] = {"app", "--polygon", "(0,0);(1,0);(1,1)"};
+  app.parse(3, const_cast<char**>(first));
+  ASSERT_EQ(polygon.vertices.size(), 3U);
+
+  const char* second[] = {"app", "--count", "2"};
+  app.parse(3, const_cast<char**>(second));
+  EXPECT_TRUE(polygon.vertices.empty());
+  EXPECT_EQ(count, 2);
+}
+
+TEST_F(CustomStructuresTest, ContextConverterStandaloneReleaseMemory) {
+  ArenaPolygon polygon{};
+  auto opt =
+      doptions::Option<ArenaPolygon>::createOption("--polygon", &polygon);
+  opt->parseValue("(0,0);(1,0);(1,1)");
+  opt->releaseMemory();
+  EXPECT_TRUE(polygon.vertices.empty());
+  opt->parseValue("(0,0);(2,0);(2,2)");
+  ASSERT_EQ(polygon.vertices.size(), 3U);
+  EXPECT_EQ(polygon.vertices[2], (Point{2, 2}));
+}
+
+TEST_F(CustomStructuresTest, ContextConverterCommandReleasesMemory) {
+  auto app = doptions::Application::createApp();
+  bool draw = false;
+  ArenaPolygon polygon{};
+  app.addCommand("draw", &draw)->addOption("--polygon", &polygon);
+  const char* argv[] = {"app", "draw", "--polygon", "(0,0);(1,0);(1,1)"};
+  app.parse(4, const_cast<char**>(argv));
+  ASSERT_EQ(polygon.vertices.size(), 3U);
+
+  app.releaseConversionMemory();
+  EXPECT_TRUE(polygon.vertices.empty());
+}
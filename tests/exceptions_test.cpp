@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <doptions/exceptions.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "allocation_counter.hpp"
+
+// Test fixture for exception tests
+class ExceptionsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+// ============================================================================
+// Message Tests
+// ============================================================================
+
+TEST_F(ExceptionsTest, UnknownArgMessage) {
+  auto error = doptions::ParseException::unknownArg("--nope");
+  EXPECT_STREQ(error.what(), "Parse Exception: Unknown argument: --nope");
+  EXPECT_EQ(error.text(), "--nope");
+}
+
+TEST_F(ExceptionsTest, MultiArgMessage) {
+  auto error = doptions::ParseException::multiArg("-v, --verbose, ");
+  EXPECT_STREQ(error.what(),
+               "Parse Exception: Same argument appears multiple times: -v, "
+               "--verbose, ");
+}
+
+TEST_F(ExceptionsTest, OutOfRangeMessage) {
+  auto error = doptions::ParseException::outOfRange<int8_t>(-200);
+  EXPECT_STREQ(error.what(),
+               "Parse Exception: Value out of range: -200 (-128 - 127)");
+  auto unsignedError = doptions::ParseException::outOfRange<uint16_t>(70000);
+  EXPECT_STREQ(unsignedError.what(),
+               "Parse Exception: Value out of range: 70000 (0 - 65535)");
+}
+
+TEST_F(ExceptionsTest, InvalidSizeMessage) {
+  auto error = doptions::BuildException::invalidSize("abcd", 0, 3, true);
+  EXPECT_STREQ(error.what(),
+               "Build Exception: Name has invalid size: abcd (4) [short: 0-3]");
+  auto longError = doptions::BuildException::invalidSize("ab", 3, 100, false);
+  EXPECT_STREQ(longError.what(),
+               "Build Exception: Name has invalid size: ab (2) [long: 3-100]");
+}
+
+TEST_F(ExceptionsTest, LongTextIsTruncated) {
+  std::string name(1000, 'x');
+  auto error = doptions::ParseException::unknownArg(name);
+  std::string message = error.what();
+  EXPECT_LT(message.size(), doptions::InlineException::messageCapacity);
+  EXPECT_EQ(message.substr(message.size() - 3), "...");
+}
+
+TEST_F(ExceptionsTest, CatchableAsBaseTypes) {
+  EXPECT_THROW(throw doptions::ParseException::unknownArg("x"),
+               doptions::DOptionsException);
+  EXPECT_THROW(throw doptions::BuildException::emptyName("x"),
+               std::invalid_argument);
+}
+
+TEST_F(ExceptionsTest, CopyKeepsMessage) {
+  auto error = doptions::ParseException::insufficientValues("--port");
+  auto copy = error;
+  EXPECT_STREQ(copy.what(), error.what());
+}
+
+// ============================================================================
+// Allocation Tests
+// ============================================================================
+
+TEST_F(ExceptionsTest, CreatingAndFormattingDoesNotAllocate) {
+  const std::string arg = "--some-rather-long-argument-name";
+  const size_t before = allocationCount();
+  auto error = doptions::ParseException::unknownArg(arg);
+  auto range = doptions::ParseException::outOfRange<int32_t>(1LL << 40);
+  auto size = doptions::BuildException::invalidSize(arg, 3, 100, false);
+  const char* first = error.what();
+  const char* second = range.what();
+  const char* third = size.what();
+  const size_t after = allocationCount();
+  EXPECT_EQ(after, before);
+  EXPECT_NE(first[0], '\0');
+  EXPECT_NE(second[0], '\0');
+  EXPECT_NE(third[0], '\0');
+}
+
+TEST_F(ExceptionsTest, CatchingAndReadingDoesNotAllocate) {
+  size_t before = 0;
+  size_t after = 0;
+  try {
+    before = allocationCount();
+    throw doptions::ParseException::multiArg("--verbose");
+  } catch (const doptions::DOptionsException& error) {
+    EXPECT_NE(error.what()[0], '\0');
+    after = allocationCount();
+  }
+  EXPECT_EQ(after, before);
+}
+
+TEST_F(ExceptionsTest, WhatIsSafeFromManyThreads) {
+  auto error = std::make_exception_ptr(
+      doptions::ParseException::outOfRange<int32_t>(1LL << 40));
+  std::vector<std::string> messages(4);
+  std::vector<std::thread> threads;
+  for (size_t idx = 0; idx < messages.size(); ++idx) {
+    threads.emplace_back([&error, &messages, idx] {
+      try {
+        std::rethrow_exception(error);
+      } catch (const doptions::ParseException& caught) {
+        messages[idx] = caught.what();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& message : messages) {
+    EXPECT_EQ(message,
+              "Parse Exception: Value out of range: 1099511627776 "
+              "(-2147483648 - 2147483647)");
+  }
+}
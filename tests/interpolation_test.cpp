@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <doptions/application.hpp>
+#include <doptions/arena.hpp>
+#include <doptions/exceptions.hpp>
+#include <doptions/interpolation.hpp>
+#include <string>
+#include <vector>
+
+// Test fixture for ${name} interpolation tests
+class InterpolationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    setenv("DOPTIONS_TEST_HOME", "/home/user", 1);
+    unsetenv("DOPTIONS_TEST_UNSET");
+    app_.addOption("--data-dir", &dataDir_);
+    app_.addOption("--cache-dir", &cacheDir_);
+    app_.addOption("--log-file", &log_);
+    app_.addOption("--port", &port_);
+    app_.setInterpolation(true);
+  }
+
+  void TearDown() override { unsetenv("DOPTIONS_TEST_HOME"); }
+
+  auto parse(std::vector<const char*> args) -> void {
+    args.insert(args.begin(), "app");
+    app_.parse(static_cast<int32_t>(args.size()),
+               const_cast<char**>(args.data()));
+  }
+
+  auto reparse(std::vector<const char*> args) -> void {
+    args.insert(args.begin(), "app");
+    app_.reparse(state_, static_cast<int32_t>(args.size()),
+                 const_cast<char**>(args.data()));
+  }
+
+  std::string dataDir_;
+  std::string cacheDir_{"default-cache"};
+  std::string log_;
+  int32_t port_{0};
+  doptions::ParseState state_;
+  doptions::Application app_ = doptions::Application::createApp();
+};
+
+// ============================================================================
+// Expansion
+// ============================================================================
+
+TEST_F(InterpolationTest, ExpandsEnvironmentVariables) {
+  parse({"--data-dir", "${DOPTIONS_TEST_HOME}/data"});
+  EXPECT_EQ(dataDir_, "/home/user/data");
+}
+
+TEST_F(InterpolationTest, ExpandsOtherOptions) {
+  parse({"--data-dir", "/srv", "--cache-dir", "${data-dir}/cache"});
+  EXPECT_EQ(cacheDir_, "/srv/cache");
+}
+
+TEST_F(InterpolationTest, ReferenceMayPrecedeTheOption) {
+  parse({"--cache-dir", "${--data-dir}/cache", "--data-dir", "/srv"});
+  EXPECT_EQ(cacheDir_, "/srv/cache");
+}
+
+TEST_F(InterpolationTest, ExpandsChainsOfReferences) {
+  parse({"--log-file", "${cache-dir}/log", "--cache-dir",
+         "${data-dir}/cache", "--data-dir", "${DOPTIONS_TEST_HOME}"});
+  EXPECT_EQ(log_, "/home/user/cache/log");
+  EXPECT_EQ(cacheDir_, "/home/user/cache");
+  EXPECT_EQ(dataDir_, "/home/user");
+}
+
+TEST_F(InterpolationTest, NonStringOptionsCanBeReferenced) {
+  parse({"--port", "8080", "--log-file", "port-${port}.log"});
+  EXPECT_EQ(port_, 8080);
+  EXPECT_EQ(log_, "port-8080.log");
+}
+
+TEST_F(InterpolationTest, OptionsTakePrecedenceOverEnvironment) {
+  app_.addOption("--doptions-test-home", &log_);
+  parse({"--doptions-test-home", "/opt", "--data-dir",
+         "${doptions-test-home}"});
+  EXPECT_EQ(dataDir_, "/opt");
+}
+
+TEST_F(InterpolationTest, OptionNotGivenFallsBackToEnvironment) {
+  EXPECT_THROW(parse({"--data-dir", "${cache-dir}"}),
+               doptions::ParseException);
+  setenv("cache-dir", "/env", 1);
+  parse({"--data-dir", "${cache-dir}"});
+  unsetenv("cache-dir");
+  EXPECT_EQ(dataDir_, "/env");
+}
+
+TEST_F(InterpolationTest, DollarEscapesAndLoneDollars) {
+  parse({"--data-dir", "$${DOPTIONS_TEST_HOME}", "--log-file", "cost $5 $"});
+  EXPECT_EQ(dataDir_, "${DOPTIONS_TEST_HOME}");
+  EXPECT_EQ(log_, "cost $5 $");
+}
+
+TEST_F(InterpolationTest, AttachedValues) {
+  parse({"--data-dir=${DOPTIONS_TEST_HOME}", "--log-file=${data-dir}/a=b"});
+  EXPECT_EQ(dataDir_, "/home/user");
+  EXPECT_EQ(log_, "/home/user/a=b");
+}
+
+TEST_F(InterpolationTest, DisabledByDefault) {
+  app_.setInterpolation(false);
+  EXPECT_FALSE(app_.interpolation());
+  parse({"--data-dir", "${DOPTIONS_TEST_HOME}"});
+  EXPECT_EQ(dataDir_, "${DOPTIONS_TEST_HOME}");
+}
+
+TEST_F(InterpolationTest, ExpandsJsonValues) {
+  app_.parseJson(R"({"data-dir": "${DOPTIONS_TEST_HOME}\/data",
+                     "cache-dir": "${data-dir}/cache"})");
+  EXPECT_EQ(dataDir_, "/home/user/data");
+  EXPECT_EQ(cacheDir_, "/home/user/data/cache");
+}
+
+// ============================================================================
+// Errors
+// ============================================================================
+
+TEST_F(InterpolationTest, UnresolvedReferenceThrows) {
+  try {
+    parse({"--data-dir", "${DOPTIONS_TEST_UNSET}"});
+    FAIL() << "Expected ParseException";
+  } catch (const doptions::ParseException& error) {
+    EXPECT_EQ(error.text(), "DOPTIONS_TEST_UNSET");
+  }
+}
+
+TEST_F(InterpolationTest, CycleThrows) {
+  EXPECT_THROW(
+      parse({"--data-dir", "${cache-dir}", "--cache-dir", "${log-file}/x",
+             "--log-file", "${data-dir}"}),
+      doptions::ParseException);
+}
+
+TEST_F(InterpolationTest, SelfReferenceThrows) {
+  EXPECT_THROW(parse({"--data-dir", "a${data-dir}"}),
+               doptions::ParseException);
+}
+
+TEST_F(InterpolationTest, UnterminatedReferenceThrows) {
+  EXPECT_THROW(parse({"--data-dir", "${DOPTIONS_TEST_HOME"}),
+               doptions::ParseException);
+  EXPECT_THROW(parse({"--data-dir", "${}"}), doptions::ParseException);
+}
+
+TEST_F(InterpolationTest, ParseAfterErrorStartsClean) {
+  EXPECT_THROW(parse({"--data-dir", "${cache-dir}", "--cache-dir",
+                      "${data-dir}"}),
+               doptions::ParseException);
+  parse({"--data-dir", "${DOPTIONS_TEST_HOME}"});
+  EXPECT_EQ(dataDir_, "/home/user");
+}
+
+// ============================================================================
+// Reparse
+// ============================================================================
+
+TEST_F(InterpolationTest, ReparseFollowsReferencedOptions) {
+  reparse({"--data-dir", "/a", "--cache-dir", "${data-dir}/cache"});
+  EXPECT_EQ(cacheDir_, "/a/cache");
+  reparse({"--data-dir", "/b", "--cache-dir", "${data-dir}/cache"});
+  EXPECT_EQ(cacheDir_, "/b/cache");
+  reparse({"--data-dir", "/b"});
+  EXPECT_EQ(cacheDir_, "default-cache");
+}
+
+TEST_F(InterpolationTest, ReparseFollowsEnvironment) {
+  int32_t notified = 0;
+  auto count = [&notified](const doptions::OptionBase&) { ++notified; };
+  app_.addObserver("--data-dir", count);
+  reparse({"--data-dir", "${DOPTIONS_TEST_HOME}"});
+  reparse({"--data-dir", "${DOPTIONS_TEST_HOME}"});
+  EXPECT_EQ(notified, 1);
+  setenv("DOPTIONS_TEST_HOME", "/root", 1);
+  reparse({"--data-dir", "${DOPTIONS_TEST_HOME}"});
+  EXPECT_EQ(dataDir_, "/root");
+  EXPECT_EQ(notified, 2);
+}
+
+// ============================================================================
+// Interpolator and Arena
+// ============================================================================
+
+TEST(InterpolatorTest, ValueWithoutReferencesIsNotCopied) {
+  doptions::Interpolator interpolator;
+  interpolator.begin(1);
+  const std::string raw = "plain $value";
+  EXPECT_TRUE(interpolator.record(0, raw, true));
+  auto resolve = [](std::string_view) -> std::optional<size_t> {
+    return std::nullopt;
+  };
+  const auto expanded = interpolator.expand(0, resolve);
+  EXPECT_EQ(expanded, raw);
+  EXPECT_EQ(expanded.data(), raw.data());
+}
+
+TEST(InterpolatorTest, OnlyInterpolatingValuesWithDollarArePending) {
+  doptions::Interpolator interpolator;
+  interpolator.begin(3);
+  EXPECT_FALSE(interpolator.record(0, "plain", true));
+  EXPECT_FALSE(interpolator.record(1, "${x}", false));
+  EXPECT_TRUE(interpolator.record(2, "${x}", true));
+  EXPECT_EQ(interpolator.pending(), std::vector<size_t>{2});
+}
+
+TEST(ArenaTest, StoresAcrossChunksAndMergesOnReset) {
+  doptions::Arena arena(8);
+  const auto first = arena.store("12345");
+  const auto second = arena.store("abcdefghij");
+  EXPECT_EQ(first, "12345");
+  EXPECT_EQ(second, "abcdefghij");
+  EXPECT_EQ(arena.capacity(), 18U);
+  arena.reset();
+  EXPECT_EQ(arena.capacity(), 18U);
+  const auto third = arena.store("0123456789abcdef");
+  EXPECT_EQ(third, "0123456789abcdef");
+  EXPECT_EQ(arena.capacity(), 18U);
+}
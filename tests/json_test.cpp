@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include <doptions/application.hpp>
+#include <doptions/exceptions.hpp>
+#include <doptions/json.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Test fixture for JSON ingestion tests
+class JsonTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    app_.addOption("-p,--port", &port_);
+    app_.addOption("--host", &host_);
+    app_.addOption("-v,--verbose", &verbose_);
+    app_.addOption("--ratio", &ratio_);
+    app_.addOption("--level", &level_);
+  }
+
+  void TearDown() override {}
+
+  static auto charsAt(std::string_view json,
+                      const std::vector<uint32_t>& positions) -> std::string {
+    std::string chars;
+    for (auto pos : positions) {
+      chars.push_back(json[pos]);
+    }
+    return chars;
+  }
+
+  doptions::Application app_ = doptions::Application::createApp();
+  int32_t port_{80};
+  std::string host_{"localhost"};
+  bool verbose_{false};
+  double ratio_{0.0};
+  uint8_t level_{1};
+};
+
+// ============================================================================
+// Structural Index Tests
+// ============================================================================
+
+TEST_F(JsonTest, IndexSkipsStructuralCharactersInStrings) {
+  std::string_view json = R"({"a": "x,y:{z}", "b": [1, 2]})";
+  auto index = doptions::StructuralIndex::build(json);
+  EXPECT_EQ(charsAt(json, index.positions()), R"({"":"","":[,]})");
+}
+
+TEST_F(JsonTest, IndexHandlesEscapesAcrossBlocks) {
+  // Place a backslash run right at the end of the first 64-byte block so the
+  // escape carries into the next one.
+  std::string value(61, 'x');
+  value += R"(\\\")";
+  std::string json = R"({")" + value + R"(": 1})";
+  ASSERT_GT(json.size(), 64U);
+  auto index = doptions::StructuralIndex::build(json);
+  EXPECT_EQ(charsAt(json, index.positions()), R"({"":})");
+}
+
+TEST_F(JsonTest, IndexMatchesAcrossLongDocuments) {
+  std::string json = "{";
+  for (int idx = 0; idx < 200; ++idx) {
+    json += R"("k)" + std::to_string(idx) + R"(": "v\"\\,",)";
+  }
+  json += R"("end": true})";
+  auto index = doptions::StructuralIndex::build(json);
+  std::string expected = "{";
+  for (int idx = 0; idx < 200; ++idx) {
+    expected += R"("":"",)";
+  }
+  expected += R"("":})";
+  EXPECT_EQ(charsAt(json, index.positions()), expected);
+}
+
+TEST_F(JsonTest, IndexRejectsUnterminatedString) {
+  EXPECT_THROW(doptions::StructuralIndex::build(R"({"a": "open})"),
+               doptions::ParseException);
+}
+
+// ============================================================================
+// Binding Tests
+// ============================================================================
+
+TEST_F(JsonTest, BindsScalars) {
+  app_.parseJson(
+      R"({"port": 9090, "host": "example.org", "verbose": true,
+          "ratio": 0.25, "level": 7})");
+  EXPECT_EQ(port_, 9090);
+  EXPECT_EQ(host_, "example.org");
+  EXPECT_TRUE(verbose_);
+  EXPECT_DOUBLE_EQ(ratio_, 0.25);
+  EXPECT_EQ(level_, 7);
+}
+
+TEST_F(JsonTest, KeysMayUseShortNamesOrDashes) {
+  app_.parseJson(R"({"p": 1, "--host": "a", "-v": true})");
+  EXPECT_EQ(port_, 1);
+  EXPECT_EQ(host_, "a");
+  EXPECT_TRUE(verbose_);
+}
+
+TEST_F(JsonTest, DecodesEscapes) {
+  app_.parseJson(R"({"host": "a\"b\\c\n\u00e9\ud83d\ude00", "port": 3})");
+  EXPECT_EQ(host_, "a\"b\\c\n\xc3\xa9\xf0\x9f\x98\x80");
+  EXPECT_EQ(port_, 3);
+}
+
+TEST_F(JsonTest, NullLeavesDefault) {
+  app_.parseJson(R"({"port": null, "host": "x"})");
+  EXPECT_EQ(port_, 80);
+  EXPECT_EQ(host_, "x");
+}
+
+TEST_F(JsonTest, EmptyObject) {
+  EXPECT_NO_THROW(app_.parseJson(" { } "));
+  EXPECT_EQ(port_, 80);
+}
+
+TEST_F(JsonTest, NestedValuesArePassedRaw) {
+  std::string list;
+  app_.addOption("--list", &list);
+  app_.parseJson(R"({"list": [1, [2, 3], {"a": "]"}], "port": 5})");
+  EXPECT_EQ(list, R"([1, [2, 3], {"a": "]"}])");
+  EXPECT_EQ(port_, 5);
+}
+
+TEST_F(JsonTest, IntegerArraysBindToLists) {
+  std::vector<int32_t> ids;
+  app_.addOption("--idents", &ids);
+  app_.parseJson(R"({"idents": [1, 2, 3]})");
+  EXPECT_EQ(ids, (std::vector<int32_t>{1, 2, 3}));
+}
+
+TEST_F(JsonTest, StringArraysBindToListsDecoded) {
+  std::vector<std::string> names;
+  app_.addOption("--names", &names);
+  app_.parseJson(R"({"names": ["a", "b,c", "d\"\u00e9", ""]})");
+  EXPECT_EQ(names,
+            (std::vector<std::string>{"a", "b,c", "d\"\xc3\xa9", ""}));
+
+  app_.parseJson(R"({"names": []})");
+  EXPECT_TRUE(names.empty());
+  EXPECT_THROW(app_.parseJson(R"({"names": ["a",]})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"names": ["a" "b"]})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"names": [["a"]]})"),
+               doptions::ParseException);
+}
+
+TEST_F(JsonTest, MismatchedBracketsThrow) {
+  std::string list;
+  app_.addOption("--list", &list);
+  EXPECT_THROW(app_.parseJson(R"({"list": [1, 2}, "port": 1})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"list": {"a": [1}]})"),
+               doptions::ParseException);
+  EXPECT_EQ(list, "");
+}
+
+TEST_F(JsonTest, UnknownEscapesThrow) {
+  EXPECT_THROW(app_.parseJson(R"({"host": "a\xb"})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"host": "\'"})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"\host": "a"})"),
+               doptions::ParseException);
+  app_.parseJson(R"({"host": "a\/b"})");
+  EXPECT_EQ(host_, "a/b");
+}
+
+TEST_F(JsonTest, FiresObservers) {
+  int calls = 0;
+  auto observer = [&calls](const doptions::OptionBase&) { ++calls; };
+  app_.addObserver("--port", observer);
+  app_.addObserver("--host", observer);
+  app_.parseJson(R"({"port": 1})");
+  EXPECT_EQ(calls, 1);
+}
+
+// ============================================================================
+// Error Tests
+// ============================================================================
+
+TEST_F(JsonTest, UnknownKeyThrows) {
+  EXPECT_THROW(app_.parseJson(R"({"missing": 1})"),
+               doptions::ParseException);
+}
+
+TEST_F(JsonTest, DuplicateKeyThrows) {
+  EXPECT_THROW(app_.parseJson(R"({"port": 1, "p": 2})"),
+               doptions::ParseException);
+}
+
+TEST_F(JsonTest, InvalidNumberThrows) {
+  EXPECT_THROW(app_.parseJson(R"({"port": 12abc})"), std::invalid_argument);
+  EXPECT_THROW(app_.parseJson(R"({"level": 300})"), doptions::ParseException);
+}
+
+TEST_F(JsonTest, SixtyFourBitOverflowThrows) {
+  int64_t wide = 0;
+  uint64_t unsignedWide = 0;
+  app_.addOption("--wide", &wide);
+  app_.addOption("--unsigned-wide", &unsignedWide);
+  EXPECT_THROW(app_.parseJson(R"({"wide": 99999999999999999999999})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"wide": -99999999999999999999999})"),
+               doptions::ParseException);
+  EXPECT_THROW(
+      app_.parseJson(R"({"unsigned-wide": 99999999999999999999999})"),
+      doptions::ParseException);
+  EXPECT_EQ(wide, 0);
+}
+
+TEST_F(JsonTest, MalformedDocumentsThrow) {
+  EXPECT_THROW(app_.parseJson(R"(["port", 1])"), doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"port": 1)"), doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"port" 1})"), doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"port": 1} x)"), doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"port": })"), doptions::ParseException);
+}
+
+TEST_F(JsonTest, JunkAroundTokensThrows) {
+  EXPECT_THROW(app_.parseJson(R"({"host": "a" junk})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"host": junk "a"})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"port" junk: 1})"),
+               doptions::ParseException);
+}
+
+TEST_F(JsonTest, JunkInEmptyObjectThrows) {
+  EXPECT_THROW(app_.parseJson("{ garbage }"), doptions::ParseException);
+  EXPECT_THROW(app_.parseJson("{1}"), doptions::ParseException);
+  EXPECT_NO_THROW(app_.parseJson("{\n\t}"));
+}
+
+TEST_F(JsonTest, OnlyJsonLiteralsAreAccepted) {
+  EXPECT_THROW(app_.parseJson(R"({"verbose": yes})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"verbose": True})"),
+               doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"port": 0x10})"), doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"port": 012})"), doptions::ParseException);
+  EXPECT_THROW(app_.parseJson(R"({"verbose": "maybe"})"),
+               doptions::ParseException);
+}
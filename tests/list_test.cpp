@@ -0,0 +1,306 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <doptions/application.hpp>
+#include <doptions/exceptions.hpp>
+#include <doptions/list.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Test fixture for list option tests
+class ListTest : public ::testing::Test {
+ protected:
+  void SetUp() override {}
+
+  void TearDown() override {
+    doptions::ListConversions::setConfig(doptions::ListConversionConfig{});
+  }
+
+  // Forces every value through the multithreaded path with small chunks.
+  static void forceParallel(size_t threads) {
+    doptions::ListConversionConfig config;
+    config.parallelThreshold = 0;
+    config.minChunkBytes = 1;
+    config.maxThreads = threads;
+    doptions::ListConversions::setConfig(config);
+  }
+
+  static auto numbers(size_t count) -> std::string {
+    std::string text;
+    for (size_t idx = 0; idx < count; ++idx) {
+      text += std::to_string(idx);
+      text += idx + 1 < count ? "," : "";
+    }
+    return text;
+  }
+};
+
+// ============================================================================
+// Conversion Tests
+// ============================================================================
+
+TEST_F(ListTest, ConvertsSequentially) {
+  auto values = doptions::ListConversions::convert<int32_t>("1, 2 ,3");
+  EXPECT_EQ(values, (std::vector<int32_t>{1, 2, 3}));
+}
+
+TEST_F(ListTest, AcceptsBracketsAndEmptyLists) {
+  EXPECT_EQ(doptions::ListConversions::convert<int32_t>("[4, 5]"),
+            (std::vector<int32_t>{4, 5}));
+  EXPECT_TRUE(doptions::ListConversions::convert<int32_t>("").empty());
+  EXPECT_TRUE(doptions::ListConversions::convert<int32_t>("[ ]").empty());
+}
+
+TEST_F(ListTest, ConvertsStringsAndFloats) {
+  EXPECT_EQ(doptions::ListConversions::convert<std::string>("a, bc,d"),
+            (std::vector<std::string>{"a", "bc", "d"}));
+  auto floats = doptions::ListConversions::convert<double>("0.5,1e3");
+  ASSERT_EQ(floats.size(), 2U);
+  EXPECT_DOUBLE_EQ(floats[1], 1000.0);
+}
+
+TEST_F(ListTest, CustomDelimiter) {
+  doptions::ListConversionConfig config;
+  config.delimiter = ';';
+  doptions::ListConversions::setConfig(config);
+  EXPECT_EQ(doptions::ListConversions::convert<int32_t>("1;2"),
+            (std::vector<int32_t>{1, 2}));
+}
+
+TEST_F(ListTest, ParallelMatchesSequential) {
+  auto text = numbers(10000);
+  auto sequential = doptions::ListConversions::convert<uint32_t>(text);
+  forceParallel(8);
+  auto parallel = doptions::ListConversions::convert<uint32_t>(text);
+  ASSERT_EQ(parallel.size(), 10000U);
+  EXPECT_EQ(parallel, sequential);
+  EXPECT_EQ(parallel[9999], 9999U);
+}
+
+TEST_F(ListTest, ParallelWithMoreThreadsThanElements) {
+  forceParallel(16);
+  EXPECT_EQ(doptions::ListConversions::convert<int32_t>("7,8"),
+            (std::vector<int32_t>{7, 8}));
+  EXPECT_EQ(doptions::ListConversions::convert<int32_t>("7"),
+            (std::vector<int32_t>{7}));
+}
+
+// ============================================================================
+// Error Tests
+// ============================================================================
+
+TEST_F(ListTest, ErrorReportsGlobalPosition) {
+  auto text = numbers(5000);
+  text.replace(text.find(",4321,") + 1, 4, "bad!");
+  for (size_t threads : {1, 8}) {
+    forceParallel(threads);
+    try {
+      (void)doptions::ListConversions::convert<int32_t>(text);
+      FAIL() << "expected an exception";
+    } catch (const doptions::ParseException& error) {
+      EXPECT_STREQ(
+          error.what(),
+          "Parse Exception: Invalid list element at position 4321: bad!");
+    }
+  }
+}
+
+TEST_F(ListTest, FirstErrorWins) {
+  auto text = numbers(5000);
+  text.replace(text.find(",4000,") + 1, 4, "x");
+  text.replace(text.find(",100,") + 1, 3, "y");
+  forceParallel(8);
+  try {
+    (void)doptions::ListConversions::convert<int32_t>(text);
+    FAIL() << "expected an exception";
+  } catch (const doptions::ParseException& error) {
+    EXPECT_EQ(error.text(), "y");
+  }
+}
+
+TEST_F(ListTest, EmptyElementThrows) {
+  EXPECT_THROW((void)doptions::ListConversions::convert<int32_t>("1,,2"),
+               doptions::ParseException);
+  EXPECT_THROW((void)doptions::ListConversions::convert<uint8_t>("1,256"),
+               doptions::ParseException);
+}
+
+TEST_F(ListTest, WorkerExceptionsReachTheCaller) {
+  // Thrown on another thread and not derived from std::exception.
+  EXPECT_THROW(doptions::ParallelUtils::run(4,
+                                            [](size_t idx) {
+                                              if (idx == 2) {
+                                                throw 42;  // NOLINT
+                                              }
+                                            }),
+               int);
+}
+
+struct Opaque {
+  int32_t value{0};
+};
+
+// Rejects negative values with an exception outside the std hierarchy.
+REGISTER_TYPE(Opaque) {
+  if (str.starts_with('-')) {
+    throw str.size();  // NOLINT
+  }
+  return Opaque{std::stoi(str)};
+}
+
+TEST_F(ListTest, NonStdElementErrorsReportPosition) {
+  auto text = numbers(5000);
+  text.replace(text.find(",3000,") + 1, 4, "-1");
+  forceParallel(8);
+  try {
+    (void)doptions::ListConversions::convert<Opaque>(text);
+    FAIL() << "expected an exception";
+  } catch (const doptions::ParseException& error) {
+    EXPECT_STREQ(
+        error.what(),
+        "Parse Exception: Invalid list element at position 3000: -1");
+  }
+}
+
+struct Tag {
+  std::string name;
+};
+
+REGISTER_TYPE(Tag) { return Tag{str}; }
+
+// Converted as a whole, so ';' rather than the list delimiter separates.
+REGISTER_TYPE(std::vector<Tag>) {
+  std::vector<Tag> tags;
+  size_t start = 0;
+  for (size_t end = str.find(';'); end != std::string::npos;
+       start = end + 1, end = str.find(';', start)) {
+    tags.push_back({str.substr(start, end - start)});
+  }
+  tags.push_back({str.substr(start)});
+  return tags;
+}
+
+template <typename T>
+concept CanAddList = requires(doptions::Application& app, std::vector<T>* var) {
+  app.addOption("--values", var);
+};
+
+static_assert(CanAddList<int32_t>);
+static_assert(!CanAddList<bool>);
+
+// ============================================================================
+// Option Tests
+// ============================================================================
+
+TEST_F(ListTest, ApplicationBindsVectors) {
+  auto app = doptions::Application::createApp();
+  std::vector<int64_t> ids{1};
+  app.addOption("--idents", &ids);
+  const char* argv[] = {"prog", "--idents", "10,20,30"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(ids, (std::vector<int64_t>{10, 20, 30}));
+}
+
+TEST_F(ListTest, RegisteredVectorTypeKeepsItsConverter) {
+  auto app = doptions::Application::createApp();
+  std::vector<Tag> tags;
+  app.addOption("--tags", &tags);
+  const char* argv[] = {"prog", "--tags", "a,b;c"};
+  app.parse(3, const_cast<char**>(argv));
+  ASSERT_EQ(tags.size(), 2U);
+  EXPECT_EQ(tags[0].name, "a,b");
+  EXPECT_EQ(tags[1].name, "c");
+}
+
+TEST_F(ListTest, JsonArraysBindToVectors) {
+  auto app = doptions::Application::createApp();
+  std::vector<double> weights;
+  app.addOption("--weights", &weights);
+  app.parseJson(R"({"weights": [0.5, 1.5]})");
+  EXPECT_EQ(weights, (std::vector<double>{0.5, 1.5}));
+}
+
+TEST_F(ListTest, ReadsElementsFromFile) {
+  auto path = std::filesystem::temp_directory_path() /
+              ("doptions-list-" + std::to_string(::getpid()));
+  std::ofstream(path) << "1\n2,3\n4\n";
+  std::vector<int32_t> ids;
+  auto opt = doptions::ListOption<int32_t>::createOption("--idents", &ids);
+  opt->parseValue("@" + path.string());
+  std::filesystem::remove(path);
+  EXPECT_EQ(ids, (std::vector<int32_t>{1, 2, 3, 4}));
+}
+
+TEST_F(ListTest, ResetRestoresDefault) {
+  std::vector<int32_t> ids{5};
+  auto opt = doptions::ListOption<int32_t>::createOption("--idents", &ids);
+  opt->parseValue("1,2");
+  opt->reset();
+  EXPECT_EQ(ids, (std::vector<int32_t>{5}));
+}
+
+// ============================================================================
+// Streaming Tests
+// ============================================================================
+
+TEST_F(ListTest, ListViewDecodesLazily) {
+  doptions::ListView<int32_t> view("[1, 2, x]");
+  auto iter = view.begin();
+  EXPECT_EQ(*iter, 1);
+  ++iter;
+  EXPECT_EQ(*iter, 2);
+  EXPECT_EQ(iter.position(), 1U);
+  try {
+    ++iter;
+    FAIL() << "expected an exception";
+  } catch (const doptions::ParseException& error) {
+    EXPECT_STREQ(error.what(),
+                 "Parse Exception: Invalid list element at position 2: x");
+  }
+}
+
+TEST_F(ListTest, ListViewOfEmptyValue) {
+  doptions::ListView<int32_t> view(" [] ");
+  EXPECT_TRUE(view.begin() == view.end());
+}
+
+TEST_F(ListTest, ListViewYieldsStringViews) {
+  std::string value = "alpha, beta,gamma";
+  std::vector<std::string_view> names;
+  for (auto name : doptions::ListView<std::string_view>(value)) {
+    names.push_back(name);
+  }
+  ASSERT_EQ(names.size(), 3U);
+  EXPECT_EQ(names[1], "beta");
+  EXPECT_EQ(names[1].data(), value.data() + 7);
+}
+
+TEST_F(ListTest, StreamOptionDeliversElements) {
+  auto app = doptions::Application::createApp();
+  int64_t sum = 0;
+  size_t count = 0;
+  auto consume = [&](const int64_t& value) {
+    sum += value;
+    ++count;
+  };
+  app.addStreamOption<int64_t>("--idents", consume);
+  const char* argv[] = {"prog", "--idents", "1,2,3,4"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(sum, 10);
+  EXPECT_EQ(count, 4U);
+}
+
+TEST_F(ListTest, StreamOptionReadsFile) {
+  auto path = std::filesystem::temp_directory_path() /
+              ("doptions-stream-" + std::to_string(::getpid()));
+  std::ofstream(path) << "5\n6\n7\n";
+  std::vector<int32_t> seen;
+  auto consume = [&seen](const int32_t& value) { seen.push_back(value); };
+  auto opt = doptions::StreamOption<int32_t>::createOption("--idents", consume);
+  opt->parseValue("@" + path.string());
+  std::filesystem::remove(path);
+  EXPECT_EQ(seen, (std::vector<int32_t>{5, 6, 7}));
+}
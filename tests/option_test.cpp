@@ -779,3 +779,47 @@ TEST_F(OptionTest, GraphicsApplicationConfiguration) {
         doptions::Option<int>::createOption("--frame-rate", &frameRate);
   });
 }
+
+// ============================================================================
+// User Subclasses of OptionBase
+// ============================================================================
+
+namespace {
+
+// Option written against the original OptionBase interface.
+class MinimalOption : public doptions::OptionBase {
+ public:
+  explicit MinimalOption(std::string* target) : target_(target) {}
+
+  [[nodiscard]] auto shortName() const -> const std::string& override {
+    return shortName_;
+  }
+  [[nodiscard]] auto longName() const -> const std::string& override {
+    return longName_;
+  }
+  [[nodiscard]] auto needsValue() const -> bool override { return true; }
+  auto parseValue(const std::string& str) -> void override { *target_ = str; }
+
+ private:
+  std::string* target_;
+  std::string shortName_{"-m"};
+  std::string longName_{"--minimal-option-name"};
+};
+
+}  // namespace
+
+TEST_F(OptionTest, SubclassWithoutResetKeepsLastValue) {
+  std::string value;
+  MinimalOption opt(&value);
+  opt.parseView("parsed");
+  opt.reset();
+  EXPECT_EQ(value, "parsed");
+}
+
+TEST_F(OptionTest, SubclassWithoutMemoryUsageCountsNames) {
+  std::string value;
+  MinimalOption opt(&value);
+  const auto usage = opt.memoryUsage();
+  EXPECT_GE(usage.options, sizeof(doptions::OptionBase));
+  EXPECT_GT(usage.names, 0U);
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <doptions/application.hpp>
+#include <doptions/exceptions.hpp>
+#include <doptions/preset.hpp>
+#include <string>
+#include <vector>
+
+// Test fixture for preset tests
+class PresetTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    app_.addOption("-t,--threads", &threads_);
+    app_.addOption("--busy-poll", &busyPoll_);
+    app_.addOption("--scheduler", &scheduler_);
+    app_.addOption("--hosts", &hosts_);
+    app_.addPresetOption("--profile");
+    app_.addPreset("low-latency", {{"--threads", "1"},
+                                   {"--busy-poll", "true"},
+                                   {"--scheduler", "fifo"},
+                                   {"--hosts", "a,b"}});
+    app_.addPreset("throughput", {{"-t", "16"}, {"--scheduler", "batch"}});
+  }
+
+  void TearDown() override {}
+
+  auto parse(std::vector<const char*> args) -> void {
+    args.insert(args.begin(), "app");
+    app_.parse(static_cast<int32_t>(args.size()),
+               const_cast<char**>(args.data()));
+  }
+
+  int32_t threads_{4};
+  bool busyPoll_{false};
+  std::string scheduler_{"default"};
+  std::vector<std::string> hosts_;
+  doptions::Application app_ = doptions::Application::createApp();
+};
+
+// ============================================================================
+// Preset Application
+// ============================================================================
+
+TEST_F(PresetTest, AppliesEverySetting) {
+  parse({"--profile", "low-latency"});
+  EXPECT_EQ(threads_, 1);
+  EXPECT_TRUE(busyPoll_);
+  EXPECT_EQ(scheduler_, "fifo");
+  EXPECT_EQ(hosts_, (std::vector<std::string>{"a", "b"}));
+}
+
+TEST_F(PresetTest, AttachedSelection) {
+  parse({"--profile=throughput"});
+  EXPECT_EQ(threads_, 16);
+  EXPECT_EQ(scheduler_, "batch");
+  EXPECT_FALSE(busyPoll_);
+}
+
+TEST_F(PresetTest, ExplicitFlagsOverridePreset) {
+  parse({"--threads", "8", "--profile", "low-latency", "--scheduler", "rr"});
+  EXPECT_EQ(threads_, 8);
+  EXPECT_EQ(scheduler_, "rr");
+  EXPECT_TRUE(busyPoll_);
+}
+
+TEST_F(PresetTest, NoSelectionLeavesValues) {
+  parse({"--threads", "2"});
+  EXPECT_EQ(threads_, 2);
+  EXPECT_EQ(scheduler_, "default");
+
+  parse({"--profile", "throughput"});
+  parse({"--busy-poll"});
+  EXPECT_EQ(threads_, 16);
+  EXPECT_TRUE(busyPoll_);
+}
+
+TEST_F(PresetTest, UnknownPresetThrows) {
+  EXPECT_THROW(parse({"--profile", "missing"}), doptions::ParseException);
+  EXPECT_THROW(parse({"--profile", "low-latency", "--profile", "throughput"}),
+               doptions::ParseException);
+}
+
+TEST_F(PresetTest, ObserversSeePresetSettings) {
+  int calls = 0;
+  auto observer = [&calls](const doptions::OptionBase&) { ++calls; };
+  app_.addObserver("--scheduler", observer);
+  parse({"--profile", "throughput"});
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(PresetTest, JsonSelection) {
+  app_.parseJson(R"({"profile": "throughput", "threads": 3})");
+  EXPECT_EQ(threads_, 3);
+  EXPECT_EQ(scheduler_, "batch");
+}
+
+TEST_F(PresetTest, ReparseTracksSelection) {
+  doptions::ParseState state;
+  std::vector<const char*> first = {"app", "--profile", "low-latency"};
+  app_.reparse(state, 3, const_cast<char**>(first.data()));
+  EXPECT_EQ(threads_, 1);
+  EXPECT_EQ(scheduler_, "fifo");
+
+  std::vector<const char*> second = {"app", "--profile", "low-latency",
+                                     "--threads", "6"};
+  app_.reparse(state, 5, const_cast<char**>(second.data()));
+  EXPECT_EQ(threads_, 6);
+  EXPECT_EQ(scheduler_, "fifo");
+
+  std::vector<const char*> third = {"app", "--threads", "6"};
+  app_.reparse(state, 3, const_cast<char**>(third.data()));
+  EXPECT_EQ(threads_, 6);
+  EXPECT_EQ(scheduler_, "default");
+  EXPECT_FALSE(busyPoll_);
+  EXPECT_TRUE(hosts_.empty());
+}
+
+// ============================================================================
+// Preset Declaration
+// ============================================================================
+
+TEST_F(PresetTest, DeclarationErrors) {
+  EXPECT_THROW(app_.addPreset("bad", {{"--missing", "1"}}),
+               doptions::BuildException);
+  EXPECT_THROW(app_.addPreset("bad", {{"--threads", "many"}}),
+               std::exception);
+  EXPECT_THROW(app_.addPreset("bad", {{"--profile", "throughput"}}),
+               doptions::BuildException);
+
+  auto app = doptions::Application::createApp();
+  int32_t value = 0;
+  app.addOption("--value", &value);
+  EXPECT_THROW(app.addPreset("fast", {{"--value", "1"}}),
+               doptions::BuildException);
+}
+
+TEST_F(PresetTest, InvalidPresetOptionNameLeavesNoPresetOption) {
+  auto app = doptions::Application::createApp();
+  int32_t value = 0;
+  EXPECT_THROW(app.addPresetOption("--bad name"), doptions::BuildException);
+  app.addOption("--value", &value);
+  EXPECT_THROW(app.addPreset("fast", {{"--value", "1"}}),
+               doptions::BuildException);
+
+  app.addPresetOption("--profile");
+  app.addPreset("fast", {{"--value", "1"}});
+  const char* argv[] = {"app", "--profile", "fast"};
+  app.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(value, 1);
+}
+
+TEST_F(PresetTest, SecondPresetOptionThrows) {
+  EXPECT_THROW(app_.addPresetOption("--mode"), doptions::BuildException);
+  parse({"--profile", "throughput"});
+  EXPECT_EQ(threads_, 16);
+}
+
+TEST_F(PresetTest, RedeclaredPresetReplacesSettings) {
+  app_.addPreset("throughput", {{"--threads", "32"}});
+  parse({"--profile", "throughput"});
+  EXPECT_EQ(threads_, 32);
+  EXPECT_EQ(scheduler_, "default");
+}
+
+TEST_F(PresetTest, PresetValuesConvertedOnce) {
+  // Changing the bound value between parses does not alter the preset,
+  // which holds its own converted copy.
+  parse({"--profile", "low-latency"});
+  hosts_.clear();
+  parse({"--profile", "low-latency"});
+  EXPECT_EQ(hosts_, (std::vector<std::string>{"a", "b"}));
+}
+
+TEST_F(PresetTest, MemoryUsageCountsPresets) {
+  auto app = doptions::Application::createApp();
+  int32_t value = 0;
+  app.addOption("--value", &value);
+  app.addPresetOption("--profile");
+  const size_t before = app.memoryUsage().options;
+  app.addPreset("a-preset-with-a-long-name", {{"--value", "1"}});
+  EXPECT_GT(app.memoryUsage().options, before);
+}
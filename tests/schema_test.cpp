@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <array>
+#include <doptions/exceptions.hpp>
+#include <doptions/schema.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <variant>
+
+// Test fixture for Schema tests
+class SchemaTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+    dir_ = std::filesystem::temp_directory_path() /
+           ("doptions-schema-" + std::to_string(::getpid()) + "-" +
+            info->name());
+    std::filesystem::create_directories(dir_);
+  }
+
+  void TearDown() override {
+    doptions::NameValidations::setConfig(doptions::NameValidationConfig{});
+    std::filesystem::remove_all(dir_);
+  }
+
+  auto writeSchema(const std::string& text) -> std::string {
+    auto path = (dir_ / "tool.schema").string();
+    std::ofstream(path) << text;
+    return path;
+  }
+
+  auto cacheDir() const -> std::string { return (dir_ / "cache").string(); }
+
+  std::filesystem::path dir_;
+};
+
+static const char* const schemaText = R"(
+# service settings
+int32  -p,--port     8080
+string --host        localhost
+bool   -v,--verbose
+double --ratio       0.5
+
+[deploy]
+bool   -f,--force
+uint16 --replicas    3
+)";
+
+// ============================================================================
+// Definition Tests
+// ============================================================================
+
+TEST_F(SchemaTest, DefaultsAreApplied) {
+  auto schema = doptions::Schema::fromString(schemaText);
+  EXPECT_EQ(schema.get<int32_t>("--port"), 8080);
+  EXPECT_EQ(schema.get<std::string>("--host"), "localhost");
+  EXPECT_FALSE(schema.get<bool>("-v"));
+  EXPECT_DOUBLE_EQ(schema.get<double>("--ratio"), 0.5);
+  EXPECT_EQ(schema.get<uint16_t>("deploy", "--replicas"), 3);
+}
+
+TEST_F(SchemaTest, ParsesThroughApplication) {
+  auto schema = doptions::Schema::fromString(schemaText);
+  const char* argv[] = {"tool", "--port", "9000", "-v",       "deploy",
+                        "-f",   "--replicas", "5"};
+  schema.app().parse(8, const_cast<char**>(argv));
+  EXPECT_EQ(schema.get<int32_t>("-p"), 9000);
+  EXPECT_TRUE(schema.get<bool>("--verbose"));
+  EXPECT_TRUE(schema.executed("deploy"));
+  EXPECT_TRUE(schema.get<bool>("deploy", "--force"));
+  EXPECT_EQ(schema.get<uint16_t>("deploy", "--replicas"), 5);
+}
+
+TEST_F(SchemaTest, InvalidLinesThrow) {
+  EXPECT_THROW(doptions::Schema::fromString("int32\n"),
+               doptions::BuildException);
+  EXPECT_THROW(doptions::Schema::fromString("complex --value\n"),
+               doptions::BuildException);
+  EXPECT_THROW(doptions::Schema::fromString("int32 --1bad\n"),
+               doptions::BuildException);
+  EXPECT_THROW(doptions::Schema::fromString("[deploy\n"),
+               doptions::BuildException);
+}
+
+TEST_F(SchemaTest, WrongTypeAccessThrows) {
+  auto schema = doptions::Schema::fromString(schemaText);
+  EXPECT_THROW((void)schema.get<int64_t>("--port"), std::bad_variant_access);
+  EXPECT_THROW((void)schema.get<int32_t>("--missing"),
+               doptions::BuildException);
+}
+
+// ============================================================================
+// Compiled Cache Tests
+// ============================================================================
+
+TEST_F(SchemaTest, LoadWritesAndReusesCache) {
+  auto path = writeSchema(schemaText);
+  {
+    auto schema = doptions::Schema::load(path, cacheDir());
+    EXPECT_FALSE(schema.fromCache());
+  }
+  ASSERT_FALSE(std::filesystem::is_empty(cacheDir()));
+
+  auto schema = doptions::Schema::load(path, cacheDir());
+  EXPECT_TRUE(schema.fromCache());
+  EXPECT_EQ(schema.get<int32_t>("--port"), 8080);
+
+  const char* argv[] = {"tool", "--host", "example.org", "deploy",
+                        "--replicas", "7"};
+  schema.app().parse(6, const_cast<char**>(argv));
+  EXPECT_EQ(schema.get<std::string>("--host"), "example.org");
+  EXPECT_EQ(schema.get<uint16_t>("deploy", "--replicas"), 7);
+}
+
+TEST_F(SchemaTest, CachedIndexReportsUnknownAndDuplicateArgs) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  auto schema = doptions::Schema::load(path, cacheDir());
+  ASSERT_TRUE(schema.fromCache());
+
+  const char* unknown[] = {"tool", "--nope"};
+  EXPECT_THROW(schema.app().parse(2, const_cast<char**>(unknown)),
+               doptions::ParseException);
+  const char* duplicate[] = {"tool", "-p", "1", "--port", "2"};
+  EXPECT_THROW(schema.app().parse(5, const_cast<char**>(duplicate)),
+               doptions::ParseException);
+}
+
+TEST_F(SchemaTest, ChangedSchemaMissesCache) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  path = writeSchema("int8 --level 2\n" + std::string(schemaText));
+  auto schema = doptions::Schema::load(path, cacheDir());
+  EXPECT_FALSE(schema.fromCache());
+  EXPECT_EQ(schema.get<int8_t>("--level"), 2);
+}
+
+TEST_F(SchemaTest, ChangedValidationConfigMissesCache) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  ASSERT_TRUE(doptions::Schema::load(path, cacheDir()).fromCache());
+
+  doptions::NameValidationConfig config;
+  config.longNameLimit = 6;
+  doptions::NameValidations::setConfig(config);
+  EXPECT_THROW((void)doptions::Schema::load(path, cacheDir()),
+               doptions::BuildException);
+}
+
+TEST_F(SchemaTest, CorruptCacheFallsBackToText) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  for (const auto& entry : std::filesystem::directory_iterator(cacheDir())) {
+    std::filesystem::resize_file(entry.path(), 20);
+  }
+  auto schema = doptions::Schema::load(path, cacheDir());
+  EXPECT_FALSE(schema.fromCache());
+  EXPECT_EQ(schema.get<int32_t>("--port"), 8080);
+}
+
+// Rewrites the first two option index entries of every cache file through
+// edit, which receives them as {offset, length, id, alias} words. The entries
+// follow the 48-byte header, the 32-byte fields and the 8-byte command names.
+template <typename Edit>
+static auto patchOptionEntries(const std::string& cacheDir, Edit edit)
+    -> void {
+  for (const auto& entry : std::filesystem::directory_iterator(cacheDir)) {
+    std::fstream file(entry.path(),
+                      std::ios::in | std::ios::out | std::ios::binary);
+    std::array<uint32_t, 2> counts{};
+    file.seekg(16);
+    file.read(reinterpret_cast<char*>(counts.data()), sizeof(counts));
+    const auto offset =
+        static_cast<std::streamoff>(48 + (counts[0] * 32) + (counts[1] * 8));
+    std::array<uint32_t, 8> words{};
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(words.data()), sizeof(words));
+    edit(words);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char*>(words.data()), sizeof(words));
+  }
+}
+
+TEST_F(SchemaTest, CacheEntryWithBadIdFallsBackToText) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  patchOptionEntries(cacheDir(), [](auto& words) { words[2] = 999; });
+  auto schema = doptions::Schema::load(path, cacheDir());
+  EXPECT_FALSE(schema.fromCache());
+
+  const char* argv[] = {"tool", "--port", "1", "-v"};
+  schema.app().parse(4, const_cast<char**>(argv));
+  EXPECT_EQ(schema.get<int32_t>("--port"), 1);
+  EXPECT_TRUE(schema.get<bool>("--verbose"));
+}
+
+TEST_F(SchemaTest, CacheEntryOutsidePoolFallsBackToText) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  patchOptionEntries(cacheDir(), [](auto& words) { words[0] = 0xFFFFFFF0U; });
+  EXPECT_FALSE(doptions::Schema::load(path, cacheDir()).fromCache());
+}
+
+TEST_F(SchemaTest, UnsortedCacheEntriesFallBackToText) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  patchOptionEntries(cacheDir(), [](auto& words) {
+    std::swap(words[0], words[4]);
+    std::swap(words[1], words[5]);
+  });
+  ASSERT_FALSE(doptions::Schema::load(path, cacheDir()).fromCache());
+  // The fallback rewrote a valid cache.
+  EXPECT_TRUE(doptions::Schema::load(path, cacheDir()).fromCache());
+}
+
+TEST_F(SchemaTest, AddingOptionsAfterCacheLoadRebuildsIndex) {
+  auto path = writeSchema(schemaText);
+  (void)doptions::Schema::load(path, cacheDir());
+  auto schema = doptions::Schema::load(path, cacheDir());
+  ASSERT_TRUE(schema.fromCache());
+
+  int extra = 0;
+  schema.app().addOption("--extra", &extra);
+  const char* argv[] = {"tool", "--extra", "4", "--port", "1"};
+  schema.app().parse(5, const_cast<char**>(argv));
+  EXPECT_EQ(extra, 4);
+  EXPECT_EQ(schema.get<int32_t>("--port"), 1);
+}
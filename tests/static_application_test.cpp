@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <doptions/static_application.hpp>
+#include <string_view>
+#include <vector>
+#include "allocation_counter.hpp"
+
+using doptions::StaticError;
+
+// Test fixture for heap-free application tests
+class StaticApplicationTest : public ::testing::Test {
+ protected:
+  using App = doptions::StaticApplication<8, 2>;
+
+  void SetUp() override {
+    ASSERT_TRUE(app_.addOption("-p,--port", &port_));
+    ASSERT_TRUE(app_.addOption("--host", &host_));
+    ASSERT_TRUE(app_.addOption("-v", &verbose_));
+    ASSERT_TRUE(app_.addOption("--ratio", &ratio_));
+    ASSERT_TRUE(app_.addCommand("flash", &flash_));
+    ASSERT_TRUE(app_.addOption("flash", "--image", &image_));
+    ASSERT_TRUE(app_.addOption("flash", "-v", &verify_));
+  }
+
+  void TearDown() override {}
+
+  auto parse(std::vector<const char*> args) -> doptions::StaticResult {
+    args.insert(args.begin(), "app");
+    return app_.parse(static_cast<int32_t>(args.size()),
+                      const_cast<char**>(args.data()));
+  }
+
+  int32_t port_{0};
+  std::string_view host_;
+  bool verbose_{false};
+  double ratio_{0};
+  bool flash_{false};
+  std::string_view image_;
+  bool verify_{false};
+  App app_ = App::createApp();
+};
+
+// ============================================================================
+// Parsing
+// ============================================================================
+
+TEST_F(StaticApplicationTest, ParsesBuiltInTypes) {
+  EXPECT_TRUE(parse({"-p", "8080", "--host", "board.local", "-v", "--ratio",
+                     "0.25"}));
+  EXPECT_EQ(port_, 8080);
+  EXPECT_EQ(host_, "board.local");
+  EXPECT_TRUE(verbose_);
+  EXPECT_DOUBLE_EQ(ratio_, 0.25);
+}
+
+TEST_F(StaticApplicationTest, AttachedValues) {
+  EXPECT_TRUE(parse({"--port=9000", "--host=a=b"}));
+  EXPECT_EQ(port_, 9000);
+  EXPECT_EQ(host_, "a=b");
+}
+
+TEST_F(StaticApplicationTest, OptionsAfterCommandBelongToIt) {
+  EXPECT_TRUE(parse({"-v", "flash", "--image", "fw.bin", "-v"}));
+  EXPECT_TRUE(verbose_);
+  EXPECT_TRUE(flash_);
+  EXPECT_EQ(image_, "fw.bin");
+  EXPECT_TRUE(verify_);
+  EXPECT_EQ(parse({"--image", "fw.bin"}).error, StaticError::UnknownArg);
+}
+
+TEST_F(StaticApplicationTest, ReportsErrorsWithoutThrowing) {
+  auto result = parse({"--unknown"});
+  EXPECT_FALSE(result);
+  EXPECT_EQ(result.error, StaticError::UnknownArg);
+  EXPECT_EQ(result.text, "--unknown");
+  EXPECT_EQ(parse({"--port"}).error, StaticError::InsufficientValues);
+  EXPECT_EQ(parse({"-p", "1", "--port", "2"}).error, StaticError::MultiArg);
+  result = parse({"--port", "12ab"});
+  EXPECT_EQ(result.error, StaticError::InvalidValue);
+  EXPECT_EQ(result.text, "12ab");
+  EXPECT_EQ(parse({"--port", "3000000001"}).error, StaticError::OutOfRange);
+  EXPECT_EQ(parse({"-v=true"}).error, StaticError::UnknownArg);
+}
+
+// ============================================================================
+// Registration
+// ============================================================================
+
+TEST_F(StaticApplicationTest, RejectsBadRegistrations) {
+  int32_t value = 0;
+  bool command = false;
+  EXPECT_EQ(app_.addOption("--port", &value).error,
+            StaticError::DuplicateName);
+  EXPECT_EQ(app_.addOption("--1st", &value).error, StaticError::InvalidName);
+  EXPECT_EQ(app_.addOption("--x", &value).error, StaticError::InvalidName);
+  EXPECT_EQ(app_.addOption("reset", "--port", &value).error,
+            StaticError::UnknownArg);
+  EXPECT_EQ(app_.addCommand("-x", &command).error, StaticError::InvalidName);
+  EXPECT_TRUE(app_.addCommand("reset", &command));
+  EXPECT_EQ(app_.addCommand("erase", &command).error,
+            StaticError::CapacityExceeded);
+  EXPECT_TRUE(app_.addOption("--extra", &value));
+  EXPECT_TRUE(app_.addOption("reset", "--extra", &value));
+  EXPECT_EQ(app_.addOption("--spare", &value).error,
+            StaticError::CapacityExceeded);
+  EXPECT_EQ(app_.optionCount(), 8U);
+  EXPECT_EQ(app_.commandCount(), 2U);
+}
+
+// ============================================================================
+// Allocations
+// ============================================================================
+
+TEST(StaticApplicationAllocationTest, NeverAllocates) {
+  int32_t port = 0;
+  std::string_view host;
+  bool verbose = false;
+  float ratio = 0;
+  uint64_t size = 0;
+  bool flash = false;
+  std::string_view image;
+  const char* argv[] = {"app",  "--port", "80",    "--host", "h",
+                        "-v",   "--ratio=1.5",     "flash",  "--image",
+                        "a.bin", "--size", "18446744073709551615"};
+  const size_t before = allocationCount();
+  auto app = doptions::StaticApplication<6, 1>::createApp();
+  bool registered = app.addOption("--port", &port) &&
+                    app.addOption("--host", &host) &&
+                    app.addOption("-v,--verbose", &verbose) &&
+                    app.addOption("--ratio", &ratio) &&
+                    app.addCommand("flash", &flash) &&
+                    app.addOption("flash", "--image", &image) &&
+                    app.addOption("flash", "--size", &size);
+  const auto result = app.parse(12, const_cast<char**>(argv));
+  const auto failed = app.parse(2, const_cast<char**>(argv));
+  const size_t after = allocationCount();
+  EXPECT_EQ(after, before);
+  EXPECT_TRUE(registered);
+  EXPECT_TRUE(result);
+  EXPECT_EQ(failed.error, StaticError::InsufficientValues);
+  EXPECT_EQ(port, 80);
+  EXPECT_EQ(host, "h");
+  EXPECT_TRUE(verbose);
+  EXPECT_FLOAT_EQ(ratio, 1.5F);
+  EXPECT_TRUE(flash);
+  EXPECT_EQ(image, "a.bin");
+  EXPECT_EQ(size, UINT64_MAX);
+}
+
+static_assert(noexcept(std::declval<doptions::StaticApplication<1>&>().parse(
+    0, nullptr)));
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <doptions/application.hpp>
+#include <doptions/exceptions.hpp>
+#include <doptions/struct_binding.hpp>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct ServerConfig {
+  int32_t port{0};
+  std::string host;
+  bool verbose{false};
+  double ratio{0};
+  uint16_t workers{0};
+};
+
+template <>
+struct doptions::StructFields<ServerConfig> {
+  static constexpr std::tuple fields{
+      doptions::field(&ServerConfig::port, "-p,--port", 8080,
+                      "Port to listen on"),
+      doptions::field(&ServerConfig::host, "--host", "localhost",
+                      "Address to bind"),
+      doptions::field(&ServerConfig::verbose, "-v,--verbose", false,
+                      "Log every request"),
+      doptions::field(&ServerConfig::ratio, "--sample-ratio", 0.5,
+                      "Share of requests traced"),
+      doptions::field(&ServerConfig::workers, "-w", uint16_t{4},
+                      "Worker threads")};
+};
+
+struct ClientConfig {
+  std::string endpoint;
+  int32_t retries{0};
+};
+
+template <>
+struct doptions::StructFields<ClientConfig> {
+  static constexpr std::tuple fields{
+      doptions::field(&ClientConfig::endpoint, "--endpoint", "", "Server URL"),
+      doptions::field(&ClientConfig::retries, "--retries", 3, "Attempts")};
+};
+
+// Names are split and checked while compiling.
+static_assert(doptions::FieldNames::parse("-p,--port").shortName == "p");
+static_assert(doptions::FieldNames::parse("-p,--port").longName == "port");
+static_assert(doptions::FieldNames::parse("--host").shortName.empty());
+static_assert(doptions::FieldNames::parse("w").shortName == "w");
+static_assert(doptions::FieldNames::parse("retries").longName == "retries");
+static_assert(std::get<1>(doptions::StructFields<ServerConfig>::fields)
+                  .help == "Address to bind");
+
+// Test fixture for struct binding tests
+class StructBindingTest : public ::testing::Test {
+ protected:
+  void SetUp() override { app_.bindStruct(config_); }
+
+  void TearDown() override {}
+
+  auto parse(std::vector<const char*> args) -> void {
+    args.insert(args.begin(), "app");
+    app_.parse(static_cast<int32_t>(args.size()),
+               const_cast<char**>(args.data()));
+  }
+
+  ServerConfig config_;
+  doptions::Application app_ = doptions::Application::createApp();
+};
+
+// ============================================================================
+// Binding
+// ============================================================================
+
+TEST_F(StructBindingTest, AssignsDefaults) {
+  EXPECT_EQ(config_.port, 8080);
+  EXPECT_EQ(config_.host, "localhost");
+  EXPECT_FALSE(config_.verbose);
+  EXPECT_DOUBLE_EQ(config_.ratio, 0.5);
+  EXPECT_EQ(config_.workers, 4);
+}
+
+TEST_F(StructBindingTest, ParsesEveryField) {
+  parse({"-p", "9000", "--host", "example.org", "-v", "--sample-ratio",
+         "0.25", "-w", "16"});
+  EXPECT_EQ(config_.port, 9000);
+  EXPECT_EQ(config_.host, "example.org");
+  EXPECT_TRUE(config_.verbose);
+  EXPECT_DOUBLE_EQ(config_.ratio, 0.25);
+  EXPECT_EQ(config_.workers, 16);
+}
+
+TEST_F(StructBindingTest, LongNamesAndAttachedValues) {
+  parse({"--port=7000", "--verbose"});
+  EXPECT_EQ(config_.port, 7000);
+  EXPECT_TRUE(config_.verbose);
+  EXPECT_EQ(config_.host, "localhost");
+}
+
+TEST_F(StructBindingTest, MixesWithOtherOptions) {
+  ClientConfig client;
+  int32_t extra = 0;
+  app_.bindStruct(client);
+  app_.addOption("--extra", &extra);
+  parse({"--retries", "5", "--extra", "1", "--port", "1"});
+  EXPECT_EQ(client.retries, 5);
+  EXPECT_EQ(client.endpoint, "");
+  EXPECT_EQ(extra, 1);
+  EXPECT_EQ(config_.port, 1);
+}
+
+TEST_F(StructBindingTest, ReparseResetsToDefaults) {
+  doptions::ParseState state;
+  const char* first[] = {"app", "--port", "1", "--host", "a"};
+  app_.reparse(state, 5, const_cast<char**>(first));
+  EXPECT_EQ(config_.port, 1);
+  const char* second[] = {"app", "--host", "b"};
+  app_.reparse(state, 3, const_cast<char**>(second));
+  EXPECT_EQ(config_.port, 8080);
+  EXPECT_EQ(config_.host, "b");
+}
+
+TEST_F(StructBindingTest, ObserversAndAliases) {
+  int32_t notified = 0;
+  auto count = [&notified](const doptions::OptionBase&) { ++notified; };
+  app_.addObserver("--port", count);
+  app_.addAlias("--port", "--listen");
+  parse({"--listen", "80"});
+  EXPECT_EQ(config_.port, 80);
+  EXPECT_EQ(notified, 1);
+}
+
+TEST_F(StructBindingTest, OptionsCarryFieldHelp) {
+  std::vector<std::string> help;
+  auto collect = [&help](const doptions::OptionBase& opt) {
+    help.emplace_back(opt.help());
+  };
+  app_.addObserver("--port", collect);
+  app_.addObserver("-w", collect);
+  parse({"-w", "2", "--port", "80"});
+  EXPECT_EQ(help,
+            (std::vector<std::string>{"Port to listen on", "Worker threads"}));
+}
+
+TEST_F(StructBindingTest, ErrorsMatchRegularOptions) {
+  EXPECT_THROW(parse({"--port", "1", "-p", "2"}), doptions::ParseException);
+  EXPECT_THROW(parse({"--workers", "2"}), doptions::ParseException);
+}
+
+TEST_F(StructBindingTest, MovedApplicationKeepsBinding) {
+  auto moved = std::move(app_);
+  const char* argv[] = {"app", "--port", "42"};
+  moved.parse(3, const_cast<char**>(argv));
+  EXPECT_EQ(config_.port, 42);
+}
+
+TEST_F(StructBindingTest, NamesFollowTheValidationConfigInEffect) {
+  doptions::NameValidationConfig config;
+  config.nameContainsDashes = false;
+  doptions::NameValidations::setConfig(config);
+  auto app = doptions::Application::createApp();
+  ServerConfig server;
+  server.port = 1;
+  EXPECT_THROW(app.bindStruct(server), doptions::BuildException);
+  // Rejected before any field took its default.
+  EXPECT_EQ(server.port, 1);
+  ClientConfig client;
+  EXPECT_NO_THROW(app.bindStruct(client));
+  doptions::NameValidations::setConfig(doptions::NameValidationConfig{});
+}